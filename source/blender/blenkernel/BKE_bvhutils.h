@@ -61,6 +61,12 @@ typedef struct BVHTreeFromMesh {
   const struct MLoop *loop;
   const struct MLoopTri *looptri;
 
+  /**
+   * True when the tree was not built by #BKE_bvhtree_from_mesh_get, because it was cached on the
+   * mesh already or could be shared with another mesh with the same geometry.
+   */
+  bool cache_hit;
+
   /* Private data */
   bool cached;
 
@@ -209,6 +215,9 @@ BVHTree *bvhtree_from_mesh_looptri_ex(struct BVHTreeFromMesh *data,
 /**
  * Builds or queries a BVH-cache for the cache BVH-tree of the request type.
  *
+ * Trees of large meshes are shared with other meshes that have the same geometry, so that copies
+ * of a mesh don't have to build their trees again.
+ *
  * \note This function only fills a cache, and therefore the mesh argument can
  * be considered logically const. Concurrent access is protected by a mutex.
  */
@@ -275,6 +284,12 @@ struct BVHCache *bvhcache_init(void);
  */
 void bvhcache_free(struct BVHCache *bvh_cache);
 
+/**
+ * Free the BVH trees that are shared between meshes with the same geometry. Has to be called
+ * after all meshes have been freed.
+ */
+void BKE_bvhutils_exit(void);
+
 #ifdef __cplusplus
 }
 #endif
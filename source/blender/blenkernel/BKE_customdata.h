@@ -268,6 +268,14 @@ void *CustomData_duplicate_referenced_layer_anonymous(
     CustomData *data, int type, const struct AnonymousAttributeID *anonymous_id, int totelem);
 bool CustomData_is_referenced_layer(struct CustomData *data, int type);
 
+/**
+ * Give the layer its own copy of the data if the data is shared with other layers after copying
+ * with #CD_DUPLICATE, so that it can be written to directly. Unlike
+ * #CustomData_duplicate_referenced_layer, layers that only reference their data are unchanged.
+ * Any pointer to the layer data retrieved before has to be retrieved again afterwards.
+ */
+void CustomData_ensure_layer_not_shared(struct CustomDataLayer *layer);
+
 /**
  * Duplicate all the layers with flag NOFREE, and remove the flag from duplicated layers.
  */
@@ -407,6 +415,14 @@ const char *CustomData_get_layer_name(const struct CustomData *data, int type, i
 void *CustomData_get_layer(const struct CustomData *data, int type);
 void *CustomData_get_layer_n(const struct CustomData *data, int type, int n);
 void *CustomData_get_layer_named(const struct CustomData *data, int type, const char *name);
+/**
+ * Like #CustomData_get_layer_named, but the data of the layer is not shared with other layers
+ * afterwards, see #CustomData_ensure_layer_not_shared. Use this to cache pointers that are
+ * written to directly.
+ */
+void *CustomData_get_layer_named_for_write(struct CustomData *data,
+                                           int type,
+                                           const char *name);
 int CustomData_get_offset(const struct CustomData *data, int type);
 int CustomData_get_n_offset(const struct CustomData *data, int type, int n);
 
@@ -449,8 +465,10 @@ void CustomData_bmesh_set_n(
 void CustomData_bmesh_set_layer_n(struct CustomData *data, void *block, int n, const void *source);
 
 /**
- * Set the pointer of to the first layer of type. the old data is not freed.
- * returns the value of `ptr` if the layer is found, NULL otherwise.
+ * Set the pointer of to the first layer of type. the old data is not freed, the caller owns it
+ * afterwards. Layers with data that is still shared with other layers are not changed, because
+ * there is no single owner of their data, use #CustomData_ensure_layer_not_shared first.
+ * returns the value of `ptr` if the layer is found and changed, NULL otherwise.
  */
 void *CustomData_set_layer(const struct CustomData *data, int type, void *ptr);
 void *CustomData_set_layer_n(const struct CustomData *data, int type, int n, void *ptr);
@@ -57,6 +57,8 @@ class GeometryComponent {
    * larger than one, the component becomes immutable. */
   mutable std::atomic<int> users_ = 1;
   GeometryComponentType type_;
+  /* Mutable because the version only describes the data, see #version. */
+  mutable uint64_t version_;
 
  public:
   GeometryComponent(GeometryComponentType type);
@@ -76,6 +78,21 @@ class GeometryComponent {
   void user_remove() const;
   bool is_mutable() const;
 
+  /**
+   * Identifies the data of the component. Every new component gets a new version, and so does a
+   * component that is accessed for writing with #GeometrySet::get_component_for_write. Therefore
+   * components with the same version contain the same data, which allows caches to detect
+   * unchanged geometry across evaluations.
+   */
+  uint64_t version() const;
+  /**
+   * Use the version of another component that is known to contain the same data. This does not
+   * change the data, so it's allowed on shared components as well.
+   */
+  void set_version(uint64_t version) const;
+  /** Assign a new version, because the data of the component might be changed. */
+  void tag_data_changed();
+
   GeometryComponentType type() const;
 
   /**
@@ -358,6 +375,12 @@ struct GeometrySet {
 
   bool compute_boundbox_without_instances(blender::float3 *r_min, blender::float3 *r_max) const;
 
+  /**
+   * Estimate of the memory used by the attributes and topology of all components, in bytes. Data
+   * that is shared with other geometries is counted fully, referenced instances are not counted.
+   */
+  int64_t estimate_memory_usage() const;
+
   friend std::ostream &operator<<(std::ostream &stream, const GeometrySet &geometry_set);
 
   /**
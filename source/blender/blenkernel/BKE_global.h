@@ -196,6 +196,9 @@ enum {
   G_DEBUG_XR_TIME = (1 << 20),               /* XR/OpenXR timing messages */
 
   G_DEBUG_GHOST = (1 << 21), /* Debug GHOST module. */
+
+  G_DEBUG_DEPSGRAPH_INCREMENTAL = (1 << 22), /* Validate incremental depsgraph relations updates
+                                              * against a full build. */
 };
 
 #define G_DEBUG_ALL \
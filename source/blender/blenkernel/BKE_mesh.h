@@ -366,6 +366,19 @@ void BKE_mesh_recalc_looptri_with_normals(const struct MLoop *mloop,
                                           int totpoly,
                                           struct MLoopTri *mlooptri,
                                           const float (*poly_normals)[3]);
+/**
+ * Only recalculate the triangles of the polygons in \a poly_indices, after the positions of their
+ * vertices have changed. The triangles of the other polygons in \a mlooptri are kept.
+ *
+ * \note Polygon normals aren't used, because quads can be split differently with them, and the
+ * result should match #BKE_mesh_recalc_looptri.
+ */
+void BKE_mesh_recalc_looptri_partial(const struct MLoop *mloop,
+                                     const struct MPoly *mpoly,
+                                     const struct MVert *mvert,
+                                     const int *poly_indices,
+                                     int poly_indices_len,
+                                     struct MLoopTri *mlooptri);
 
 /* *** mesh_normals.cc *** */
 
@@ -485,6 +498,28 @@ void BKE_mesh_calc_normals_poly_and_vertex(const struct MVert *mvert,
                                            int mpoly_len,
                                            float (*r_poly_normals)[3],
                                            float (*r_vert_normals)[3]);
+/**
+ * Only recalculate the normals of the polygons in \a poly_indices and of their vertices, after
+ * the positions of the vertices used by these polygons have changed. The normals of all other
+ * polygons have to be up to date already, they are reused.
+ *
+ * \note Updating the vertex normals still reads the corners of all polygons once, to find the
+ * unchanged polygons that use the updated vertices, so the cost is O(mloop_len). Only the normals
+ * of the changed polygons are calculated, which avoids most of the work of a full update.
+ *
+ * \param r_vert_normals: May be null to only update the polygon normals, which only costs
+ * O(poly_indices_len).
+ */
+void BKE_mesh_calc_normals_poly_and_vertex_partial(const struct MVert *mvert,
+                                                   int mvert_len,
+                                                   const struct MLoop *mloop,
+                                                   int mloop_len,
+                                                   const struct MPoly *mpoly,
+                                                   int mpoly_len,
+                                                   const int *poly_indices,
+                                                   int poly_indices_len,
+                                                   float (*r_poly_normals)[3],
+                                                   float (*r_vert_normals)[3]);
 
 /**
  * Calculate vertex and face normals, storing the result in custom data layers on the mesh.
@@ -10,6 +10,8 @@
 
 //#include "BKE_customdata.h"  /* for CustomDataMask */
 
+#include "BLI_bitmap.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -59,6 +61,16 @@ void BKE_mesh_runtime_clear_geometry(struct Mesh *mesh);
  * Call this function to recalculate runtime data when used.
  */
 void BKE_mesh_runtime_clear_cache(struct Mesh *mesh);
+/**
+ * Update the cached data that depends on positions after only the vertices used by the polygons
+ * in \a polys_mask have moved, for local deformations of large meshes. The triangulation and the
+ * normals are only recalculated for these polygons and their vertices, caches that are not
+ * calculated yet stay that way. Other caches that depend on positions are freed.
+ *
+ * \note The update of vertex normals is O(totloop), see
+ * #BKE_mesh_calc_normals_poly_and_vertex_partial.
+ */
+void BKE_mesh_runtime_positions_changed_partial(struct Mesh *mesh, const BLI_bitmap *polys_mask);
 
 /* This is a copy of DM_verttri_from_looptri(). */
 void BKE_mesh_runtime_verttri_from_looptri(struct MVertTri *r_verttri,
@@ -15,6 +15,7 @@ extern "C" {
 
 struct Mesh;
 struct OpenSubdiv_EvaluatorCache;
+struct OpenSubdiv_PatchCoord;
 struct Subdiv;
 
 typedef enum eSubdivEvaluatorType {
@@ -86,6 +87,15 @@ void BKE_subdiv_eval_displacement(struct Subdiv *subdiv,
 void BKE_subdiv_eval_final_point(
     struct Subdiv *subdiv, int ptex_face_index, float u, float v, float r_P[3]);
 
+/* Multiple points queries. */
+
+/* Evaluate points at a limit surface for many coordinates at once, which avoids the overhead of
+ * separate queries. Batches of coordinates can be evaluated from multiple threads. */
+void BKE_subdiv_eval_limit_points(struct Subdiv *subdiv,
+                                  const struct OpenSubdiv_PatchCoord *patch_coords,
+                                  int num_patch_coords,
+                                  float (*r_P)[3]);
+
 #ifdef __cplusplus
 }
 #endif
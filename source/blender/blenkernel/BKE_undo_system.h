@@ -70,6 +70,8 @@ typedef struct UndoStep {
   const struct UndoType *type;
   /** Size in bytes of all data in step (not including the step). */
   size_t data_size;
+  /** Time in seconds it took to encode the step, for statistics. */
+  double encode_time;
   /** Users should never see this step (only use for internal consistency). */
   bool skip;
   /** Some situations require the global state to be stored, edge cases when exiting modes. */
@@ -26,6 +26,7 @@
 #include "BKE_blender_version.h" /* own include */
 #include "BKE_blendfile.h"
 #include "BKE_brush.h"
+#include "BKE_bvhutils.h"
 #include "BKE_cachefile.h"
 #include "BKE_callbacks.h"
 #include "BKE_global.h"
@@ -65,6 +66,9 @@ void BKE_blender_free(void)
   BKE_main_free(G_MAIN);
   G_MAIN = NULL;
 
+  /* After free main, the meshes don't use the shared BVH trees anymore. */
+  BKE_bvhutils_exit();
+
   if (G.log.file != NULL) {
     fclose(G.log.file);
   }
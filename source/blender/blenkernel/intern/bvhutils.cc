@@ -8,16 +8,23 @@
 #include <cmath>
 #include <cstdio>
 #include <cstring>
+#include <memory>
+#include <mutex>
 
 #include "DNA_mesh_types.h"
 #include "DNA_meshdata_types.h"
 #include "DNA_pointcloud_types.h"
 
+#include "BLI_hash.hh"
+#include "BLI_hash_memory.hh"
 #include "BLI_linklist.h"
+#include "BLI_map.hh"
 #include "BLI_math.h"
 #include "BLI_task.h"
+#include "BLI_task.hh"
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_bvhutils.h"
 #include "BKE_editmesh.h"
@@ -26,6 +33,240 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "CLG_log.h"
+
+using blender::Map;
+using blender::Vector;
+
+static CLG_LogRef LOG = {"bke.bvhutils"};
+
+/* -------------------------------------------------------------------- */
+/** \name Shared BVH Trees
+ *
+ * Trees built for meshes are shared between all meshes with the same geometry, like the copies of
+ * a mesh that are created in every evaluation of a modifier. They are found with a hash of the
+ * data they are built from, so a tree is never used for a mesh that has changed. A few trees are
+ * kept alive after their last mesh has been freed, because the next copy is often only created
+ * after that.
+ *
+ * When only the positions have changed, like for deforming meshes, an unused tree that has been
+ * built for the same topology is refit to the new positions instead of building a new tree.
+ * \{ */
+
+struct SharedBVHTreeKey {
+  uint64_t positions_hash;
+  /** Hash of the data that decides which elements are in the tree, and in which order. */
+  uint64_t topology_hash;
+  BVHCacheType type;
+  int tree_type;
+
+  uint64_t hash() const
+  {
+    return blender::get_default_hash_4(positions_hash, topology_hash, int(type), tree_type);
+  }
+
+  /** A tree built for the other key has the same leafs and can be refit to these positions. */
+  bool has_same_topology(const SharedBVHTreeKey &other) const
+  {
+    return topology_hash == other.topology_hash && type == other.type &&
+           tree_type == other.tree_type;
+  }
+
+  friend bool operator==(const SharedBVHTreeKey &a, const SharedBVHTreeKey &b)
+  {
+    return a.positions_hash == b.positions_hash && a.has_same_topology(b);
+  }
+};
+
+struct SharedBVHTree {
+  SharedBVHTreeKey key;
+  /** Can be null when the mesh has no elements of the requested type. */
+  BVHTree *tree;
+  int users = 0;
+  /** Number of times the tree has been refit to other positions since it was built. */
+  int refits_num = 0;
+  /**
+   * Set for trees that were still used in #BKE_bvhutils_exit, they are freed together with their
+   * last user then.
+   */
+  bool is_detached = false;
+};
+
+struct SharedBVHTrees {
+  std::mutex mutex;
+  Map<SharedBVHTreeKey, std::unique_ptr<SharedBVHTree>> trees;
+  /** Trees that are not used by any mesh, the least recently used first. */
+  Vector<SharedBVHTree *> unused_trees;
+};
+
+/** Smaller meshes build their trees quickly enough, sharing them would only use memory. */
+static constexpr int shared_bvh_tree_min_verts = 1024;
+static constexpr int max_unused_shared_bvh_trees = 8;
+/**
+ * The layout of a refit tree gets worse the further the positions move from the ones it has been
+ * built for, so trees are built again after some refits.
+ */
+static constexpr int max_shared_bvh_tree_refits = 64;
+
+static SharedBVHTrees &get_shared_bvh_trees()
+{
+  static SharedBVHTrees shared_trees;
+  return shared_trees;
+}
+
+static SharedBVHTreeKey shared_bvh_tree_key(const Mesh &mesh,
+                                            const BVHCacheType bvh_cache_type,
+                                            const int tree_type)
+{
+  Vector<uint64_t, 4> hashes;
+  hashes.append(uint64_t(mesh.totvert));
+  switch (bvh_cache_type) {
+    case BVHTREE_FROM_LOOSEVERTS:
+    case BVHTREE_FROM_EDGES:
+    case BVHTREE_FROM_LOOSEEDGES:
+      hashes.append(blender::hash_memory_parallel(mesh.medge, sizeof(MEdge) * mesh.totedge));
+      break;
+    case BVHTREE_FROM_FACES:
+      hashes.append(blender::hash_memory_parallel(mesh.mface, sizeof(MFace) * mesh.totface));
+      break;
+    case BVHTREE_FROM_LOOPTRI:
+    case BVHTREE_FROM_LOOPTRI_NO_HIDDEN:
+      /* The triangulation only depends on the positions, polygons and loops. */
+      hashes.append(blender::hash_memory_parallel(mesh.mpoly, sizeof(MPoly) * mesh.totpoly));
+      hashes.append(blender::hash_memory_parallel(mesh.mloop, sizeof(MLoop) * mesh.totloop));
+      break;
+    default:
+      break;
+  }
+  const uint64_t positions_hash = blender::hash_memory_parallel(mesh.mvert,
+                                                                sizeof(MVert) * mesh.totvert);
+  const uint64_t topology_hash = blender::hash_memory(hashes.data(),
+                                                      hashes.as_span().size_in_bytes());
+  return {positions_hash, topology_hash, bvh_cache_type, tree_type};
+}
+
+/** Find a tree that has been built for a mesh with the same geometry, and add a user to it. */
+static SharedBVHTree *shared_bvh_tree_find(const SharedBVHTreeKey &key)
+{
+  SharedBVHTrees &shared_trees = get_shared_bvh_trees();
+  std::lock_guard lock{shared_trees.mutex};
+  const std::unique_ptr<SharedBVHTree> *shared_tree = shared_trees.trees.lookup_ptr(key);
+  if (shared_tree == nullptr) {
+    return nullptr;
+  }
+  if ((*shared_tree)->users == 0) {
+    Vector<SharedBVHTree *> &unused_trees = shared_trees.unused_trees;
+    unused_trees.remove(unused_trees.first_index_of(shared_tree->get()));
+  }
+  (*shared_tree)->users++;
+  return shared_tree->get();
+}
+
+/**
+ * Take an unused tree that has been built for a mesh with the same topology but other positions,
+ * so that it can be refit instead of building a new tree. The tree is removed from the shared
+ * trees, it should be added again with the new key after it has been refit.
+ * \param r_refits_num: The number of times the tree has been refit before.
+ */
+static BVHTree *shared_bvh_tree_take_for_refit(const SharedBVHTreeKey &key, int *r_refits_num)
+{
+  SharedBVHTrees &shared_trees = get_shared_bvh_trees();
+  std::lock_guard lock{shared_trees.mutex};
+  Vector<SharedBVHTree *> &unused_trees = shared_trees.unused_trees;
+  /* The most recently used tree is usually the one of the previous frame. */
+  for (int64_t i = unused_trees.size() - 1; i >= 0; i--) {
+    SharedBVHTree *shared_tree = unused_trees[i];
+    if (shared_tree->tree == nullptr || !shared_tree->key.has_same_topology(key) ||
+        shared_tree->refits_num >= max_shared_bvh_tree_refits) {
+      continue;
+    }
+    BVHTree *tree = shared_tree->tree;
+    *r_refits_num = shared_tree->refits_num;
+    const SharedBVHTreeKey old_key = shared_tree->key;
+    unused_trees.remove(i);
+    shared_trees.trees.remove(old_key);
+    return tree;
+  }
+  return nullptr;
+}
+
+/**
+ * Share a newly built or refit tree with other meshes. When another thread has added a tree for
+ * the same geometry in the meantime, that tree is used instead and the new one is freed.
+ */
+static SharedBVHTree *shared_bvh_tree_add(const SharedBVHTreeKey &key,
+                                          BVHTree *tree,
+                                          const int refits_num = 0)
+{
+  SharedBVHTrees &shared_trees = get_shared_bvh_trees();
+  std::lock_guard lock{shared_trees.mutex};
+  std::unique_ptr<SharedBVHTree> &shared_tree = shared_trees.trees.lookup_or_add_cb(key, [&]() {
+    std::unique_ptr<SharedBVHTree> new_shared_tree = std::make_unique<SharedBVHTree>();
+    new_shared_tree->key = key;
+    new_shared_tree->tree = tree;
+    new_shared_tree->refits_num = refits_num;
+    return new_shared_tree;
+  });
+  if (shared_tree->tree != tree) {
+    BLI_bvhtree_free(tree);
+    if (shared_tree->users == 0) {
+      Vector<SharedBVHTree *> &unused_trees = shared_trees.unused_trees;
+      unused_trees.remove(unused_trees.first_index_of(shared_tree.get()));
+    }
+  }
+  shared_tree->users++;
+  return shared_tree.get();
+}
+
+static void shared_bvh_tree_remove_user(SharedBVHTree *shared_tree)
+{
+  SharedBVHTrees &shared_trees = get_shared_bvh_trees();
+  std::lock_guard lock{shared_trees.mutex};
+  BLI_assert(shared_tree->users > 0);
+  shared_tree->users--;
+  if (shared_tree->users > 0) {
+    return;
+  }
+  if (shared_tree->is_detached) {
+    BLI_bvhtree_free(shared_tree->tree);
+    delete shared_tree;
+    return;
+  }
+  shared_trees.unused_trees.append(shared_tree);
+  if (shared_trees.unused_trees.size() > max_unused_shared_bvh_trees) {
+    SharedBVHTree *oldest_tree = shared_trees.unused_trees[0];
+    shared_trees.unused_trees.remove(0);
+    BLI_bvhtree_free(oldest_tree->tree);
+    shared_trees.trees.remove(oldest_tree->key);
+  }
+}
+
+void BKE_bvhutils_exit()
+{
+  SharedBVHTrees &shared_trees = get_shared_bvh_trees();
+  std::lock_guard lock{shared_trees.mutex};
+  int used_trees_num = 0;
+  for (std::unique_ptr<SharedBVHTree> &shared_tree : shared_trees.trees.values()) {
+    if (shared_tree->users == 0) {
+      BLI_bvhtree_free(shared_tree->tree);
+      continue;
+    }
+    /* The meshes using the tree have not been freed. Instead of freeing the tree under them,
+     * hand it over to them, so it's freed with the last one. */
+    shared_tree->is_detached = true;
+    shared_tree.release();
+    used_trees_num++;
+  }
+  if (used_trees_num > 0) {
+    CLOG_WARN(&LOG, "%d shared BVH trees are still used by meshes", used_trees_num);
+  }
+  shared_trees.unused_trees.clear_and_make_inline();
+  /* Free the memory of the map as well, before memory leaks are reported. */
+  shared_trees.trees = {};
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BVHCache
  * \{ */
@@ -33,6 +274,8 @@
 struct BVHCacheItem {
   bool is_filled;
   BVHTree *tree;
+  /** Set when the tree is shared with other meshes, it is owned by the shared tree then. */
+  SharedBVHTree *shared_tree;
 };
 
 struct BVHCache {
@@ -131,11 +374,26 @@ static void bvhcache_insert(BVHCache *bvh_cache, BVHTree *tree, BVHCacheType typ
   item->is_filled = true;
 }
 
+/** Same as #bvhcache_insert, but for trees that are shared with other meshes. */
+static void bvhcache_insert_shared(BVHCache *bvh_cache,
+                                   SharedBVHTree *shared_tree,
+                                   BVHCacheType type)
+{
+  bvhcache_insert(bvh_cache, shared_tree->tree, type);
+  bvh_cache->items[type].shared_tree = shared_tree;
+}
+
 void bvhcache_free(BVHCache *bvh_cache)
 {
   for (int index = 0; index < BVHTREE_MAX_ITEM; index++) {
     BVHCacheItem *item = &bvh_cache->items[index];
-    BLI_bvhtree_free(item->tree);
+    if (item->shared_tree) {
+      shared_bvh_tree_remove_user(item->shared_tree);
+      item->shared_tree = nullptr;
+    }
+    else {
+      BLI_bvhtree_free(item->tree);
+    }
     item->tree = nullptr;
   }
   BLI_mutex_end(&bvh_cache->mutex);
@@ -1233,6 +1491,113 @@ static BLI_bitmap *looptri_no_hidden_map_get(const MPoly *mpoly,
   return looptri_mask;
 }
 
+/**
+ * Update the bounds of a tree that has been built for a mesh with the same topology. The leafs
+ * are indexed in the order they were inserted in, which skips the elements that are masked out.
+ */
+static void bvhtree_refit_from_mesh(BVHTree *tree,
+                                    const Mesh &mesh,
+                                    const BVHCacheType bvh_cache_type,
+                                    const MLoopTri *looptri,
+                                    const int looptri_len)
+{
+  using namespace blender;
+
+  BLI_bitmap *mask = nullptr;
+  int mask_bits_act_len = -1;
+  int elements_num = 0;
+
+  switch (bvh_cache_type) {
+    case BVHTREE_FROM_LOOSEVERTS:
+      mask = loose_verts_map_get(
+          mesh.medge, mesh.totedge, mesh.mvert, mesh.totvert, &mask_bits_act_len);
+      ATTR_FALLTHROUGH;
+    case BVHTREE_FROM_VERTS:
+      elements_num = mesh.totvert;
+      break;
+    case BVHTREE_FROM_LOOSEEDGES:
+      mask = loose_edges_map_get(mesh.medge, mesh.totedge, &mask_bits_act_len);
+      ATTR_FALLTHROUGH;
+    case BVHTREE_FROM_EDGES:
+      elements_num = mesh.totedge;
+      break;
+    case BVHTREE_FROM_FACES:
+      elements_num = mesh.totface;
+      break;
+    case BVHTREE_FROM_LOOPTRI_NO_HIDDEN:
+      mask = looptri_no_hidden_map_get(mesh.mpoly, looptri_len, &mask_bits_act_len);
+      ATTR_FALLTHROUGH;
+    case BVHTREE_FROM_LOOPTRI:
+      elements_num = looptri_len;
+      break;
+    case BVHTREE_FROM_EM_VERTS:
+    case BVHTREE_FROM_EM_EDGES:
+    case BVHTREE_FROM_EM_LOOPTRI:
+    case BVHTREE_MAX_ITEM:
+      BLI_assert_unreachable();
+      break;
+  }
+
+  const bool use_mask = mask != nullptr;
+  Vector<int> leaf_elements;
+  if (use_mask) {
+    leaf_elements.reserve(mask_bits_act_len);
+    for (const int i : IndexRange(elements_num)) {
+      if (BLI_BITMAP_TEST_BOOL(mask, i)) {
+        leaf_elements.append(i);
+      }
+    }
+    MEM_freeN(mask);
+  }
+  const int leafs_num = use_mask ? int(leaf_elements.size()) : elements_num;
+  BLI_assert(leafs_num == BLI_bvhtree_get_len(tree));
+
+  const MVert *mvert = mesh.mvert;
+  threading::parallel_for(IndexRange(leafs_num), 1024, [&](const IndexRange range) {
+    for (const int leaf : range) {
+      const int i = use_mask ? leaf_elements[leaf] : leaf;
+      float co[4][3];
+      int co_num = 0;
+      switch (bvh_cache_type) {
+        case BVHTREE_FROM_VERTS:
+        case BVHTREE_FROM_LOOSEVERTS:
+          copy_v3_v3(co[0], mvert[i].co);
+          co_num = 1;
+          break;
+        case BVHTREE_FROM_EDGES:
+        case BVHTREE_FROM_LOOSEEDGES:
+          copy_v3_v3(co[0], mvert[mesh.medge[i].v1].co);
+          copy_v3_v3(co[1], mvert[mesh.medge[i].v2].co);
+          co_num = 2;
+          break;
+        case BVHTREE_FROM_FACES: {
+          const MFace &face = mesh.mface[i];
+          copy_v3_v3(co[0], mvert[face.v1].co);
+          copy_v3_v3(co[1], mvert[face.v2].co);
+          copy_v3_v3(co[2], mvert[face.v3].co);
+          if (face.v4) {
+            copy_v3_v3(co[3], mvert[face.v4].co);
+          }
+          co_num = face.v4 ? 4 : 3;
+          break;
+        }
+        case BVHTREE_FROM_LOOPTRI:
+        case BVHTREE_FROM_LOOPTRI_NO_HIDDEN:
+          copy_v3_v3(co[0], mvert[mesh.mloop[looptri[i].tri[0]].v].co);
+          copy_v3_v3(co[1], mvert[mesh.mloop[looptri[i].tri[1]].v].co);
+          copy_v3_v3(co[2], mvert[mesh.mloop[looptri[i].tri[2]].v].co);
+          co_num = 3;
+          break;
+        default:
+          break;
+      }
+      BLI_bvhtree_update_node(tree, leaf, co[0], nullptr, co_num);
+    }
+  });
+
+  BLI_bvhtree_update_tree(tree);
+}
+
 BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
                                    const struct Mesh *mesh,
                                    const BVHCacheType bvh_cache_type,
@@ -1265,11 +1630,45 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
 
   if (data->cached) {
     BLI_assert(lock_started == false);
+    data->cache_hit = true;
 
     /* NOTE: #data->tree can be nullptr. */
     return data->tree;
   }
 
+  /* Use the tree of another mesh with the same geometry. */
+  const bool use_shared_tree = mesh->totvert >= shared_bvh_tree_min_verts;
+  SharedBVHTreeKey shared_tree_key;
+  if (use_shared_tree) {
+    /* Hashing is multithreaded, see #bvhtree_balance_isolated. */
+    blender::threading::isolate_task([&]() {
+      shared_tree_key = shared_bvh_tree_key(*mesh, bvh_cache_type, tree_type);
+    });
+    if (SharedBVHTree *shared_tree = shared_bvh_tree_find(shared_tree_key)) {
+      data->tree = shared_tree->tree;
+      data->cached = true;
+      data->cache_hit = true;
+      bvhcache_insert_shared(*bvh_cache_p, shared_tree, bvh_cache_type);
+      bvhcache_unlock(*bvh_cache_p, lock_started);
+      return data->tree;
+    }
+
+    /* Only update the bounds of a tree that has been built for the same topology. */
+    int refits_num;
+    if (BVHTree *tree = shared_bvh_tree_take_for_refit(shared_tree_key, &refits_num)) {
+      /* Refitting is multithreaded, see #bvhtree_balance_isolated. */
+      blender::threading::isolate_task([&]() {
+        bvhtree_refit_from_mesh(tree, *mesh, bvh_cache_type, looptri, looptri_len);
+      });
+      SharedBVHTree *shared_tree = shared_bvh_tree_add(shared_tree_key, tree, refits_num + 1);
+      data->tree = shared_tree->tree;
+      data->cached = true;
+      bvhcache_insert_shared(*bvh_cache_p, shared_tree, bvh_cache_type);
+      bvhcache_unlock(*bvh_cache_p, lock_started);
+      return data->tree;
+    }
+  }
+
   /* Create BVHTree. */
 
   BLI_bitmap *mask = nullptr;
@@ -1331,7 +1730,14 @@ BVHTree *BKE_bvhtree_from_mesh_get(struct BVHTreeFromMesh *data,
   // printf("BVHTree built and saved on cache\n");
   BLI_assert(data->cached == false);
   data->cached = true;
-  bvhcache_insert(*bvh_cache_p, data->tree, bvh_cache_type);
+  if (use_shared_tree) {
+    SharedBVHTree *shared_tree = shared_bvh_tree_add(shared_tree_key, data->tree);
+    data->tree = shared_tree->tree;
+    bvhcache_insert_shared(*bvh_cache_p, shared_tree, bvh_cache_type);
+  }
+  else {
+    bvhcache_insert(*bvh_cache_p, data->tree, bvh_cache_type);
+  }
   bvhcache_unlock(*bvh_cache_p, lock_started);
 
 #ifdef DEBUG
@@ -8,6 +8,8 @@
  * BKE_customdata.h contains the function prototypes for this file.
  */
 
+#include <atomic>
+
 #include "MEM_guardedalloc.h"
 
 /* Since we have versioning code here (CustomData_verify_versions()). */
@@ -2207,6 +2209,95 @@ static bool customdata_typemap_is_valid(const CustomData *data)
 }
 #endif
 
+/* -------------------------------------------------------------------- */
+/** \name Implicit Sharing
+ *
+ * Copying a layer with #CD_DUPLICATE or #CD_ASSIGN only adds a user to the data of generic
+ * attribute layers instead of copying the array. A layer gets its own copy of the data again when
+ * it is modified while shared. The functions in this file take care of that, code that writes to
+ * the layer data directly has to use #CustomData_duplicate_referenced_layer first, just like it
+ * already has to for referenced layers.
+ * \{ */
+
+struct ImplicitSharingInfo {
+  /** Number of layers using the data, the last one frees it. */
+  mutable std::atomic<int> users = 1;
+  /** Number of elements in the shared array. */
+  int totelem = 0;
+};
+
+/**
+ * Only generic attributes are shared. Pointers to other layers are stored outside of the custom
+ * data (like #Mesh.mvert or #Mesh.mloopcol) and are written to directly in many places.
+ * Color attributes are not shared either, painting, baking and color operators write to the
+ * pointers returned by #CustomData_get_layer.
+ */
+static bool layer_type_is_sharable(const int type)
+{
+  return (CD_TYPE_AS_MASK(type) & CD_MASK_PROP_ALL & ~CD_MASK_COLOR_ALL) != 0;
+}
+
+static void layer_sharing_info_init(CustomDataLayer &layer, const int totelem)
+{
+  BLI_assert(layer.sharing_info == nullptr);
+  if (layer.data && !(layer.flag & CD_FLAG_NOFREE) && layer_type_is_sharable(layer.type)) {
+    ImplicitSharingInfo *sharing_info = MEM_new<ImplicitSharingInfo>(__func__);
+    sharing_info->totelem = totelem;
+    layer.sharing_info = sharing_info;
+  }
+}
+
+/**
+ * Remove the layer from the users of its data.
+ * \return True when there are no other users left, so the caller has to free the data.
+ */
+static bool layer_sharing_info_remove_user(CustomDataLayer &layer)
+{
+  const ImplicitSharingInfo *sharing_info = layer.sharing_info;
+  if (sharing_info == nullptr) {
+    return true;
+  }
+  layer.sharing_info = nullptr;
+  if (sharing_info->users.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    MEM_delete(sharing_info);
+    return true;
+  }
+  return false;
+}
+
+static bool layer_is_shared(const CustomDataLayer &layer)
+{
+  return layer.sharing_info != nullptr &&
+         layer.sharing_info->users.load(std::memory_order_acquire) > 1;
+}
+
+/** Give the layer its own copy of the data if it is shared with other layers. */
+static void layer_ensure_not_shared(CustomDataLayer &layer)
+{
+  if (!layer_is_shared(layer)) {
+    return;
+  }
+  const LayerTypeInfo *typeInfo = layerType_getInfo(layer.type);
+  const int totelem = layer.sharing_info->totelem;
+  void *old_data = layer.data;
+  void *new_data = MEM_malloc_arrayN(
+      (size_t)totelem, typeInfo->size, layerType_getName(layer.type));
+  if (typeInfo->copy) {
+    typeInfo->copy(old_data, new_data, totelem);
+  }
+  else {
+    memcpy(new_data, old_data, (size_t)totelem * typeInfo->size);
+  }
+  if (layer_sharing_info_remove_user(layer)) {
+    /* The other users have been freed in the meantime. */
+    MEM_freeN(old_data);
+  }
+  layer.data = new_data;
+  layer_sharing_info_init(layer, totelem);
+}
+
+/** \} */
+
 bool CustomData_merge(const struct CustomData *source,
                       struct CustomData *dest,
                       CustomDataMask mask,
@@ -2264,7 +2355,12 @@ bool CustomData_merge(const struct CustomData *source,
         break;
     }
 
-    if ((alloctype == CD_ASSIGN) && (flag & CD_FLAG_NOFREE)) {
+    /* Add a user to shared data instead of copying it. With #CD_ASSIGN the user of the source
+     * layer is moved to the new layer. */
+    const bool share_data = layer->sharing_info != nullptr && !(flag & CD_FLAG_NOFREE) &&
+                            ELEM(alloctype, CD_ASSIGN, CD_DUPLICATE);
+
+    if (((alloctype == CD_ASSIGN) && (flag & CD_FLAG_NOFREE)) || share_data) {
       newlayer = customData_add_layer__internal(
           dest, type, CD_REFERENCE, data, totelem, layer->name);
     }
@@ -2273,6 +2369,17 @@ bool CustomData_merge(const struct CustomData *source,
     }
 
     if (newlayer) {
+      if (share_data && newlayer->data == data) {
+        newlayer->flag &= ~CD_FLAG_NOFREE;
+        newlayer->sharing_info = layer->sharing_info;
+        if (alloctype == CD_DUPLICATE) {
+          layer->sharing_info->users.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+          layer->sharing_info = nullptr;
+        }
+      }
+
       newlayer->uid = layer->uid;
 
       newlayer->active = lastactive;
@@ -2303,9 +2410,14 @@ void CustomData_realloc(CustomData *data, int totelem)
       continue;
     }
     typeInfo = layerType_getInfo(layer->type);
+    layer_ensure_not_shared(*layer);
     /* Use calloc to avoid the need to manually initialize new data in layers.
      * Useful for types like #MDeformVert which contain a pointer. */
     layer->data = MEM_recallocN(layer->data, (size_t)totelem * typeInfo->size);
+    if (layer->sharing_info != nullptr) {
+      layer_sharing_info_remove_user(*layer);
+      layer_sharing_info_init(*layer, totelem);
+    }
   }
 }
 
@@ -2333,6 +2445,10 @@ static void customData_free_layer__internal(CustomDataLayer *layer, int totelem)
     layer->anonymous_id = nullptr;
   }
   if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
+    if (!layer_sharing_info_remove_user(*layer)) {
+      /* The data is still used by other layers. */
+      return;
+    }
     typeInfo = layerType_getInfo(layer->type);
 
     if (typeInfo->free) {
@@ -2716,6 +2832,7 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
   data->layers[index].type = type;
   data->layers[index].flag = flag;
   data->layers[index].data = newlayerdata;
+  layer_sharing_info_init(data->layers[index], totelem);
 
   /* Set default name if none exists. Note we only call DATA_()  once
    * we know there is a default name, to avoid overhead of locale lookups
@@ -2951,6 +3068,10 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
     }
 
     layer->flag &= ~CD_FLAG_NOFREE;
+    layer_sharing_info_init(*layer, totelem);
+  }
+  else {
+    layer_ensure_not_shared(*layer);
   }
 
   return layer->data;
@@ -3021,6 +3142,11 @@ bool CustomData_is_referenced_layer(struct CustomData *data, int type)
   return (layer->flag & CD_FLAG_NOFREE) != 0;
 }
 
+void CustomData_ensure_layer_not_shared(CustomDataLayer *layer)
+{
+  layer_ensure_not_shared(*layer);
+}
+
 void CustomData_free_temporary(CustomData *data, int totelem)
 {
   int i, j;
@@ -3084,6 +3210,8 @@ void CustomData_copy_data_layer(const CustomData *source,
 {
   const LayerTypeInfo *typeInfo;
 
+  layer_ensure_not_shared(dest->layers[dst_layer_index]);
+
   const void *src_data = source->layers[src_layer_index].data;
   void *dst_data = dest->layers[dst_layer_index].data;
 
@@ -3258,6 +3386,7 @@ void CustomData_interp(const CustomData *source,
     /* if we found a matching layer, copy the data */
     if (dest->layers[dest_i].type == source->layers[src_i].type) {
       void *src_data = source->layers[src_i].data;
+      layer_ensure_not_shared(dest->layers[dest_i]);
 
       for (int j = 0; j < count; j++) {
         sources[j] = POINTER_OFFSET(src_data, (size_t)src_indices[j] * typeInfo->size);
@@ -3313,6 +3442,8 @@ void CustomData_swap(struct CustomData *data, const int index_a, const int index
     const size_t offset_a = size * index_a;
     const size_t offset_b = size * index_b;
 
+    layer_ensure_not_shared(data->layers[i]);
+
     void *buff = size <= sizeof(buff_static) ? buff_static : MEM_mallocN(size, __func__);
     memcpy(buff, POINTER_OFFSET(data->layers[i].data, offset_a), size);
     memcpy(POINTER_OFFSET(data->layers[i].data, offset_a),
@@ -3388,6 +3519,17 @@ void *CustomData_get_layer_named(const struct CustomData *data, int type, const
   return data->layers[layer_index].data;
 }
 
+void *CustomData_get_layer_named_for_write(CustomData *data, int type, const char *name)
+{
+  int layer_index = CustomData_get_named_layer_index(data, type, name);
+  if (layer_index == -1) {
+    return nullptr;
+  }
+
+  layer_ensure_not_shared(data->layers[layer_index]);
+  return data->layers[layer_index].data;
+}
+
 int CustomData_get_offset(const CustomData *data, int type)
 {
   /* get the layer index of the active layer of type */
@@ -3431,6 +3573,22 @@ const char *CustomData_get_layer_name(const CustomData *data, int type, int n)
   return (layer_index == -1) ? nullptr : data->layers[layer_index].name;
 }
 
+/**
+ * Replace the data of the layer, the caller owns the old data afterwards.
+ * \return False when the old data is still used by other layers, the layer is unchanged then.
+ */
+static bool customdata_layer_set_data(CustomDataLayer &layer, void *ptr)
+{
+  if (layer_is_shared(layer)) {
+    BLI_assert_msg(0, "Can't set the data of a layer that is shared with other layers");
+    return false;
+  }
+  /* This layer is the only user, so the user count can be removed without freeing the data. */
+  layer_sharing_info_remove_user(layer);
+  layer.data = ptr;
+  return true;
+}
+
 void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
 {
   /* get the layer index of the first layer of type */
@@ -3440,7 +3598,9 @@ void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
     return nullptr;
   }
 
-  data->layers[layer_index].data = ptr;
+  if (!customdata_layer_set_data(data->layers[layer_index], ptr)) {
+    return nullptr;
+  }
 
   return ptr;
 }
@@ -3453,7 +3613,9 @@ void *CustomData_set_layer_n(const struct CustomData *data, int type, int n, voi
     return nullptr;
   }
 
-  data->layers[layer_index].data = ptr;
+  if (!customdata_layer_set_data(data->layers[layer_index], ptr)) {
+    return nullptr;
+  }
 
   return ptr;
 }
@@ -5313,6 +5475,7 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, int count)
     }
 
     layer->flag &= ~CD_FLAG_NOFREE;
+    layer->sharing_info = nullptr;
 
     if (CustomData_verify_versions(data, i)) {
       BLO_read_data_address(reader, &layer->data);
@@ -5333,6 +5496,7 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, int count)
       else if (layer->type == CD_GRID_PAINT_MASK) {
         blend_read_paint_mask(reader, count, static_cast<GridPaintMask *>(layer->data));
       }
+      layer_sharing_info_init(*layer, count);
       i++;
     }
   }
@@ -0,0 +1,156 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_index_range.hh"
+
+#include "BKE_customdata.h"
+
+#include "DNA_customdata_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "testing/testing.h"
+
+namespace blender::bke::tests {
+
+static float *add_float_layer(CustomData &data, const int totelem)
+{
+  CustomData_reset(&data);
+  float *values = static_cast<float *>(
+      CustomData_add_layer_named(&data, CD_PROP_FLOAT, CD_CALLOC, nullptr, totelem, "values"));
+  for (const int i : IndexRange(totelem)) {
+    values[i] = float(i);
+  }
+  return values;
+}
+
+TEST(customdata, CopySharesGenericAttributes)
+{
+  CustomData src;
+  const float *src_values = add_float_layer(src, 10);
+
+  CustomData dst;
+  CustomData_copy(&src, &dst, CD_MASK_ALL, CD_DUPLICATE, 10);
+  EXPECT_EQ(CustomData_get_layer_named(&dst, CD_PROP_FLOAT, "values"), src_values);
+
+  /* Freeing the source must not free the data that is still used by the copy. */
+  CustomData_free(&src, 10);
+  const float *dst_values = static_cast<const float *>(
+      CustomData_get_layer_named(&dst, CD_PROP_FLOAT, "values"));
+  EXPECT_EQ(dst_values[9], 9.0f);
+  CustomData_free(&dst, 10);
+}
+
+TEST(customdata, WriteCopiesSharedData)
+{
+  CustomData src;
+  const float *src_values = add_float_layer(src, 10);
+
+  CustomData dst;
+  CustomData_copy(&src, &dst, CD_MASK_ALL, CD_DUPLICATE, 10);
+
+  float *dst_values = static_cast<float *>(
+      CustomData_duplicate_referenced_layer_named(&dst, CD_PROP_FLOAT, "values", 10));
+  EXPECT_NE(dst_values, src_values);
+  dst_values[0] = 5.0f;
+  EXPECT_EQ(src_values[0], 0.0f);
+  EXPECT_EQ(dst_values[9], 9.0f);
+
+  /* The data of the source is not shared anymore, so it is written to in place. */
+  EXPECT_EQ(CustomData_duplicate_referenced_layer_named(&src, CD_PROP_FLOAT, "values", 10),
+            src_values);
+
+  CustomData_free(&src, 10);
+  CustomData_free(&dst, 10);
+}
+
+TEST(customdata, CopyDataIntoSharedLayer)
+{
+  CustomData src;
+  const float *src_values = add_float_layer(src, 10);
+
+  CustomData dst;
+  CustomData_copy(&src, &dst, CD_MASK_ALL, CD_DUPLICATE, 10);
+  CustomData_copy_data(&src, &dst, 9, 0, 1);
+
+  const float *dst_values = static_cast<const float *>(
+      CustomData_get_layer_named(&dst, CD_PROP_FLOAT, "values"));
+  EXPECT_NE(dst_values, src_values);
+  EXPECT_EQ(dst_values[0], 9.0f);
+  EXPECT_EQ(src_values[0], 0.0f);
+
+  CustomData_free(&src, 10);
+  CustomData_free(&dst, 10);
+}
+
+TEST(customdata, GetLayerForWriteCopiesSharedData)
+{
+  CustomData src;
+  const float *src_values = add_float_layer(src, 10);
+
+  CustomData dst;
+  CustomData_copy(&src, &dst, CD_MASK_ALL, CD_DUPLICATE, 10);
+  EXPECT_EQ(CustomData_get_layer_named(&dst, CD_PROP_FLOAT, "values"), src_values);
+
+  float *dst_values = static_cast<float *>(
+      CustomData_get_layer_named_for_write(&dst, CD_PROP_FLOAT, "values"));
+  EXPECT_NE(dst_values, src_values);
+  EXPECT_EQ(CustomData_get_layer_named(&dst, CD_PROP_FLOAT, "values"), dst_values);
+  dst_values[0] = 5.0f;
+  EXPECT_EQ(src_values[0], 0.0f);
+
+  /* Data that isn't shared anymore is not copied again. */
+  EXPECT_EQ(CustomData_get_layer_named_for_write(&dst, CD_PROP_FLOAT, "values"), dst_values);
+  EXPECT_EQ(CustomData_get_layer_named_for_write(&src, CD_PROP_FLOAT, "values"), src_values);
+
+  CustomData_free(&src, 10);
+  CustomData_free(&dst, 10);
+}
+
+TEST(customdata, SetLayerOfUnsharedLayer)
+{
+  CustomData src;
+  float *src_values = add_float_layer(src, 10);
+
+  CustomData dst;
+  CustomData_copy(&src, &dst, CD_MASK_ALL, CD_DUPLICATE, 10);
+  CustomDataLayer *layer = &dst.layers[CustomData_get_named_layer_index(
+      &dst, CD_PROP_FLOAT, "values")];
+  CustomData_ensure_layer_not_shared(layer);
+
+  /* The caller owns the old data after replacing it. */
+  float *old_values = static_cast<float *>(layer->data);
+  float *new_values = static_cast<float *>(MEM_dupallocN(old_values));
+  EXPECT_EQ(CustomData_set_layer(&dst, CD_PROP_FLOAT, new_values), new_values);
+  MEM_freeN(old_values);
+  EXPECT_EQ(src_values[9], 9.0f);
+
+  CustomData_free(&src, 10);
+  CustomData_free(&dst, 10);
+}
+
+TEST(customdata, WriteColorLayerOfCopy)
+{
+  CustomData src;
+  CustomData_reset(&src);
+  MPropCol *src_colors = static_cast<MPropCol *>(
+      CustomData_add_layer(&src, CD_PROP_COLOR, CD_CALLOC, nullptr, 10));
+
+  CustomData dst;
+  CustomData_copy(&src, &dst, CD_MASK_ALL, CD_DUPLICATE, 10);
+
+  /* Painting and baking write to the color layer directly. */
+  MPropCol *dst_colors = static_cast<MPropCol *>(CustomData_get_layer(&dst, CD_PROP_COLOR));
+  EXPECT_NE(dst_colors, src_colors);
+  dst_colors[0].color[0] = 1.0f;
+  EXPECT_EQ(src_colors[0].color[0], 0.0f);
+
+  CustomData_free(&src, 10);
+  CustomData_free(&dst, 10);
+}
+
+}  // namespace blender::bke::tests
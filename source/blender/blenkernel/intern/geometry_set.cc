@@ -7,6 +7,7 @@
 
 #include "BKE_attribute.h"
 #include "BKE_attribute_access.hh"
+#include "BKE_customdata.h"
 #include "BKE_curves.hh"
 #include "BKE_geometry_fields.hh"
 #include "BKE_geometry_set.hh"
@@ -19,6 +20,8 @@
 #include "BKE_volume.h"
 
 #include "DNA_collection_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
 #include "DNA_object_types.h"
 
 #include "BLI_rand.hh"
@@ -37,7 +40,14 @@ using blender::Vector;
 /** \name Geometry Component
  * \{ */
 
-GeometryComponent::GeometryComponent(GeometryComponentType type) : type_(type)
+static uint64_t geometry_component_version_new()
+{
+  static std::atomic<uint64_t> next_version = 1;
+  return next_version.fetch_add(1, std::memory_order_relaxed);
+}
+
+GeometryComponent::GeometryComponent(GeometryComponentType type)
+    : type_(type), version_(geometry_component_version_new())
 {
 }
 
@@ -79,6 +89,21 @@ bool GeometryComponent::is_mutable() const
   return users_ <= 1;
 }
 
+uint64_t GeometryComponent::version() const
+{
+  return version_;
+}
+
+void GeometryComponent::set_version(const uint64_t version) const
+{
+  version_ = version;
+}
+
+void GeometryComponent::tag_data_changed()
+{
+  version_ = geometry_component_version_new();
+}
+
 GeometryComponentType GeometryComponent::type() const
 {
   return type_;
@@ -111,7 +136,9 @@ GeometryComponent &GeometrySet::get_component_for_write(GeometryComponentType co
     return *component_ptr;
   }
   if (component_ptr->is_mutable()) {
-    /* If the referenced component is already mutable, return it directly. */
+    /* If the referenced component is already mutable, return it directly. It may be changed by the
+     * caller, so it gets a new version. */
+    component_ptr->tag_data_changed();
     return *component_ptr;
   }
   /* If the referenced component is shared, make a copy. The copy is not shared and is
@@ -193,6 +220,32 @@ bool GeometrySet::compute_boundbox_without_instances(float3 *r_min, float3 *r_ma
   return have_minmax;
 }
 
+int64_t GeometrySet::estimate_memory_usage() const
+{
+  using namespace blender;
+  using namespace blender::bke;
+  int64_t size = 0;
+  for (const GeometryComponent *component : this->get_components_for_read()) {
+    component->attribute_foreach(
+        [&](const AttributeIDRef &UNUSED(attribute_id), const AttributeMetaData &meta_data) {
+          const CPPType &type = *custom_data_type_to_cpp_type(meta_data.data_type);
+          size += type.size() * component->attribute_domain_size(meta_data.domain);
+          return true;
+        });
+    if (component->type() == GEO_COMPONENT_TYPE_MESH) {
+      if (const Mesh *mesh = static_cast<const MeshComponent *>(component)->get_for_read()) {
+        size += sizeof(MEdge) * mesh->totedge + sizeof(MPoly) * mesh->totpoly +
+                sizeof(MLoop) * mesh->totloop;
+      }
+    }
+    else if (component->type() == GEO_COMPONENT_TYPE_INSTANCES) {
+      const InstancesComponent &instances = *static_cast<const InstancesComponent *>(component);
+      size += (sizeof(float4x4) + sizeof(int)) * instances.instances_amount();
+    }
+  }
+  return size;
+}
+
 std::ostream &operator<<(std::ostream &stream, const GeometrySet &geometry_set)
 {
   stream << "<GeometrySet at " << &geometry_set << ", " << geometry_set.components_.size()
@@ -29,6 +29,7 @@
 #include "BLI_task.h"
 #include "BLI_task.hh"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_customdata.h"
 #include "BKE_editmesh_cache.h"
@@ -230,6 +231,51 @@ struct MeshCalcNormalsData_PolyAndVertex {
   float (*vnors)[3];
 };
 
+/**
+ * Accumulate angle weighted face normal into the vertex normals.
+ * Inline version of #accumulate_vertex_normals_poly_v3.
+ *
+ * \param verts_mask: When not null, only the normals of these vertices are changed.
+ */
+static void mesh_poly_accumulate_vertex_normals(const MVert *mverts,
+                                                const MLoop *ml,
+                                                const int totloop,
+                                                const float pnor[3],
+                                                const BLI_bitmap *verts_mask,
+                                                float (*vnors)[3])
+{
+  const int i_end = totloop - 1;
+
+  float edvec_prev[3], edvec_next[3], edvec_end[3];
+  const float *v_curr = mverts[ml[i_end].v].co;
+  sub_v3_v3v3(edvec_prev, mverts[ml[i_end - 1].v].co, v_curr);
+  normalize_v3(edvec_prev);
+  copy_v3_v3(edvec_end, edvec_prev);
+
+  for (int i_next = 0, i_curr = i_end; i_next <= i_end; i_curr = i_next++) {
+    const float *v_next = mverts[ml[i_next].v].co;
+
+    /* Skip an extra normalization by reusing the first calculated edge. */
+    if (i_next != i_end) {
+      sub_v3_v3v3(edvec_next, v_curr, v_next);
+      normalize_v3(edvec_next);
+    }
+    else {
+      copy_v3_v3(edvec_next, edvec_end);
+    }
+
+    if (verts_mask == nullptr || BLI_BITMAP_TEST(verts_mask, ml[i_curr].v)) {
+      /* Calculate angle between the two poly edges incident on this vertex. */
+      const float fac = saacos(-dot_v3v3(edvec_prev, edvec_next));
+      const float vnor_add[3] = {pnor[0] * fac, pnor[1] * fac, pnor[2] * fac};
+
+      add_v3_v3_atomic(vnors[ml[i_curr].v], vnor_add);
+    }
+    v_curr = v_next;
+    copy_v3_v3(edvec_prev, edvec_next);
+  }
+}
+
 static void mesh_calc_normals_poly_and_vertex_accum_fn(
     void *__restrict userdata, const int pidx, const TaskParallelTLS *__restrict UNUSED(tls))
 {
@@ -237,7 +283,6 @@ static void mesh_calc_normals_poly_and_vertex_accum_fn(
   const MPoly *mp = &data->mpoly[pidx];
   const MLoop *ml = &data->mloop[mp->loopstart];
   const MVert *mverts = data->mvert;
-  float(*vnors)[3] = data->vnors;
 
   float pnor_temp[3];
   float *pnor = data->pnors ? data->pnors[pidx] : pnor_temp;
@@ -260,36 +305,7 @@ static void mesh_calc_normals_poly_and_vertex_accum_fn(
     }
   }
 
-  /* Accumulate angle weighted face normal into the vertex normal. */
-  /* Inline version of #accumulate_vertex_normals_poly_v3. */
-  {
-    float edvec_prev[3], edvec_next[3], edvec_end[3];
-    const float *v_curr = mverts[ml[i_end].v].co;
-    sub_v3_v3v3(edvec_prev, mverts[ml[i_end - 1].v].co, v_curr);
-    normalize_v3(edvec_prev);
-    copy_v3_v3(edvec_end, edvec_prev);
-
-    for (int i_next = 0, i_curr = i_end; i_next <= i_end; i_curr = i_next++) {
-      const float *v_next = mverts[ml[i_next].v].co;
-
-      /* Skip an extra normalization by reusing the first calculated edge. */
-      if (i_next != i_end) {
-        sub_v3_v3v3(edvec_next, v_curr, v_next);
-        normalize_v3(edvec_next);
-      }
-      else {
-        copy_v3_v3(edvec_next, edvec_end);
-      }
-
-      /* Calculate angle between the two poly edges incident on this vertex. */
-      const float fac = saacos(-dot_v3v3(edvec_prev, edvec_next));
-      const float vnor_add[3] = {pnor[0] * fac, pnor[1] * fac, pnor[2] * fac};
-
-      add_v3_v3_atomic(vnors[ml[i_curr].v], vnor_add);
-      v_curr = v_next;
-      copy_v3_v3(edvec_prev, edvec_next);
-    }
-  }
+  mesh_poly_accumulate_vertex_normals(mverts, ml, mp->totloop, pnor, nullptr, data->vnors);
 }
 
 static void mesh_calc_normals_poly_and_vertex_finalize_fn(
@@ -337,6 +353,78 @@ void BKE_mesh_calc_normals_poly_and_vertex(const MVert *mvert,
       0, mvert_len, &data, mesh_calc_normals_poly_and_vertex_finalize_fn, &settings);
 }
 
+void BKE_mesh_calc_normals_poly_and_vertex_partial(const MVert *mvert,
+                                                   const int mvert_len,
+                                                   const MLoop *mloop,
+                                                   const int UNUSED(mloop_len),
+                                                   const MPoly *mpoly,
+                                                   const int mpoly_len,
+                                                   const int *poly_indices,
+                                                   const int poly_indices_len,
+                                                   float (*r_poly_normals)[3],
+                                                   float (*r_vert_normals)[3])
+{
+  using namespace blender;
+
+  threading::parallel_for(IndexRange(poly_indices_len), 1024, [&](const IndexRange range) {
+    for (const int i : range) {
+      const MPoly &poly = mpoly[poly_indices[i]];
+      BKE_mesh_calc_poly_normal(
+          &poly, &mloop[poly.loopstart], mvert, r_poly_normals[poly_indices[i]]);
+    }
+  });
+
+  if (r_vert_normals == nullptr) {
+    return;
+  }
+
+  /* The normals of all vertices used by the changed polygons are recalculated. */
+  BLI_bitmap *verts_mask = BLI_BITMAP_NEW(mvert_len, __func__);
+  Vector<int> vert_indices;
+  for (const int i : IndexRange(poly_indices_len)) {
+    const MPoly &poly = mpoly[poly_indices[i]];
+    for (const MLoop &loop : Span(&mloop[poly.loopstart], poly.totloop)) {
+      if (!BLI_BITMAP_TEST(verts_mask, loop.v)) {
+        BLI_BITMAP_ENABLE(verts_mask, loop.v);
+        vert_indices.append(int(loop.v));
+      }
+    }
+  }
+
+  for (const int vert : vert_indices) {
+    zero_v3(r_vert_normals[vert]);
+  }
+
+  /* Unchanged polygons can contribute to these vertices as well. Without a map from vertices to
+   * polygons they are found by testing all corners, which is still much cheaper than calculating
+   * the normals of all polygons. */
+  threading::parallel_for(IndexRange(mpoly_len), 1024, [&](const IndexRange range) {
+    for (const int poly_index : range) {
+      const MPoly &poly = mpoly[poly_index];
+      const MLoop *ml = &mloop[poly.loopstart];
+      for (const int i : IndexRange(poly.totloop)) {
+        if (BLI_BITMAP_TEST(verts_mask, ml[i].v)) {
+          mesh_poly_accumulate_vertex_normals(
+              mvert, ml, poly.totloop, r_poly_normals[poly_index], verts_mask, r_vert_normals);
+          break;
+        }
+      }
+    }
+  });
+
+  threading::parallel_for(vert_indices.index_range(), 1024, [&](const IndexRange range) {
+    for (const int vert : vert_indices.as_span().slice(range)) {
+      float *no = r_vert_normals[vert];
+      if (UNLIKELY(normalize_v3(no) == 0.0f)) {
+        /* Following Mesh convention; we use vertex coordinate itself for normal in this case. */
+        normalize_v3_v3(no, mvert[vert].co);
+      }
+    }
+  });
+
+  MEM_freeN(verts_mask);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
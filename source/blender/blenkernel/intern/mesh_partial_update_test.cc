@@ -0,0 +1,164 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bke
+ */
+
+#include "BLI_index_range.hh"
+#include "BLI_math.h"
+#include "BLI_math_vec_types.hh"
+#include "BLI_vector.hh"
+
+#include "BKE_mesh.h"
+
+#include "DNA_meshdata_types.h"
+
+#include "testing/testing.h"
+
+namespace blender::bke::tests {
+
+struct TestMesh {
+  Vector<MVert> verts;
+  Vector<MLoop> loops;
+  Vector<MPoly> polys;
+};
+
+static void add_poly(TestMesh &mesh, Span<int> verts)
+{
+  MPoly poly{};
+  poly.loopstart = int(mesh.loops.size());
+  poly.totloop = int(verts.size());
+  mesh.polys.append(poly);
+  for (const int vert : verts) {
+    MLoop loop{};
+    loop.v = uint(vert);
+    mesh.loops.append(loop);
+  }
+}
+
+/** A wavy grid of quads with an octagon next to it. */
+static TestMesh create_test_mesh(const int res)
+{
+  TestMesh mesh;
+  for (const int y : IndexRange(res)) {
+    for (const int x : IndexRange(res)) {
+      MVert vert{};
+      vert.co[0] = float(x);
+      vert.co[1] = float(y);
+      vert.co[2] = sinf(float(x)) * cosf(float(y));
+      mesh.verts.append(vert);
+    }
+  }
+  for (const int y : IndexRange(res - 1)) {
+    for (const int x : IndexRange(res - 1)) {
+      const int v = y * res + x;
+      add_poly(mesh, {v, v + 1, v + res + 1, v + res});
+    }
+  }
+
+  Vector<int> octagon;
+  for (const int i : IndexRange(8)) {
+    const float angle = float(i) * float(M_PI) / 4.0f;
+    MVert vert{};
+    vert.co[0] = -2.0f + cosf(angle);
+    vert.co[1] = 2.0f + sinf(angle);
+    vert.co[2] = 0.0f;
+    octagon.append(int(mesh.verts.size()));
+    mesh.verts.append(vert);
+  }
+  add_poly(mesh, octagon);
+  return mesh;
+}
+
+struct TestMeshCaches {
+  Vector<float3> poly_normals;
+  Vector<float3> vert_normals;
+  Vector<MLoopTri> looptris;
+};
+
+static TestMeshCaches calc_caches(const TestMesh &mesh)
+{
+  TestMeshCaches caches;
+  caches.poly_normals.resize(mesh.polys.size());
+  caches.vert_normals.resize(mesh.verts.size());
+  caches.looptris.resize(poly_to_tri_count(int(mesh.polys.size()), int(mesh.loops.size())));
+  BKE_mesh_calc_normals_poly_and_vertex(mesh.verts.data(),
+                                        int(mesh.verts.size()),
+                                        mesh.loops.data(),
+                                        int(mesh.loops.size()),
+                                        mesh.polys.data(),
+                                        int(mesh.polys.size()),
+                                        (float(*)[3])caches.poly_normals.data(),
+                                        (float(*)[3])caches.vert_normals.data());
+  BKE_mesh_recalc_looptri(mesh.loops.data(),
+                          mesh.polys.data(),
+                          mesh.verts.data(),
+                          int(mesh.loops.size()),
+                          int(mesh.polys.size()),
+                          caches.looptris.data());
+  return caches;
+}
+
+TEST(mesh_partial_update, MatchesFullUpdate)
+{
+  const int res = 32;
+  TestMesh mesh = create_test_mesh(res);
+  TestMeshCaches caches = calc_caches(mesh);
+
+  /* Move the vertices in one corner of the grid and of the octagon. */
+  Vector<bool> moved_verts(mesh.verts.size(), false);
+  for (const int i : mesh.verts.index_range()) {
+    MVert &vert = mesh.verts[i];
+    if (vert.co[0] < 6.0f && vert.co[1] < 6.0f) {
+      vert.co[0] += 0.3f * sinf(vert.co[1]);
+      vert.co[2] += 2.0f * cosf(vert.co[0] * 3.0f);
+      moved_verts[i] = true;
+    }
+  }
+
+  Vector<int> dirty_polys;
+  for (const int i : mesh.polys.index_range()) {
+    const MPoly &poly = mesh.polys[i];
+    for (const MLoop &loop : mesh.loops.as_span().slice(poly.loopstart, poly.totloop)) {
+      if (moved_verts[loop.v]) {
+        dirty_polys.append(i);
+        break;
+      }
+    }
+  }
+  EXPECT_GT(dirty_polys.size(), 0);
+  EXPECT_LT(dirty_polys.size(), mesh.polys.size() / 2);
+
+  BKE_mesh_calc_normals_poly_and_vertex_partial(mesh.verts.data(),
+                                                int(mesh.verts.size()),
+                                                mesh.loops.data(),
+                                                int(mesh.loops.size()),
+                                                mesh.polys.data(),
+                                                int(mesh.polys.size()),
+                                                dirty_polys.data(),
+                                                int(dirty_polys.size()),
+                                                (float(*)[3])caches.poly_normals.data(),
+                                                (float(*)[3])caches.vert_normals.data());
+  BKE_mesh_recalc_looptri_partial(mesh.loops.data(),
+                                  mesh.polys.data(),
+                                  mesh.verts.data(),
+                                  dirty_polys.data(),
+                                  int(dirty_polys.size()),
+                                  caches.looptris.data());
+
+  const TestMeshCaches expected = calc_caches(mesh);
+  for (const int i : mesh.polys.index_range()) {
+    EXPECT_V3_NEAR(caches.poly_normals[i], expected.poly_normals[i], 1e-5f);
+  }
+  for (const int i : mesh.verts.index_range()) {
+    EXPECT_V3_NEAR(caches.vert_normals[i], expected.vert_normals[i], 1e-5f);
+  }
+  for (const int i : caches.looptris.index_range()) {
+    for (const int j : IndexRange(3)) {
+      EXPECT_EQ(caches.looptris[i].tri[j], expected.looptris[i].tri[j]);
+    }
+    EXPECT_EQ(caches.looptris[i].poly, expected.looptris[i].poly);
+  }
+}
+
+}  // namespace blender::bke::tests
@@ -15,6 +15,7 @@
 
 #include "BLI_math_geom.h"
 #include "BLI_task.hh"
+#include "BLI_vector.hh"
 
 #include "BKE_bvhutils.h"
 #include "BKE_lib_id.h"
@@ -256,6 +257,60 @@ void BKE_mesh_runtime_clear_geometry(Mesh *mesh)
   BKE_shrinkwrap_discard_boundary_data(mesh);
 }
 
+void BKE_mesh_runtime_positions_changed_partial(Mesh *mesh, const BLI_bitmap *polys_mask)
+{
+  using namespace blender;
+
+  if (mesh->runtime.bvh_cache) {
+    bvhcache_free(mesh->runtime.bvh_cache);
+    mesh->runtime.bvh_cache = nullptr;
+  }
+  if (mesh->runtime.subdiv_ccg != nullptr) {
+    BKE_subdiv_ccg_destroy(mesh->runtime.subdiv_ccg);
+    mesh->runtime.subdiv_ccg = nullptr;
+  }
+  BKE_shrinkwrap_discard_boundary_data(mesh);
+
+  Vector<int> poly_indices;
+  for (const int i : IndexRange(mesh->totpoly)) {
+    if (BLI_BITMAP_TEST_BOOL(polys_mask, i)) {
+      poly_indices.append(i);
+    }
+  }
+  if (poly_indices.is_empty()) {
+    return;
+  }
+
+  if (BKE_mesh_poly_normals_are_dirty(mesh)) {
+    /* Vertex normals can't be updated without the normals of the unchanged polygons. */
+    BKE_mesh_normals_tag_dirty(mesh);
+  }
+  else {
+    float(*vert_normals)[3] = BKE_mesh_vertex_normals_are_dirty(mesh) ?
+                                  nullptr :
+                                  mesh->runtime.vert_normals;
+    BKE_mesh_calc_normals_poly_and_vertex_partial(mesh->mvert,
+                                                  mesh->totvert,
+                                                  mesh->mloop,
+                                                  mesh->totloop,
+                                                  mesh->mpoly,
+                                                  mesh->totpoly,
+                                                  poly_indices.data(),
+                                                  int(poly_indices.size()),
+                                                  mesh->runtime.poly_normals,
+                                                  vert_normals);
+  }
+
+  if (mesh->runtime.looptris.array != nullptr) {
+    BKE_mesh_recalc_looptri_partial(mesh->mloop,
+                                    mesh->mpoly,
+                                    mesh->mvert,
+                                    poly_indices.data(),
+                                    int(poly_indices.size()),
+                                    mesh->runtime.looptris.array);
+  }
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -586,6 +586,9 @@ struct TessellationUserData {
 
   /** Optional pre-calculated polygon normals array. */
   const float (*poly_normals)[3];
+
+  /** Indices of the polygons to tessellate, only used for partial updates. */
+  const int *poly_indices;
 };
 
 struct TessellationUserTLS {
@@ -626,6 +629,24 @@ static void mesh_calc_tessellation_for_face_with_normal_fn(void *__restrict user
                                        data->poly_normals[index]);
 }
 
+static void mesh_calc_tessellation_for_face_partial_fn(void *__restrict userdata,
+                                                       const int index,
+                                                       const TaskParallelTLS *__restrict tls)
+{
+  const struct TessellationUserData *data = userdata;
+  struct TessellationUserTLS *tls_data = tls->userdata_chunk;
+  const int poly_index = data->poly_indices[index];
+  const int tri_index = poly_to_tri_count(poly_index, data->mpoly[poly_index].loopstart);
+  mesh_calc_tessellation_for_face_impl(data->mloop,
+                                       data->mpoly,
+                                       data->mvert,
+                                       (uint)poly_index,
+                                       &data->mlooptri[tri_index],
+                                       &tls_data->pf_arena,
+                                       false,
+                                       NULL);
+}
+
 static void mesh_calc_tessellation_for_face_free_fn(const void *__restrict UNUSED(userdata),
                                                     void *__restrict tls_v)
 {
@@ -703,4 +724,34 @@ void BKE_mesh_recalc_looptri_with_normals(const MLoop *mloop,
   }
 }
 
+void BKE_mesh_recalc_looptri_partial(const MLoop *mloop,
+                                     const MPoly *mpoly,
+                                     const MVert *mvert,
+                                     const int *poly_indices,
+                                     const int poly_indices_len,
+                                     MLoopTri *mlooptri)
+{
+  struct TessellationUserTLS tls_data_dummy = {NULL};
+
+  struct TessellationUserData data = {
+      .mloop = mloop,
+      .mpoly = mpoly,
+      .mvert = mvert,
+      .mlooptri = mlooptri,
+      .poly_indices = poly_indices,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+
+  settings.userdata_chunk = &tls_data_dummy;
+  settings.userdata_chunk_size = sizeof(tls_data_dummy);
+
+  settings.func_free = mesh_calc_tessellation_for_face_free_fn;
+
+  BLI_task_parallel_range(
+      0, poly_indices_len, &data, mesh_calc_tessellation_for_face_partial_fn, &settings);
+}
+
 /** \} */
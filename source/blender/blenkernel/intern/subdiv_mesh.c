@@ -16,6 +16,7 @@
 
 #include "BLI_alloca.h"
 #include "BLI_math_vector.h"
+#include "BLI_task.h"
 
 #include "BKE_customdata.h"
 #include "BKE_key.h"
@@ -26,6 +27,11 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "opensubdiv_capi_type.h"
+
+/* Number of vertices that are evaluated at the limit surface together. */
+#define SUBDIV_MESH_EVAL_BATCH_SIZE 512
+
 /* -------------------------------------------------------------------- */
 /** \name Subdivision Context
  * \{ */
@@ -46,6 +52,10 @@ typedef struct SubdivMeshContext {
   /* Per-subdivided vertex counter of averaged values. */
   int *accumulated_counters;
   bool have_displacement;
+  /* Limit surface coordinates of every subdivided vertex, which are evaluated in batches after
+   * the traversal. Vertices which are not on the limit surface have a negative ptex face index.
+   * Only used when there is no displacement. */
+  OpenSubdiv_PatchCoord *vertex_patch_coords;
 } SubdivMeshContext;
 
 static void subdiv_mesh_ctx_cache_uv_layers(SubdivMeshContext *ctx)
@@ -79,9 +89,22 @@ static void subdiv_mesh_prepare_accumulator(SubdivMeshContext *ctx, int num_vert
       num_vertices, sizeof(*ctx->accumulated_counters), "subdiv accumulated counters");
 }
 
+static void subdiv_mesh_prepare_vertex_patch_coords(SubdivMeshContext *ctx, int num_vertices)
+{
+  if (ctx->have_displacement) {
+    return;
+  }
+  ctx->vertex_patch_coords = MEM_malloc_arrayN(
+      num_vertices, sizeof(*ctx->vertex_patch_coords), "subdiv vertex patch coords");
+  for (int i = 0; i < num_vertices; i++) {
+    ctx->vertex_patch_coords[i].ptex_face = -1;
+  }
+}
+
 static void subdiv_mesh_context_free(SubdivMeshContext *ctx)
 {
   MEM_SAFE_FREE(ctx->accumulated_counters);
+  MEM_SAFE_FREE(ctx->vertex_patch_coords);
 }
 
 /** \} */
@@ -464,6 +487,7 @@ static bool subdiv_mesh_topology_info(const SubdivForeachContext *foreach_contex
       subdiv_context->coarse_mesh, num_vertices, num_edges, 0, num_loops, num_polygons, mask);
   subdiv_mesh_ctx_cache_custom_data_layers(subdiv_context);
   subdiv_mesh_prepare_accumulator(subdiv_context, num_vertices);
+  subdiv_mesh_prepare_vertex_patch_coords(subdiv_context, num_vertices);
   return true;
 }
 
@@ -505,6 +529,25 @@ static void subdiv_vertex_data_interpolate(const SubdivMeshContext *ctx,
   }
 }
 
+/* Evaluate position of the vertex at the limit surface. When possible, only its coordinate is
+ * stored here, and positions of all vertices are evaluated in batches after the traversal. */
+static void evaluate_vertex_limit_point(const SubdivMeshContext *ctx,
+                                        const int ptex_face_index,
+                                        const float u,
+                                        const float v,
+                                        MVert *subdiv_vert)
+{
+  if (ctx->vertex_patch_coords == NULL) {
+    BKE_subdiv_eval_limit_point(ctx->subdiv, ptex_face_index, u, v, subdiv_vert->co);
+    return;
+  }
+  const int subdiv_vertex_index = subdiv_vert - ctx->subdiv_mesh->mvert;
+  OpenSubdiv_PatchCoord *patch_coord = &ctx->vertex_patch_coords[subdiv_vertex_index];
+  patch_coord->ptex_face = ptex_face_index;
+  patch_coord->u = u;
+  patch_coord->v = v;
+}
+
 static void evaluate_vertex_and_apply_displacement_copy(const SubdivMeshContext *ctx,
                                                         const int ptex_face_index,
                                                         const float u,
@@ -523,7 +566,7 @@ static void evaluate_vertex_and_apply_displacement_copy(const SubdivMeshContext
   }
   /* Copy custom data and evaluate position. */
   subdiv_vertex_data_copy(ctx, coarse_vert, subdiv_vert);
-  BKE_subdiv_eval_limit_point(ctx->subdiv, ptex_face_index, u, v, subdiv_vert->co);
+  evaluate_vertex_limit_point(ctx, ptex_face_index, u, v, subdiv_vert);
   /* Apply displacement. */
   add_v3_v3(subdiv_vert->co, D);
   /* Remove facedot flag. This can happen if there is more than one subsurf modifier. */
@@ -549,7 +592,7 @@ static void evaluate_vertex_and_apply_displacement_interpolate(
   }
   /* Interpolate custom data and evaluate position. */
   subdiv_vertex_data_interpolate(ctx, subdiv_vert, vertex_interpolation, u, v);
-  BKE_subdiv_eval_limit_point(ctx->subdiv, ptex_face_index, u, v, subdiv_vert->co);
+  evaluate_vertex_limit_point(ctx, ptex_face_index, u, v, subdiv_vert);
   /* Apply displacement. */
   add_v3_v3(subdiv_vert->co, D);
 }
@@ -716,7 +759,12 @@ static void subdiv_mesh_vertex_inner(const SubdivForeachContext *foreach_context
   MVert *subdiv_vert = &subdiv_mvert[subdiv_vertex_index];
   subdiv_mesh_ensure_vertex_interpolation(ctx, tls, coarse_poly, coarse_corner);
   subdiv_vertex_data_interpolate(ctx, subdiv_vert, &tls->vertex_interpolation, u, v);
-  BKE_subdiv_eval_final_point(subdiv, ptex_face_index, u, v, subdiv_vert->co);
+  if (ctx->have_displacement) {
+    BKE_subdiv_eval_final_point(subdiv, ptex_face_index, u, v, subdiv_vert->co);
+  }
+  else {
+    evaluate_vertex_limit_point(ctx, ptex_face_index, u, v, subdiv_vert);
+  }
   subdiv_mesh_tag_center_vertex(coarse_poly, subdiv_vert, u, v);
 }
 
@@ -1076,6 +1124,50 @@ static void subdiv_mesh_vertex_of_loose_edge(const struct SubdivForeachContext *
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Batched vertex evaluation
+ * \{ */
+
+static void subdiv_mesh_eval_vertex_batch_task(void *__restrict userdata,
+                                               const int batch_index,
+                                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SubdivMeshContext *ctx = userdata;
+  MVert *subdiv_mvert = ctx->subdiv_mesh->mvert;
+  const int start = batch_index * SUBDIV_MESH_EVAL_BATCH_SIZE;
+  const int end = min_ii(start + SUBDIV_MESH_EVAL_BATCH_SIZE, ctx->subdiv_mesh->totvert);
+  /* Skip vertices which are not on the limit surface, like the ones of loose elements. */
+  OpenSubdiv_PatchCoord patch_coords[SUBDIV_MESH_EVAL_BATCH_SIZE];
+  int vertex_indices[SUBDIV_MESH_EVAL_BATCH_SIZE];
+  int num_patch_coords = 0;
+  for (int i = start; i < end; i++) {
+    if (ctx->vertex_patch_coords[i].ptex_face < 0) {
+      continue;
+    }
+    patch_coords[num_patch_coords] = ctx->vertex_patch_coords[i];
+    vertex_indices[num_patch_coords] = i;
+    num_patch_coords++;
+  }
+  float P[SUBDIV_MESH_EVAL_BATCH_SIZE][3];
+  BKE_subdiv_eval_limit_points(ctx->subdiv, patch_coords, num_patch_coords, P);
+  for (int i = 0; i < num_patch_coords; i++) {
+    copy_v3_v3(subdiv_mvert[vertex_indices[i]].co, P[i]);
+  }
+}
+
+/* Evaluate positions of all vertices whose coordinates were stored during the traversal. */
+static void subdiv_mesh_eval_vertex_positions(SubdivMeshContext *ctx)
+{
+  const int num_vertices = ctx->subdiv_mesh->totvert;
+  const int num_batches = (num_vertices + SUBDIV_MESH_EVAL_BATCH_SIZE - 1) /
+                          SUBDIV_MESH_EVAL_BATCH_SIZE;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  BLI_task_parallel_range(0, num_batches, ctx, subdiv_mesh_eval_vertex_batch_task, &settings);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Initialization
  * \{ */
@@ -1142,6 +1234,9 @@ Mesh *BKE_subdiv_to_mesh(Subdiv *subdiv,
   foreach_context.user_data_tls_size = sizeof(SubdivMeshTLS);
   foreach_context.user_data_tls = &tls;
   BKE_subdiv_foreach_subdiv_geometry(subdiv, &foreach_context, settings, coarse_mesh);
+  if (subdiv_context.vertex_patch_coords != NULL) {
+    subdiv_mesh_eval_vertex_positions(&subdiv_context);
+  }
   BKE_subdiv_stats_end(&subdiv->stats, SUBDIV_STATS_SUBDIV_TO_MESH_GEOMETRY);
   Mesh *result = subdiv_context.subdiv_mesh;
   // BKE_mesh_validate(result, true, true);
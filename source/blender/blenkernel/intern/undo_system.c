@@ -29,6 +29,8 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "PIL_time.h"
+
 #define undo_stack _wm_undo_stack_disallow /* pass in as a variable always. */
 
 /** Odd requirement of Blender that we always keep a memfile undo in the stack. */
@@ -141,9 +143,16 @@ static bool undosys_step_encode(bContext *C, Main *bmain, UndoStack *ustack, Und
 {
   CLOG_INFO(&LOG, 2, "addr=%p, name='%s', type='%s'", us, us->name, us->type->name);
   UNDO_NESTED_CHECK_BEGIN;
+  const double time_start = PIL_check_seconds_timer();
   bool ok = us->type->step_encode(C, bmain, us);
+  us->encode_time = PIL_check_seconds_timer() - time_start;
   UNDO_NESTED_CHECK_END;
   if (ok) {
+    CLOG_INFO(&LOG,
+              2,
+              "encoded in %.3f ms, size=%zu bytes",
+              us->encode_time * 1000.0,
+              us->data_size);
     if (us->type->step_foreach_ID_ref != NULL) {
       /* Don't use from context yet because sometimes context is fake and
        * not all members are filled in. */
@@ -958,7 +967,7 @@ void BKE_undosys_print(UndoStack *ustack)
          BLI_listbase_count(&ustack->steps));
   int index = 0;
   LISTBASE_FOREACH (UndoStep *, us, &ustack->steps) {
-    printf("[%c%c%c%c] %3d {%p} type='%s', name='%s'\n",
+    printf("[%c%c%c%c] %3d {%p} type='%s', name='%s', size=%zu, encode=%.3fms\n",
            (us == ustack->step_active) ? '*' : ' ',
            us->is_applied ? '#' : ' ',
            (us == ustack->step_active_memfile) ? 'M' : ' ',
@@ -966,7 +975,9 @@ void BKE_undosys_print(UndoStack *ustack)
            index,
            (void *)us,
            us->type->name,
-           us->name);
+           us->name,
+           us->data_size,
+           us->encode_time * 1000.0);
     index++;
   }
 }
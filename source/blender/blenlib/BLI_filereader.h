@@ -57,6 +57,15 @@ FileReader *BLI_filereader_new_memory(const void *data, size_t len) ATTR_WARN_UN
     ATTR_NONNULL();
 /** Create #FileReader from applying `Zstd` decompression on an underlying file. */
 FileReader *BLI_filereader_new_zstd(FileReader *base) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+/**
+ * Same as #BLI_filereader_new_zstd, but when the file contains a seek table (as written by
+ * Blender), all independent frames are decompressed up-front in parallel using the task
+ * scheduler. Falls back to on-demand decompression for files without a seek table.
+ *
+ * \note This keeps the entire uncompressed stream in memory while the reader is open.
+ */
+FileReader *BLI_filereader_new_zstd_threaded(FileReader *base) ATTR_WARN_UNUSED_RESULT
+    ATTR_NONNULL();
 /** Create #FileReader from applying `Gzip` decompression on an underlying file. */
 FileReader *BLI_filereader_new_gzip(FileReader *base) ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
 
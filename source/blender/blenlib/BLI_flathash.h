@@ -0,0 +1,320 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * FlatHash is an open-addressing hash-map for C code (unordered key, value pairs).
+ *
+ * It is a drop-in alternative to #GHash using the same hash & compare callbacks,
+ * but stores its entries in a single flat array instead of allocating one node per entry.
+ * Lookups probe groups of 16 slots at once using a byte of hash metadata per slot
+ * (using SSE2 when available), similar to #blender::Map and #blender::Set in C++.
+ *
+ * This is also used to implement a 'set' (see #FlatSet below).
+ *
+ * \note Unlike #GHash, pointers returned by #BLI_flathash_lookup_p & #BLI_flathash_ensure_p
+ * are only valid until the next insertion, since the table may be resized.
+ */
+
+#include "BLI_compiler_attrs.h"
+#include "BLI_compiler_compat.h"
+#include "BLI_ghash.h"
+#include "BLI_sys_types.h" /* for bool */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* -------------------------------------------------------------------- */
+/** \name FlatHash Types
+ * \{ */
+
+typedef struct FlatHash FlatHash;
+
+typedef struct FlatHashIterator {
+  FlatHash *fh;
+  struct FlatHashEntry *curr_entry;
+  unsigned int curr_index;
+} FlatHashIterator;
+
+typedef struct FlatHashIterState {
+  unsigned int curr_index;
+} FlatHashIterState;
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name FlatHash API
+ *
+ * Defined in `flathash.c`
+ * \{ */
+
+/**
+ * Creates a new, empty FlatHash.
+ *
+ * \param hashfp: Hash callback.
+ * \param cmpfp: Comparison callback (returns false when equal, as for #GHash).
+ * \param info: Identifier string for the FlatHash.
+ * \param nentries_reserve: Optionally reserve the number of members that the hash will hold.
+ * \return An empty FlatHash.
+ */
+FlatHash *BLI_flathash_new_ex(GHashHashFP hashfp,
+                              GHashCmpFP cmpfp,
+                              const char *info,
+                              unsigned int nentries_reserve) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+/**
+ * Wraps #BLI_flathash_new_ex with zero entries reserved.
+ */
+FlatHash *BLI_flathash_new(GHashHashFP hashfp,
+                           GHashCmpFP cmpfp,
+                           const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+/**
+ * Frees the FlatHash and its members.
+ *
+ * \param keyfreefp: Optional callback to free the key.
+ * \param valfreefp: Optional callback to free the value.
+ */
+void BLI_flathash_free(FlatHash *fh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp);
+/**
+ * Reserve given amount of entries (resize \a fh accordingly if needed).
+ */
+void BLI_flathash_reserve(FlatHash *fh, unsigned int nentries_reserve);
+/**
+ * Insert a key/value pair into \a fh.
+ *
+ * \note Duplicates are not checked (except in debug builds),
+ * the caller is expected to ensure elements are unique.
+ */
+void BLI_flathash_insert(FlatHash *fh, void *key, void *val);
+/**
+ * Inserts a new value to a key that may already be in \a fh.
+ *
+ * \returns true if a new key has been added.
+ */
+bool BLI_flathash_reinsert(
+    FlatHash *fh, void *key, void *val, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp);
+/**
+ * Lookup the value of \a key in \a fh.
+ *
+ * \returns the value for \a key or NULL.
+ */
+void *BLI_flathash_lookup(const FlatHash *fh, const void *key) ATTR_WARN_UNUSED_RESULT;
+/**
+ * A version of #BLI_flathash_lookup which accepts a fallback argument.
+ */
+void *BLI_flathash_lookup_default(const FlatHash *fh,
+                                  const void *key,
+                                  void *val_default) ATTR_WARN_UNUSED_RESULT;
+/**
+ * Lookup a pointer to the value of \a key in \a fh.
+ *
+ * \returns the pointer to value for \a key or NULL.
+ */
+void **BLI_flathash_lookup_p(FlatHash *fh, const void *key) ATTR_WARN_UNUSED_RESULT;
+/**
+ * Ensure \a key is exists in \a fh, see #BLI_ghash_ensure_p.
+ *
+ * \returns true when the value didn't need to be added.
+ * (when false, the caller _must_ initialize the value).
+ */
+bool BLI_flathash_ensure_p(FlatHash *fh, void *key, void ***r_val) ATTR_WARN_UNUSED_RESULT;
+/**
+ * A version of #BLI_flathash_ensure_p that allows caller to re-assign the key.
+ *
+ * \warning Caller _must_ write to \a r_key when returning false.
+ */
+bool BLI_flathash_ensure_p_ex(FlatHash *fh, const void *key, void ***r_key, void ***r_val)
+    ATTR_WARN_UNUSED_RESULT;
+/**
+ * Remove \a key from \a fh, or return false if the key wasn't found.
+ */
+bool BLI_flathash_remove(FlatHash *fh,
+                         const void *key,
+                         GHashKeyFreeFP keyfreefp,
+                         GHashValFreeFP valfreefp);
+/**
+ * Remove \a key from \a fh, returning the value or NULL if the key wasn't found.
+ */
+void *BLI_flathash_popkey(FlatHash *fh,
+                          const void *key,
+                          GHashKeyFreeFP keyfreefp) ATTR_WARN_UNUSED_RESULT;
+/**
+ * \return true if the \a key is in \a fh.
+ */
+bool BLI_flathash_haskey(const FlatHash *fh, const void *key) ATTR_WARN_UNUSED_RESULT;
+/**
+ * Remove a random entry from \a fh, returning true
+ * if a key/value pair could be removed, false otherwise.
+ *
+ * \param state: Used for efficient removal, must be zero initialized.
+ */
+bool BLI_flathash_pop(FlatHash *fh, FlatHashIterState *state, void **r_key, void **r_val)
+    ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+/**
+ * Wraps #BLI_flathash_clear_ex with zero entries reserved.
+ */
+void BLI_flathash_clear(FlatHash *fh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp);
+/**
+ * Reset \a fh clearing all entries.
+ *
+ * \param nentries_reserve: Optionally reserve the number of members that the hash will hold,
+ * when zero the current allocation is kept.
+ */
+void BLI_flathash_clear_ex(FlatHash *fh,
+                           GHashKeyFreeFP keyfreefp,
+                           GHashValFreeFP valfreefp,
+                           unsigned int nentries_reserve);
+/**
+ * \return size of the FlatHash.
+ */
+unsigned int BLI_flathash_len(const FlatHash *fh) ATTR_WARN_UNUSED_RESULT;
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name FlatHash Iterator
+ *
+ * The hash table must not be mutated while the iterator is in use.
+ * \{ */
+
+void BLI_flathashIterator_init(FlatHashIterator *fhi, FlatHash *fh);
+void BLI_flathashIterator_step(FlatHashIterator *fhi);
+
+BLI_INLINE void *BLI_flathashIterator_getKey(FlatHashIterator *fhi) ATTR_WARN_UNUSED_RESULT;
+BLI_INLINE void *BLI_flathashIterator_getValue(FlatHashIterator *fhi) ATTR_WARN_UNUSED_RESULT;
+BLI_INLINE void **BLI_flathashIterator_getValue_p(FlatHashIterator *fhi) ATTR_WARN_UNUSED_RESULT;
+BLI_INLINE bool BLI_flathashIterator_done(const FlatHashIterator *fhi) ATTR_WARN_UNUSED_RESULT;
+
+struct _fh_Entry {
+  void *key, *val;
+};
+BLI_INLINE void *BLI_flathashIterator_getKey(FlatHashIterator *fhi)
+{
+  return ((struct _fh_Entry *)fhi->curr_entry)->key;
+}
+BLI_INLINE void *BLI_flathashIterator_getValue(FlatHashIterator *fhi)
+{
+  return ((struct _fh_Entry *)fhi->curr_entry)->val;
+}
+BLI_INLINE void **BLI_flathashIterator_getValue_p(FlatHashIterator *fhi)
+{
+  return &((struct _fh_Entry *)fhi->curr_entry)->val;
+}
+BLI_INLINE bool BLI_flathashIterator_done(const FlatHashIterator *fhi)
+{
+  return !fhi->curr_entry;
+}
+/* disallow further access */
+#ifdef __GNUC__
+#  pragma GCC poison _fh_Entry
+#else
+#  define _fh_Entry void
+#endif
+
+#define FLATHASH_ITER(fh_iter_, flathash_) \
+  for (BLI_flathashIterator_init(&fh_iter_, flathash_); \
+       BLI_flathashIterator_done(&fh_iter_) == false; \
+       BLI_flathashIterator_step(&fh_iter_))
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name FlatSet API
+ *
+ * A 'set' implementation (unordered collection of unique elements).
+ * Internally this is a #FlatHash which never stores values.
+ * \{ */
+
+typedef struct FlatSet FlatSet;
+
+/** Use a FlatSet specific type so we can cast but compiler sees as different */
+typedef struct FlatSetIterator {
+  FlatHashIterator _fhi;
+} FlatSetIterator;
+
+FlatSet *BLI_flatset_new_ex(GHashHashFP hashfp,
+                            GHashCmpFP cmpfp,
+                            const char *info,
+                            unsigned int nentries_reserve) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+FlatSet *BLI_flatset_new(GHashHashFP hashfp,
+                         GHashCmpFP cmpfp,
+                         const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+void BLI_flatset_free(FlatSet *fs, GHashKeyFreeFP keyfreefp);
+void BLI_flatset_reserve(FlatSet *fs, unsigned int nentries_reserve);
+/**
+ * Adds the key to the set (no checks for unique keys!).
+ * Matching #BLI_flathash_insert
+ */
+void BLI_flatset_insert(FlatSet *fs, void *key);
+/**
+ * A version of #BLI_flatset_insert which checks first if the key is in the set.
+ * \returns true if a new key has been added.
+ */
+bool BLI_flatset_add(FlatSet *fs, void *key);
+/**
+ * Set counterpart to #BLI_flathash_ensure_p_ex.
+ * similar to #BLI_flatset_add, except it returns the key pointer.
+ *
+ * \warning Caller _must_ write to \a r_key when returning false.
+ */
+bool BLI_flatset_ensure_p_ex(FlatSet *fs, const void *key, void ***r_key);
+bool BLI_flatset_haskey(const FlatSet *fs, const void *key) ATTR_WARN_UNUSED_RESULT;
+bool BLI_flatset_remove(FlatSet *fs, const void *key, GHashKeyFreeFP keyfreefp);
+bool BLI_flatset_pop(FlatSet *fs, FlatHashIterState *state, void **r_key)
+    ATTR_WARN_UNUSED_RESULT ATTR_NONNULL();
+void BLI_flatset_clear(FlatSet *fs, GHashKeyFreeFP keyfreefp);
+void BLI_flatset_clear_ex(FlatSet *fs, GHashKeyFreeFP keyfreefp, unsigned int nentries_reserve);
+unsigned int BLI_flatset_len(const FlatSet *fs) ATTR_WARN_UNUSED_RESULT;
+
+BLI_INLINE void BLI_flatsetIterator_init(FlatSetIterator *fsi, FlatSet *fs)
+{
+  BLI_flathashIterator_init((FlatHashIterator *)fsi, (FlatHash *)fs);
+}
+BLI_INLINE void BLI_flatsetIterator_step(FlatSetIterator *fsi)
+{
+  BLI_flathashIterator_step((FlatHashIterator *)fsi);
+}
+BLI_INLINE void *BLI_flatsetIterator_getKey(FlatSetIterator *fsi)
+{
+  return BLI_flathashIterator_getKey((FlatHashIterator *)fsi);
+}
+BLI_INLINE bool BLI_flatsetIterator_done(const FlatSetIterator *fsi)
+{
+  return BLI_flathashIterator_done((const FlatHashIterator *)fsi);
+}
+
+#define FLATSET_ITER(fs_iter_, flatset_) \
+  for (BLI_flatsetIterator_init(&fs_iter_, flatset_); \
+       BLI_flatsetIterator_done(&fs_iter_) == false; \
+       BLI_flatsetIterator_step(&fs_iter_))
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Convenience FlatHash/FlatSet Creation Functions
+ * \{ */
+
+FlatHash *BLI_flathash_ptr_new_ex(const char *info, unsigned int nentries_reserve)
+    ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+FlatHash *BLI_flathash_ptr_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+FlatHash *BLI_flathash_str_new_ex(const char *info, unsigned int nentries_reserve)
+    ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+FlatHash *BLI_flathash_str_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+FlatHash *BLI_flathash_int_new_ex(const char *info, unsigned int nentries_reserve)
+    ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+FlatHash *BLI_flathash_int_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+
+FlatSet *BLI_flatset_ptr_new_ex(const char *info, unsigned int nentries_reserve)
+    ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+FlatSet *BLI_flatset_ptr_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+FlatSet *BLI_flatset_str_new_ex(const char *info, unsigned int nentries_reserve)
+    ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+FlatSet *BLI_flatset_str_new(const char *info) ATTR_MALLOC ATTR_WARN_UNUSED_RESULT;
+
+/** \} */
+
+#ifdef __cplusplus
+}
+#endif
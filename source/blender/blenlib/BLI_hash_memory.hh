@@ -0,0 +1,24 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Hashes of large memory blocks, used to detect whether data has changed when there is no other
+ * way to tell. The hashes have 64 bits, so that collisions are very unlikely.
+ */
+
+#include "BLI_sys_types.h"
+
+namespace blender {
+
+uint64_t hash_memory(const void *data, int64_t size);
+
+/**
+ * Same as #hash_memory, but hashes chunks of large memory blocks in parallel. The result is
+ * different from #hash_memory for large blocks.
+ */
+uint64_t hash_memory_parallel(const void *data, int64_t size);
+
+}  // namespace blender
@@ -85,6 +85,10 @@ enum {
   /* calculate IsectRayPrecalc data */
   BVH_RAYCAST_WATERTIGHT = (1 << 0),
 };
+enum {
+  /* Split leafs with the surface area heuristic, for faster queries. */
+  BVH_BALANCE_SAH = (1 << 0),
+};
 #define BVH_RAYCAST_DEFAULT (BVH_RAYCAST_WATERTIGHT)
 #define BVH_RAYCAST_DIST_MAX (FLT_MAX / 2.0f)
 
@@ -154,6 +158,11 @@ void BLI_bvhtree_free(BVHTree *tree);
  */
 void BLI_bvhtree_insert(BVHTree *tree, int index, const float co[3], int numpoints);
 void BLI_bvhtree_balance(BVHTree *tree);
+/**
+ * \param flag: #BVH_BALANCE_SAH to build the tree with the surface area heuristic,
+ * in parallel over sub-trees, instead of splitting the leafs at the median of the largest axis.
+ */
+void BLI_bvhtree_balance_ex(BVHTree *tree, int flag);
 
 /**
  * Update: first update points/nodes, then call update_tree to refit the bounding volumes.
@@ -225,6 +234,23 @@ int BLI_bvhtree_find_nearest(BVHTree *tree,
                              BVHTreeNearest *nearest,
                              BVHTree_NearestPointCallback callback,
                              void *userdata);
+/**
+ * Find the nearest nodes for many positions at once, like calling #BLI_bvhtree_find_nearest_ex
+ * for every position. The positions are sorted spatially and searched in small packets that
+ * traverse the tree together, which is faster than separate searches when positions are close
+ * to each other. Only ties between equally distant nodes may be resolved differently.
+ *
+ * \param nearests: One for every position, they must be initialized like the `nearest`
+ * argument of #BLI_bvhtree_find_nearest_ex and contain the results afterwards.
+ * \param callback: Called from multiple threads, it must be thread-safe.
+ */
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*positions)[3],
+                                    int positions_num,
+                                    BVHTreeNearest *nearests,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    int flag);
 
 /**
  * Find the first node nearby.
@@ -251,6 +277,24 @@ int BLI_bvhtree_ray_cast(BVHTree *tree,
                          BVHTreeRayHit *hit,
                          BVHTree_RayCastCallback callback,
                          void *userdata);
+/**
+ * Cast many rays at once, like calling #BLI_bvhtree_ray_cast_ex for every ray. The rays are
+ * sorted by their origin and traced in small packets that traverse the tree together.
+ *
+ * \param directions: Normalized ray directions.
+ * \param hits: One for every ray, they must be initialized like the `hit` argument of
+ * #BLI_bvhtree_ray_cast_ex and contain the results afterwards.
+ * \param callback: Called from multiple threads, it must be thread-safe.
+ */
+void BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                                const float (*origins)[3],
+                                const float (*directions)[3],
+                                int rays_num,
+                                float radius,
+                                BVHTreeRayHit *hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                int flag);
 
 /**
  * Calls the callback for every ray intersection
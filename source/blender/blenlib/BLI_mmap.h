@@ -33,6 +33,13 @@ bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length
 
 void *BLI_mmap_get_pointer(BLI_mmap_file *file) ATTR_WARN_UNUSED_RESULT;
 
+/* Hints that the given range of the file won't be accessed again (e.g. because it was
+ * already copied out with #BLI_mmap_read), so the pages backing it can be dropped from
+ * the resident set. Only whole pages inside the range are released, reading them again
+ * later is still valid and simply faults the data back in from the file.
+ * This is a no-op on platforms that don't support it. */
+void BLI_mmap_release(BLI_mmap_file *file, size_t offset, size_t length) ATTR_NONNULL(1);
+
 void BLI_mmap_free(BLI_mmap_file *file) ATTR_NONNULL(1);
 
 #ifdef __cplusplus
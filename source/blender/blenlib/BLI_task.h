@@ -125,6 +125,12 @@ void *BLI_task_pool_user_data(TaskPool *pool);
  */
 ThreadMutex *BLI_task_pool_user_mutex(TaskPool *pool);
 
+/**
+ * Optional name used to identify the pool's tasks in traces, see #BLI_task_trace_begin.
+ * Must be a static string.
+ */
+void BLI_task_pool_name_set(TaskPool *pool, const char *name);
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -399,6 +405,39 @@ void BLI_task_graph_edge_create(struct TaskNode *from_node, struct TaskNode *to_
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Task Tracing
+ *
+ * Opt-in recording of when tasks from task pools, parallel ranges and task graphs are queued,
+ * start and finish, and on which thread. Useful to find where work fails to scale over threads.
+ *
+ * Events are kept in a fixed size ring buffer per thread, so only the most recent events of a
+ * long recording are kept. The overhead when tracing is disabled is a single atomic load per task.
+ * \{ */
+
+/**
+ * Start recording, events recorded before are discarded from the output.
+ */
+void BLI_task_trace_begin(void);
+void BLI_task_trace_end(void);
+bool BLI_task_trace_is_enabled(void);
+/**
+ * Write the recorded events as Chrome trace JSON,
+ * to be viewed with `chrome://tracing` or https://ui.perfetto.dev.
+ * Tracing has to be stopped with #BLI_task_trace_end first, because the events are read while
+ * other threads could still write them otherwise.
+ *
+ * \return false when tracing is still running or the file couldn't be written.
+ */
+bool BLI_task_trace_write_json(const char *filepath);
+/**
+ * Stop recording and write the events to `filepath` in #BLI_task_scheduler_exit,
+ * used to trace an entire session (see `--debug-task-trace`).
+ */
+void BLI_task_trace_write_json_on_exit(const char *filepath);
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name Task Isolation
  *
@@ -35,6 +35,17 @@
 
 namespace blender::threading {
 
+namespace detail {
+/* Forward task tracing to the implementation, see #BLI_task_trace_begin. */
+bool trace_is_enabled();
+uint64_t trace_time_now();
+void trace_event_add(const char *name,
+                     const char *category,
+                     uint64_t time_queued,
+                     uint64_t time_begin,
+                     uint64_t time_end);
+}  // namespace detail
+
 template<typename Range, typename Function>
 void parallel_for_each(Range &range, const Function &function)
 {
@@ -56,10 +67,21 @@ void parallel_for(IndexRange range, int64_t grain_size, const Function &function
 #ifdef WITH_TBB
   /* Invoking tbb for small workloads has a large overhead. */
   if (range.size() >= grain_size) {
+    const uint64_t trace_time_queued = detail::trace_is_enabled() ? detail::trace_time_now() : 0;
     tbb::parallel_for(
         tbb::blocked_range<int64_t>(range.first(), range.one_after_last(), grain_size),
         [&](const tbb::blocked_range<int64_t> &subrange) {
+          if (trace_time_queued == 0) {
+            function(IndexRange(subrange.begin(), subrange.size()));
+            return;
+          }
+          const uint64_t trace_time_begin = detail::trace_time_now();
           function(IndexRange(subrange.begin(), subrange.size()));
+          detail::trace_event_add("threading::parallel_for",
+                                  "parallel_for",
+                                  trace_time_queued,
+                                  trace_time_begin,
+                                  detail::trace_time_now());
         });
     return;
   }
@@ -20,10 +20,15 @@
  *   #BLI_bvhtree_overlap, #BVHOverlapData_Shared, #BVHOverlapData_Thread
  * - Range Query:
  *   #BLI_bvhtree_range_query
+ *
+ * Trees are either built as implicit trees split at the median of the largest axis,
+ * or with the surface area heuristic (#BVH_BALANCE_SAH).
  */
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 #include "BLI_alloca.h"
 #include "BLI_heap_simple.h"
 #include "BLI_kdopbvh.h"
@@ -54,6 +59,12 @@
 #  define KDOPBVH_THREAD_LEAF_THRESHOLD 1024
 #endif
 
+/* Number of bins per axis that are evaluated to find the best SAH split. */
+#define KDOPBVH_SAH_BINS 16
+
+/* Number of queries that traverse the tree together in batched queries. */
+#define KDOPBVH_PACKET_SIZE 8
+
 /* -------------------------------------------------------------------- */
 /** \name Struct Definitions
  * \{ */
@@ -233,6 +244,101 @@ static void node_minmax_init(const BVHTree *tree, BVHNode *node)
   }
 }
 
+/* Spread the lower 10 bits of the value, so that there are two zero bits between all bits. */
+static uint morton_expand_bits(uint v)
+{
+  v = (v * 0x00010001u) & 0xFF0000FFu;
+  v = (v * 0x00000101u) & 0x0F00F00Fu;
+  v = (v * 0x00000011u) & 0xC30C30C3u;
+  v = (v * 0x00000005u) & 0x49249249u;
+  return v;
+}
+
+typedef struct QueryOrderData {
+  const float (*positions)[3];
+  float min[3];
+  float scale[3];
+  uint *codes;
+} QueryOrderData;
+
+static void query_order_code_cb(void *__restrict userdata,
+                                const int i,
+                                const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  QueryOrderData *data = userdata;
+  uint code = 0;
+  for (int axis = 0; axis < 3; axis++) {
+    const float f = (data->positions[i][axis] - data->min[axis]) * data->scale[axis];
+    /* Non-finite positions are clamped to the bounds, the comparison is false for NaN. */
+    const uint cell = (f > 0.0f) ? (uint)min_ff(f, 1023.0f) : 0;
+    code |= morton_expand_bits(cell) << axis;
+  }
+  data->codes[i] = code;
+}
+
+/**
+ * Sort the queries along a Z-order curve through their positions, so that queries that are
+ * processed together are close to each other and visit the same nodes.
+ *
+ * \return The query indices in the sorted order, must be freed by the caller.
+ */
+static int *query_order_morton(const float (*positions)[3], const int positions_num)
+{
+  QueryOrderData data = {.positions = positions};
+
+  float max[3];
+  INIT_MINMAX(data.min, max);
+  for (int i = 0; i < positions_num; i++) {
+    if (is_finite_v3(positions[i])) {
+      minmax_v3v3_v3(data.min, max, positions[i]);
+    }
+  }
+  for (int axis = 0; axis < 3; axis++) {
+    const float extent = max[axis] - data.min[axis];
+    if (!(extent >= 0.0f)) {
+      /* There are no finite positions. */
+      data.min[axis] = 0.0f;
+    }
+    data.scale[axis] = (extent > 0.0f) ? 1023.0f / extent : 0.0f;
+  }
+
+  data.codes = MEM_malloc_arrayN((size_t)positions_num, sizeof(*data.codes), __func__);
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (positions_num > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  settings.min_iter_per_thread = 1024;
+  BLI_task_parallel_range(0, positions_num, &data, query_order_code_cb, &settings);
+
+  /* Stable radix sort of the 30 bit codes with 10 bits per pass, which is much faster than a
+   * comparison sort. Queries with the same code keep their order. */
+  int *indices = MEM_malloc_arrayN((size_t)positions_num, sizeof(*indices), __func__);
+  int *indices_sorted = MEM_malloc_arrayN((size_t)positions_num, sizeof(*indices), __func__);
+  for (int i = 0; i < positions_num; i++) {
+    indices[i] = i;
+  }
+  for (uint shift = 0; shift < 30; shift += 10) {
+    int offsets[1024] = {0};
+    for (int i = 0; i < positions_num; i++) {
+      offsets[(data.codes[indices[i]] >> shift) & 1023u]++;
+    }
+    int offset = 0;
+    for (int bucket = 0; bucket < 1024; bucket++) {
+      const int count = offsets[bucket];
+      offsets[bucket] = offset;
+      offset += count;
+    }
+    for (int i = 0; i < positions_num; i++) {
+      const int index = indices[i];
+      indices_sorted[offsets[(data.codes[index] >> shift) & 1023u]++] = index;
+    }
+    SWAP(int *, indices, indices_sorted);
+  }
+
+  MEM_freeN(indices_sorted);
+  MEM_freeN(data.codes);
+  return indices;
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -847,6 +953,375 @@ static void non_recursive_bvh_div_nodes(const BVHTree *tree,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name Binned SAH Build
+ *
+ * Alternative to the implicit tree that splits the leafs where the surface area heuristic (SAH)
+ * estimates the lowest traversal cost, instead of at the median of the largest axis. This gives
+ * faster queries on meshes with an uneven distribution of faces.
+ *
+ * Binary splits are collapsed into branches with up to `tree_type` children, by splitting the
+ * child with the largest surface area again until the branch is full. Sub-trees are built in
+ * parallel. The tree is not implicit, branches are stored in the order they are created, so that
+ * children still have a greater index than their parent.
+ *
+ * The heuristic uses the bounds on the X, Y and Z axes, other axes of the k-DOP are ignored.
+ * \{ */
+
+/** A range of leafs in #BVHTree.nodes with their bounds, stored like #BVHNode.bv. */
+typedef struct BVHSAHRange {
+  int begin;
+  int end;
+  float bounds[6];
+  float centroid_bounds[6];
+} BVHSAHRange;
+
+typedef struct BVHSAHBin {
+  float bounds[6];
+  float centroid_bounds[6];
+  int leafs_num;
+} BVHSAHBin;
+
+typedef struct BVHSAHBuildData {
+  BVHTree *tree;
+  /** Number of branches used so far, incremented atomically. */
+  int branch_num;
+} BVHSAHBuildData;
+
+typedef struct BVHSAHTaskData {
+  BVHNode *node;
+  BVHSAHRange range;
+} BVHSAHTaskData;
+
+static void sah_bounds_init(float bounds[6])
+{
+  for (int axis = 0; axis < 3; axis++) {
+    bounds[2 * axis] = FLT_MAX;
+    bounds[2 * axis + 1] = -FLT_MAX;
+  }
+}
+
+static void sah_bounds_join(float bounds[6], const float other[6])
+{
+  for (int axis = 0; axis < 3; axis++) {
+    bounds[2 * axis] = min_ff(bounds[2 * axis], other[2 * axis]);
+    bounds[2 * axis + 1] = max_ff(bounds[2 * axis + 1], other[2 * axis + 1]);
+  }
+}
+
+static void sah_bounds_add_point(float bounds[6], const float co[3])
+{
+  for (int axis = 0; axis < 3; axis++) {
+    bounds[2 * axis] = min_ff(bounds[2 * axis], co[axis]);
+    bounds[2 * axis + 1] = max_ff(bounds[2 * axis + 1], co[axis]);
+  }
+}
+
+/* Half of the surface area is enough to compare costs. */
+static float sah_bounds_half_area(const float bounds[6])
+{
+  const float x = max_ff(bounds[1] - bounds[0], 0.0f);
+  const float y = max_ff(bounds[3] - bounds[2], 0.0f);
+  const float z = max_ff(bounds[5] - bounds[4], 0.0f);
+  return x * y + y * z + z * x;
+}
+
+static float sah_bounds_center(const float bounds[6], const int axis)
+{
+  return (bounds[2 * axis] + bounds[2 * axis + 1]) * 0.5f;
+}
+
+static void sah_leaf_centroid(const BVHNode *leaf, float r_co[3])
+{
+  for (int axis = 0; axis < 3; axis++) {
+    r_co[axis] = sah_bounds_center(leaf->bv, axis);
+  }
+}
+
+static int sah_bin_index(const float co, const float min, const float scale)
+{
+  const int bin = (int)((co - min) * scale);
+  return CLAMPIS(bin, 0, KDOPBVH_SAH_BINS - 1);
+}
+
+static void sah_range_bounds_calc(const BVHTree *tree, BVHSAHRange *range)
+{
+  sah_bounds_init(range->bounds);
+  sah_bounds_init(range->centroid_bounds);
+  for (int i = range->begin; i < range->end; i++) {
+    float co[3];
+    sah_leaf_centroid(tree->nodes[i], co);
+    sah_bounds_join(range->bounds, tree->nodes[i]->bv);
+    sah_bounds_add_point(range->centroid_bounds, co);
+  }
+}
+
+/**
+ * Split the leafs of the range in two parts with the lowest SAH cost, reordering them in
+ * #BVHTree.nodes. Both parts are guaranteed to be non-empty when the range has two leafs or more.
+ *
+ * \return The axis the leafs are split on, or -1 when they could not be split by position.
+ */
+static int sah_range_split(const BVHTree *tree,
+                            const BVHSAHRange *range,
+                            BVHSAHRange *r_left,
+                            BVHSAHRange *r_right)
+{
+  BVHNode **leafs = tree->nodes;
+  BVHSAHBin bins[3][KDOPBVH_SAH_BINS];
+  float scale[3];
+
+  for (int axis = 0; axis < 3; axis++) {
+    const float extent = range->centroid_bounds[2 * axis + 1] - range->centroid_bounds[2 * axis];
+    scale[axis] = (extent > 0.0f) ? (float)KDOPBVH_SAH_BINS / extent : 0.0f;
+    for (int b = 0; b < KDOPBVH_SAH_BINS; b++) {
+      sah_bounds_init(bins[axis][b].bounds);
+      sah_bounds_init(bins[axis][b].centroid_bounds);
+      bins[axis][b].leafs_num = 0;
+    }
+  }
+
+  for (int i = range->begin; i < range->end; i++) {
+    float co[3];
+    sah_leaf_centroid(leafs[i], co);
+    for (int axis = 0; axis < 3; axis++) {
+      if (scale[axis] == 0.0f) {
+        continue;
+      }
+      BVHSAHBin *bin = &bins[axis][sah_bin_index(
+          co[axis], range->centroid_bounds[2 * axis], scale[axis])];
+      sah_bounds_join(bin->bounds, leafs[i]->bv);
+      sah_bounds_add_point(bin->centroid_bounds, co);
+      bin->leafs_num++;
+    }
+  }
+
+  /* Find the split with the lowest cost, the split after bin `b` puts bins `0..b` on the left. */
+  int best_axis = -1;
+  int best_bin = 0;
+  float best_cost = FLT_MAX;
+  for (int axis = 0; axis < 3; axis++) {
+    if (scale[axis] == 0.0f) {
+      continue;
+    }
+    float right_costs[KDOPBVH_SAH_BINS];
+    float bounds[6];
+    int leafs_num = 0;
+    sah_bounds_init(bounds);
+    for (int b = KDOPBVH_SAH_BINS - 1; b > 0; b--) {
+      sah_bounds_join(bounds, bins[axis][b].bounds);
+      leafs_num += bins[axis][b].leafs_num;
+      right_costs[b - 1] = sah_bounds_half_area(bounds) * (float)leafs_num;
+    }
+    leafs_num = 0;
+    sah_bounds_init(bounds);
+    for (int b = 0; b < KDOPBVH_SAH_BINS - 1; b++) {
+      sah_bounds_join(bounds, bins[axis][b].bounds);
+      leafs_num += bins[axis][b].leafs_num;
+      if (leafs_num == 0 || leafs_num == range->end - range->begin) {
+        continue;
+      }
+      const float cost = sah_bounds_half_area(bounds) * (float)leafs_num + right_costs[b];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_axis = axis;
+        best_bin = b;
+      }
+    }
+  }
+
+  r_left->begin = range->begin;
+  r_right->end = range->end;
+
+  if (best_axis == -1) {
+    /* All centroids are at the same position, split in the middle. */
+    r_left->end = r_right->begin = range->begin + (range->end - range->begin) / 2;
+    sah_range_bounds_calc(tree, r_left);
+    sah_range_bounds_calc(tree, r_right);
+    return -1;
+  }
+
+  const float min = range->centroid_bounds[2 * best_axis];
+  int i = range->begin;
+  int j = range->end;
+  while (i < j) {
+    float co[3];
+    sah_leaf_centroid(leafs[i], co);
+    if (sah_bin_index(co[best_axis], min, scale[best_axis]) <= best_bin) {
+      i++;
+    }
+    else {
+      j--;
+      SWAP(BVHNode *, leafs[i], leafs[j]);
+    }
+  }
+  r_left->end = r_right->begin = i;
+
+  sah_bounds_init(r_left->bounds);
+  sah_bounds_init(r_left->centroid_bounds);
+  sah_bounds_init(r_right->bounds);
+  sah_bounds_init(r_right->centroid_bounds);
+  for (int b = 0; b < KDOPBVH_SAH_BINS; b++) {
+    BVHSAHRange *side = (b <= best_bin) ? r_left : r_right;
+    sah_bounds_join(side->bounds, bins[best_axis][b].bounds);
+    sah_bounds_join(side->centroid_bounds, bins[best_axis][b].centroid_bounds);
+  }
+  return best_axis;
+}
+
+static BVHNode *sah_branch_new(BVHSAHBuildData *data)
+{
+  const int index = atomic_fetch_and_add_int32(&data->branch_num, 1);
+  return &data->tree->nodearray[data->tree->leaf_num + index];
+}
+
+static void sah_build_task_cb(TaskPool *__restrict pool, void *taskdata);
+
+static void sah_build_branch(TaskPool *pool,
+                             BVHSAHBuildData *data,
+                             BVHNode *node,
+                             const BVHSAHRange *range)
+{
+  const BVHTree *tree = data->tree;
+  BVHSAHRange *children = BLI_array_alloca(children, (size_t)tree->tree_type);
+  int children_num = 1;
+  children[0] = *range;
+
+  /* The bounds of the range are stored like the first axes of the node bounds. */
+  node->main_axis = get_largest_axis(range->bounds) / 2;
+
+  while (children_num < tree->tree_type) {
+    /* Split the child that is most likely to be traversed. */
+    int split_index = -1;
+    float split_area = -1.0f;
+    for (int k = 0; k < children_num; k++) {
+      const float area = sah_bounds_half_area(children[k].bounds);
+      if (children[k].end - children[k].begin > 1 && area > split_area) {
+        split_index = k;
+        split_area = area;
+      }
+    }
+    if (split_index == -1) {
+      break;
+    }
+    BVHSAHRange left, right;
+    const int split_axis = sah_range_split(tree, &children[split_index], &left, &right);
+    if (children_num == 1 && split_axis != -1) {
+      /* The first split separates the children best, use it to order them. */
+      node->main_axis = (char)split_axis;
+    }
+    children[split_index] = left;
+    children[children_num++] = right;
+  }
+
+  /* Order the children along the main axis, ray-casts use it to visit the closest child first. */
+  const int main_axis = node->main_axis;
+  for (int k = 1; k < children_num; k++) {
+    const BVHSAHRange child = children[k];
+    const float center = sah_bounds_center(child.bounds, main_axis);
+    int j = k;
+    while (j > 0 && center < sah_bounds_center(children[j - 1].bounds, main_axis)) {
+      children[j] = children[j - 1];
+      j--;
+    }
+    children[j] = child;
+  }
+
+  for (int k = 0; k < children_num; k++) {
+    const BVHSAHRange *child = &children[k];
+    const int leafs_num = child->end - child->begin;
+    if (leafs_num == 1) {
+      node->children[k] = tree->nodes[child->begin];
+      node->children[k]->parent = node;
+      continue;
+    }
+
+    BVHNode *branch = sah_branch_new(data);
+    node->children[k] = branch;
+    branch->parent = node;
+
+    if (leafs_num > KDOPBVH_THREAD_LEAF_THRESHOLD) {
+      BVHSAHTaskData *task_data = MEM_mallocN(sizeof(*task_data), __func__);
+      task_data->node = branch;
+      task_data->range = *child;
+      BLI_task_pool_push(pool, sah_build_task_cb, task_data, true, NULL);
+    }
+    else {
+      sah_build_branch(pool, data, branch, child);
+    }
+  }
+  node->node_num = (char)children_num;
+}
+
+static void sah_build_task_cb(TaskPool *__restrict pool, void *taskdata)
+{
+  BVHSAHTaskData *task_data = taskdata;
+  sah_build_branch(pool, BLI_task_pool_user_data(pool), task_data->node, &task_data->range);
+}
+
+/**
+ * Make sure the pre-allocated arrays have room for the given number of branches,
+ * the implicit tree needs less branches than a tree built with the SAH.
+ */
+static void bvhtree_ensure_branches_num(BVHTree *tree, const int branches_num)
+{
+  const int nodes_num_old = (int)(MEM_allocN_len(tree->nodearray) / sizeof(*tree->nodearray));
+  const int nodes_num = tree->leaf_num + branches_num;
+  if (nodes_num <= nodes_num_old) {
+    return;
+  }
+
+  tree->nodes = MEM_recallocN(tree->nodes, sizeof(*tree->nodes) * (size_t)nodes_num);
+  tree->nodebv = MEM_recallocN(tree->nodebv, sizeof(float) * (size_t)(tree->axis * nodes_num));
+  tree->nodechild = MEM_recallocN(tree->nodechild,
+                                  sizeof(BVHNode *) * (size_t)(tree->tree_type * nodes_num));
+  tree->nodearray = MEM_recallocN(tree->nodearray, sizeof(BVHNode) * (size_t)nodes_num);
+
+  /* Link the dynamic bv and child links again, the leafs are not reordered yet. */
+  for (int i = 0; i < nodes_num; i++) {
+    tree->nodearray[i].bv = &tree->nodebv[i * tree->axis];
+    tree->nodearray[i].children = &tree->nodechild[i * tree->tree_type];
+  }
+  for (int i = 0; i < tree->leaf_num; i++) {
+    tree->nodes[i] = &tree->nodearray[i];
+  }
+}
+
+static void sah_bvh_build(BVHTree *tree)
+{
+  /* Every branch has at least two children. */
+  bvhtree_ensure_branches_num(tree, tree->leaf_num - 1);
+
+  BVHSAHBuildData data = {
+      .tree = tree,
+      .branch_num = 0,
+  };
+
+  BVHSAHRange range = {
+      .begin = 0,
+      .end = tree->leaf_num,
+  };
+  sah_range_bounds_calc(tree, &range);
+
+  BVHNode *root = sah_branch_new(&data);
+  root->parent = NULL;
+
+  TaskPool *pool = BLI_task_pool_create(&data, TASK_PRIORITY_HIGH);
+  sah_build_branch(pool, &data, root, &range);
+  BLI_task_pool_work_and_wait(pool);
+  BLI_task_pool_free(pool);
+
+  tree->branch_num = data.branch_num;
+
+  /* Children are created after their parent, so joining the bounds in reverse order visits all
+   * children first. This is cheaper than computing the bounds from the leafs of every branch. */
+  for (int i = tree->branch_num - 1; i >= 0; i--) {
+    node_join(tree, &tree->nodearray[tree->leaf_num + i]);
+  }
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name BLI_bvhtree API
  * \{ */
@@ -934,7 +1409,7 @@ void BLI_bvhtree_free(BVHTree *tree)
   }
 }
 
-void BLI_bvhtree_balance(BVHTree *tree)
+void BLI_bvhtree_balance_ex(BVHTree *tree, const int flag)
 {
   BVHNode **leafs_array = tree->nodes;
 
@@ -942,13 +1417,19 @@ void BLI_bvhtree_balance(BVHTree *tree)
    * (some big bug goes here if its being called more than once per tree) */
   BLI_assert(tree->branch_num == 0);
 
-  /* Build the implicit tree */
-  non_recursive_bvh_div_nodes(
-      tree, tree->nodearray + (tree->leaf_num - 1), leafs_array, tree->leaf_num);
+  /* The SAH needs the X, Y and Z axes, which are not part of 18-DOP's. */
+  if ((flag & BVH_BALANCE_SAH) && (tree->leaf_num > 1) && (tree->start_axis == 0)) {
+    sah_bvh_build(tree);
+  }
+  else {
+    /* Build the implicit tree */
+    non_recursive_bvh_div_nodes(
+        tree, tree->nodearray + (tree->leaf_num - 1), leafs_array, tree->leaf_num);
+    tree->branch_num = implicit_needed_branches(tree->tree_type, tree->leaf_num);
+  }
 
   /* current code expects the branches to be linked to the nodes array
    * we perform that linkage here */
-  tree->branch_num = implicit_needed_branches(tree->tree_type, tree->leaf_num);
   for (int i = 0; i < tree->branch_num; i++) {
     tree->nodes[tree->leaf_num + i] = &tree->nodearray[tree->leaf_num + i];
   }
@@ -966,6 +1447,11 @@ void BLI_bvhtree_balance(BVHTree *tree)
 #endif
 }
 
+void BLI_bvhtree_balance(BVHTree *tree)
+{
+  BLI_bvhtree_balance_ex(tree, 0);
+}
+
 static void bvhtree_node_inflate(const BVHTree *tree, BVHNode *node, const float dist)
 {
   axis_t axis_iter;
@@ -1622,6 +2108,174 @@ int BLI_bvhtree_find_nearest(BVHTree *tree,
   return BLI_bvhtree_find_nearest_ex(tree, co, nearest, callback, userdata, 0);
 }
 
+/**
+ * Queries that search the tree together. The positions are copied into arrays per axis,
+ * so that the distances to a node are computed for all queries with the same instructions.
+ */
+typedef struct BVHNearestPacket {
+  float co[3][KDOPBVH_PACKET_SIZE];
+  float dist_sq[KDOPBVH_PACKET_SIZE];
+  BVHNearestData data[KDOPBVH_PACKET_SIZE];
+} BVHNearestPacket;
+
+typedef struct BVHNearestBatchData {
+  BVHTree *tree;
+  const float (*positions)[3];
+  int positions_num;
+  const int *order;
+  BVHTreeNearest *nearests;
+  BVHTree_NearestPointCallback callback;
+  void *userdata;
+  int flag;
+} BVHNearestBatchData;
+
+static int nearest_packet_test_node(const BVHNearestPacket *packet,
+                                    const BVHNode *node,
+                                    const bool active[KDOPBVH_PACKET_SIZE],
+                                    bool r_active[KDOPBVH_PACKET_SIZE])
+{
+  const float *bv = node->bv;
+  int active_num = 0;
+  for (int i = 0; i < KDOPBVH_PACKET_SIZE; i++) {
+    float dist_sq = 0.0f;
+    for (int axis = 0; axis < 3; axis++) {
+      const float co = packet->co[axis][i];
+      const float delta = co - min_ff(max_ff(co, bv[2 * axis]), bv[2 * axis + 1]);
+      dist_sq += delta * delta;
+    }
+    r_active[i] = active[i] && dist_sq < packet->dist_sq[i];
+    active_num += (int)r_active[i];
+  }
+  return active_num;
+}
+
+/* Same as #dfs_find_nearest_dfs, but for all queries in the packet at once. */
+static void dfs_find_nearest_packet(BVHNearestPacket *packet,
+                                    BVHNode *node,
+                                    const bool active[KDOPBVH_PACKET_SIZE])
+{
+  bool node_active[KDOPBVH_PACKET_SIZE];
+  const int active_num = nearest_packet_test_node(packet, node, active, node_active);
+  if (active_num == 0) {
+    return;
+  }
+
+  int first_active = 0;
+  while (!node_active[first_active]) {
+    first_active++;
+  }
+
+  if (node->node_num == 0 || active_num == 1) {
+    for (int i = first_active; i < KDOPBVH_PACKET_SIZE; i++) {
+      if (node_active[i]) {
+        dfs_find_nearest_dfs(&packet->data[i], node);
+        packet->dist_sq[i] = packet->data[i].nearest.dist_sq;
+      }
+    }
+    return;
+  }
+
+  /* Queries in a packet are close to each other, use the first to pick the loop direction. */
+  const BVHNearestData *data = &packet->data[first_active];
+  if (data->proj[node->main_axis] <= node->children[0]->bv[node->main_axis * 2 + 1]) {
+    for (int i = 0; i != node->node_num; i++) {
+      dfs_find_nearest_packet(packet, node->children[i], node_active);
+    }
+  }
+  else {
+    for (int i = node->node_num - 1; i >= 0; i--) {
+      dfs_find_nearest_packet(packet, node->children[i], node_active);
+    }
+  }
+}
+
+static void find_nearest_batch_cb(void *__restrict userdata,
+                                  const int packet_index,
+                                  const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHNearestBatchData *batch = userdata;
+  BVHNode *root = batch->tree->nodes[batch->tree->leaf_num];
+  const int begin = packet_index * KDOPBVH_PACKET_SIZE;
+  const int size = min_ii(KDOPBVH_PACKET_SIZE, batch->positions_num - begin);
+
+  BVHNearestPacket packet;
+  bool active[KDOPBVH_PACKET_SIZE];
+  for (int i = 0; i < KDOPBVH_PACKET_SIZE; i++) {
+    active[i] = i < size;
+    if (!active[i]) {
+      for (int axis = 0; axis < 3; axis++) {
+        packet.co[axis][i] = 0.0f;
+      }
+      packet.dist_sq[i] = 0.0f;
+      continue;
+    }
+
+    BVHNearestData *data = &packet.data[i];
+    const int index = batch->order[begin + i];
+    data->tree = batch->tree;
+    data->co = batch->positions[index];
+    data->callback = batch->callback;
+    data->userdata = batch->userdata;
+    for (axis_t axis_iter = data->tree->start_axis; axis_iter != data->tree->stop_axis;
+         axis_iter++) {
+      data->proj[axis_iter] = dot_v3v3(data->co, bvhtree_kdop_axes[axis_iter]);
+    }
+    memcpy(&data->nearest, &batch->nearests[index], sizeof(data->nearest));
+
+    for (int axis = 0; axis < 3; axis++) {
+      packet.co[axis][i] = data->co[axis];
+    }
+    packet.dist_sq[i] = data->nearest.dist_sq;
+  }
+
+  if (batch->flag & BVH_NEAREST_OPTIMAL_ORDER) {
+    for (int i = 0; i < size; i++) {
+      heap_find_nearest_begin(&packet.data[i], root);
+    }
+  }
+  else {
+    dfs_find_nearest_packet(&packet, root, active);
+  }
+
+  for (int i = 0; i < size; i++) {
+    memcpy(&batch->nearests[batch->order[begin + i]],
+           &packet.data[i].nearest,
+           sizeof(packet.data[i].nearest));
+  }
+}
+
+void BLI_bvhtree_find_nearest_batch(BVHTree *tree,
+                                    const float (*positions)[3],
+                                    const int positions_num,
+                                    BVHTreeNearest *nearests,
+                                    BVHTree_NearestPointCallback callback,
+                                    void *userdata,
+                                    const int flag)
+{
+  if (positions_num == 0 || tree->nodes[tree->leaf_num] == NULL) {
+    return;
+  }
+
+  BVHNearestBatchData batch = {
+      .tree = tree,
+      .positions = positions,
+      .positions_num = positions_num,
+      .order = query_order_morton(positions, positions_num),
+      .nearests = nearests,
+      .callback = callback,
+      .userdata = userdata,
+      .flag = flag,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (positions_num > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  const int packets_num = (positions_num + KDOPBVH_PACKET_SIZE - 1) / KDOPBVH_PACKET_SIZE;
+  BLI_task_parallel_range(0, packets_num, &batch, find_nearest_batch_cb, &settings);
+
+  MEM_freeN((void *)batch.order);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -1951,6 +2605,218 @@ int BLI_bvhtree_ray_cast(BVHTree *tree,
       tree, co, dir, radius, hit, callback, userdata, BVH_RAYCAST_DEFAULT);
 }
 
+/**
+ * Rays that traverse the tree together. The origins and inverse directions are copied into arrays
+ * per axis, so that the intersections with a node are computed for all rays with the same
+ * instructions.
+ */
+typedef struct BVHRayPacket {
+  float origin[3][KDOPBVH_PACKET_SIZE];
+  float idot_axis[3][KDOPBVH_PACKET_SIZE];
+  float dist[KDOPBVH_PACKET_SIZE];
+  BVHRayCastData data[KDOPBVH_PACKET_SIZE];
+} BVHRayPacket;
+
+typedef struct BVHRayCastBatchData {
+  BVHTree *tree;
+  const float (*origins)[3];
+  const float (*directions)[3];
+  int rays_num;
+  float radius;
+  const int *order;
+  BVHTreeRayHit *hits;
+  BVHTree_RayCastCallback callback;
+  void *userdata;
+  int flag;
+} BVHRayCastBatchData;
+
+/* Same test as #fast_ray_nearest_hit, written without branches. */
+static int ray_packet_test_node(const BVHRayPacket *packet,
+                                const BVHNode *node,
+                                const bool active[KDOPBVH_PACKET_SIZE],
+                                bool r_active[KDOPBVH_PACKET_SIZE],
+                                float r_dist[KDOPBVH_PACKET_SIZE])
+{
+  const float *bv = node->bv;
+  int active_num = 0;
+  if (packet->data[0].ray.radius == 0.0f) {
+    for (int i = 0; i < KDOPBVH_PACKET_SIZE; i++) {
+      float t_near = -FLT_MAX;
+      float t_far = FLT_MAX;
+      for (int axis = 0; axis < 3; axis++) {
+        const float t1 = (bv[2 * axis] - packet->origin[axis][i]) * packet->idot_axis[axis][i];
+        const float t2 = (bv[2 * axis + 1] - packet->origin[axis][i]) *
+                         packet->idot_axis[axis][i];
+        t_near = max_ff(t_near, min_ff(t1, t2));
+        t_far = min_ff(t_far, max_ff(t1, t2));
+      }
+      r_dist[i] = t_near;
+      r_active[i] = active[i] && t_near <= t_far && t_far >= 0.0f && t_near < packet->dist[i];
+      active_num += (int)r_active[i];
+    }
+  }
+  else {
+    for (int i = 0; i < KDOPBVH_PACKET_SIZE; i++) {
+      r_dist[i] = active[i] ? ray_nearest_hit(&packet->data[i], bv) : FLT_MAX;
+      r_active[i] = active[i] && r_dist[i] < packet->dist[i];
+      active_num += (int)r_active[i];
+    }
+  }
+  return active_num;
+}
+
+/* Same as #dfs_raycast, but for all rays in the packet at once. */
+static void dfs_raycast_packet(BVHRayPacket *packet,
+                               BVHNode *node,
+                               const bool active[KDOPBVH_PACKET_SIZE])
+{
+  bool node_active[KDOPBVH_PACKET_SIZE];
+  float dist[KDOPBVH_PACKET_SIZE];
+  const int active_num = ray_packet_test_node(packet, node, active, node_active, dist);
+  if (active_num == 0) {
+    return;
+  }
+
+  int first_active = 0;
+  while (!node_active[first_active]) {
+    first_active++;
+  }
+
+  if (node->node_num == 0) {
+    for (int i = first_active; i < KDOPBVH_PACKET_SIZE; i++) {
+      if (!node_active[i]) {
+        continue;
+      }
+      BVHRayCastData *data = &packet->data[i];
+      if (data->callback) {
+        data->callback(data->userdata, node->index, &data->ray, &data->hit);
+      }
+      else {
+        data->hit.index = node->index;
+        data->hit.dist = dist[i];
+        madd_v3_v3v3fl(data->hit.co, data->ray.origin, data->ray.direction, dist[i]);
+      }
+      packet->dist[i] = data->hit.dist;
+    }
+    return;
+  }
+
+  if (active_num == 1) {
+    /* Continue with the single ray traversal, the packet doesn't help anymore. */
+    BVHRayCastData *data = &packet->data[first_active];
+    if (data->ray_dot_axis[node->main_axis] > 0.0f) {
+      for (int i = 0; i != node->node_num; i++) {
+        dfs_raycast(data, node->children[i]);
+      }
+    }
+    else {
+      for (int i = node->node_num - 1; i >= 0; i--) {
+        dfs_raycast(data, node->children[i]);
+      }
+    }
+    packet->dist[first_active] = data->hit.dist;
+    return;
+  }
+
+  /* Rays in a packet start close to each other, use the first to pick the loop direction. */
+  if (packet->data[first_active].ray_dot_axis[node->main_axis] > 0.0f) {
+    for (int i = 0; i != node->node_num; i++) {
+      dfs_raycast_packet(packet, node->children[i], node_active);
+    }
+  }
+  else {
+    for (int i = node->node_num - 1; i >= 0; i--) {
+      dfs_raycast_packet(packet, node->children[i], node_active);
+    }
+  }
+}
+
+static void ray_cast_batch_cb(void *__restrict userdata,
+                              const int packet_index,
+                              const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  const BVHRayCastBatchData *batch = userdata;
+  BVHNode *root = batch->tree->nodes[batch->tree->leaf_num];
+  const int begin = packet_index * KDOPBVH_PACKET_SIZE;
+  const int size = min_ii(KDOPBVH_PACKET_SIZE, batch->rays_num - begin);
+
+  BVHRayPacket packet;
+  bool active[KDOPBVH_PACKET_SIZE];
+  for (int i = 0; i < KDOPBVH_PACKET_SIZE; i++) {
+    active[i] = i < size;
+    if (!active[i]) {
+      for (int axis = 0; axis < 3; axis++) {
+        packet.origin[axis][i] = 0.0f;
+        packet.idot_axis[axis][i] = 0.0f;
+      }
+      packet.dist[i] = 0.0f;
+      /* Unused rays still decide which node test is used. */
+      packet.data[i].ray.radius = batch->radius;
+      continue;
+    }
+
+    BVHRayCastData *data = &packet.data[i];
+    const int index = batch->order[begin + i];
+    BLI_ASSERT_UNIT_V3(batch->directions[index]);
+    data->tree = batch->tree;
+    data->callback = batch->callback;
+    data->userdata = batch->userdata;
+    copy_v3_v3(data->ray.origin, batch->origins[index]);
+    copy_v3_v3(data->ray.direction, batch->directions[index]);
+    data->ray.radius = batch->radius;
+    bvhtree_ray_cast_data_precalc(data, batch->flag);
+    memcpy(&data->hit, &batch->hits[index], sizeof(data->hit));
+
+    for (int axis = 0; axis < 3; axis++) {
+      packet.origin[axis][i] = data->ray.origin[axis];
+      packet.idot_axis[axis][i] = data->idot_axis[axis];
+    }
+    packet.dist[i] = data->hit.dist;
+  }
+
+  dfs_raycast_packet(&packet, root, active);
+
+  for (int i = 0; i < size; i++) {
+    memcpy(&batch->hits[batch->order[begin + i]], &packet.data[i].hit, sizeof(packet.data[i].hit));
+  }
+}
+
+void BLI_bvhtree_ray_cast_batch(BVHTree *tree,
+                                const float (*origins)[3],
+                                const float (*directions)[3],
+                                const int rays_num,
+                                const float radius,
+                                BVHTreeRayHit *hits,
+                                BVHTree_RayCastCallback callback,
+                                void *userdata,
+                                const int flag)
+{
+  if (rays_num == 0 || tree->nodes[tree->leaf_num] == NULL) {
+    return;
+  }
+
+  BVHRayCastBatchData batch = {
+      .tree = tree,
+      .origins = origins,
+      .directions = directions,
+      .rays_num = rays_num,
+      .radius = radius,
+      .order = query_order_morton(origins, rays_num),
+      .hits = hits,
+      .callback = callback,
+      .userdata = userdata,
+      .flag = flag,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = (rays_num > KDOPBVH_THREAD_LEAF_THRESHOLD);
+  const int packets_num = (rays_num + KDOPBVH_PACKET_SIZE - 1) / KDOPBVH_PACKET_SIZE;
+  BLI_task_parallel_range(0, packets_num, &batch, ray_cast_batch_cb, &settings);
+
+  MEM_freeN((void *)batch.order);
+}
+
 float BLI_bvhtree_bb_raycast(const float bv[6],
                              const float light_start[3],
                              const float light_end[3],
@@ -32,6 +32,9 @@ struct BLI_mmap_file {
   /* Platform-specific handle for the mapping. */
   void *handle;
 
+  /* Size of a memory page, used to align ranges passed to #BLI_mmap_release. */
+  size_t page_size;
+
   /* Flag to indicate IO errors. Needs to be volatile since it's being set from
    * within the signal handler, which is not part of the normal execution flow. */
   volatile bool io_error;
@@ -166,6 +169,9 @@ BLI_mmap_file *BLI_mmap_open(int fd)
   file->memory = memory;
   file->handle = handle;
   file->length = length;
+#ifndef WIN32
+  file->page_size = (size_t)sysconf(_SC_PAGESIZE);
+#endif
 
 #ifndef WIN32
   /* Register the file with the error handler. */
@@ -207,6 +213,29 @@ void *BLI_mmap_get_pointer(BLI_mmap_file *file)
   return file->memory;
 }
 
+void BLI_mmap_release(BLI_mmap_file *file, size_t offset, size_t length)
+{
+#ifndef WIN32
+  if (file->io_error || file->page_size == 0 || offset + length > file->length) {
+    return;
+  }
+
+  /* Only release pages that are entirely contained in the range,
+   * neighboring data might still be needed. */
+  const size_t page_mask = file->page_size - 1;
+  const size_t start = (offset + page_mask) & ~page_mask;
+  const size_t end = (offset + length) & ~page_mask;
+  if (start >= end) {
+    return;
+  }
+
+  /* The mapping is private and read-only, so dropping the pages never loses data. */
+  madvise(file->memory + start, end - start, MADV_DONTNEED);
+#else
+  UNUSED_VARS(file, offset, length);
+#endif
+}
+
 void BLI_mmap_free(BLI_mmap_file *file)
 {
 #ifndef WIN32
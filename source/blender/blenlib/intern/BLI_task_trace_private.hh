@@ -0,0 +1,46 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup bli
+ *
+ * Recording of task execution for #BLI_task_trace_begin,
+ * shared by the task pool, parallel range and task graph implementations.
+ */
+
+#include <atomic>
+#include <cstdint>
+
+extern std::atomic<bool> g_task_trace_is_enabled;
+
+/**
+ * Cheap test to be done before collecting any data for an event.
+ */
+inline bool task_trace_is_enabled()
+{
+  return g_task_trace_is_enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * Time-stamp in nanoseconds, on the same clock for all threads.
+ */
+uint64_t task_trace_time_now();
+
+/**
+ * Record a finished event on the current thread's ring buffer.
+ *
+ * \param name, category: Must be static strings (or outlive the trace).
+ * \param time_queued: When the work was made available to the scheduler,
+ * the difference with \a time_begin is written as the time spent queued.
+ */
+void task_trace_event_add(const char *name,
+                          const char *category,
+                          uint64_t time_queued,
+                          uint64_t time_begin,
+                          uint64_t time_end);
+
+/**
+ * Free all thread buffers, called from #BLI_task_scheduler_exit.
+ */
+void task_trace_exit();
@@ -86,6 +86,13 @@ FileReader *BLI_filereader_new_memory(const void *data, size_t len)
  * This avoids system call overhead and can significantly speed up file loading.
  */
 
+/**
+ * Reads of at least this size release the pages they were copied from afterwards.
+ * Large blocks (mesh and custom-data arrays) are only read once, keeping their pages
+ * resident would roughly double the peak memory usage while loading.
+ */
+#define MMAP_RELEASE_READ_SIZE_MIN (1 << 20)
+
 static ssize_t memory_read_mmap(FileReader *reader, void *buffer, size_t size)
 {
   MemoryReader *mem = (MemoryReader *)reader;
@@ -97,6 +104,10 @@ static ssize_t memory_read_mmap(FileReader *reader, void *buffer, size_t size)
     return 0;
   }
 
+  if (readsize >= MMAP_RELEASE_READ_SIZE_MIN) {
+    BLI_mmap_release(mem->mmap, mem->reader.offset, readsize);
+  }
+
   mem->reader.offset += readsize;
 
   return readsize;
@@ -12,9 +12,12 @@
 #include "BLI_endian_switch.h"
 #include "BLI_filereader.h"
 #include "BLI_math_base.h"
+#include "BLI_task.h"
 
 #include "MEM_guardedalloc.h"
 
+#include "atomic_ops.h"
+
 typedef struct {
   FileReader reader;
 
@@ -32,6 +35,10 @@ typedef struct {
     char *cached_content;
     int cached_frame;
   } seek;
+
+  /** Entire uncompressed stream, only set when all frames were decompressed up-front
+   * by #zstd_decompress_all_frames. */
+  char *decompressed_content;
 } ZstdReader;
 
 static bool zstd_read_u32(FileReader *base, uint32_t *val)
@@ -221,6 +228,108 @@ static ssize_t zstd_read_seekable(FileReader *reader, void *buffer, size_t size)
   return read_len;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Parallel Frame Decompression
+ *
+ * When the seek table is available, every frame can be decompressed independently,
+ * so the whole stream is decompressed up-front on all available threads.
+ * \{ */
+
+typedef struct ZstdDecompressAllData {
+  ZstdReader *zstd;
+  const char *compressed_data;
+  char *uncompressed_data;
+  /** Set to non-zero by any task that failed to decompress its frame. */
+  uint32_t error;
+} ZstdDecompressAllData;
+
+static void zstd_decompress_frame_task(void *__restrict userdata,
+                                       const int frame,
+                                       const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  ZstdDecompressAllData *data = userdata;
+  ZstdReader *zstd = data->zstd;
+
+  const size_t compressed_ofs = zstd->seek.compressed_ofs[frame];
+  const size_t compressed_size = zstd->seek.compressed_ofs[frame + 1] - compressed_ofs;
+  const size_t uncompressed_ofs = zstd->seek.uncompressed_ofs[frame];
+  const size_t uncompressed_size = zstd->seek.uncompressed_ofs[frame + 1] - uncompressed_ofs;
+
+  /* #ZSTD_decompress uses its own context, so it is safe to call from multiple threads. */
+  size_t res = ZSTD_decompress(data->uncompressed_data + uncompressed_ofs,
+                               uncompressed_size,
+                               data->compressed_data + compressed_ofs,
+                               compressed_size);
+  if (ZSTD_isError(res) || res < uncompressed_size) {
+    atomic_fetch_and_or_uint32(&data->error, 1);
+  }
+}
+
+/**
+ * Read all compressed frames sequentially (the base reader is not thread-safe),
+ * then decompress them in parallel into a single buffer.
+ *
+ * \return false if anything went wrong, in which case the reader is left untouched
+ * and frames are decompressed on demand instead.
+ */
+static bool zstd_decompress_all_frames(ZstdReader *zstd)
+{
+  const int frames_num = zstd->seek.frames_num;
+  const size_t compressed_size = zstd->seek.compressed_ofs[frames_num];
+  const size_t uncompressed_size = zstd->seek.uncompressed_ofs[frames_num];
+
+  if (frames_num < 2) {
+    /* Nothing to gain from threading, the regular seekable path is just as fast. */
+    return false;
+  }
+
+  char *compressed_data = MEM_mallocN(compressed_size, __func__);
+  if (zstd->base->seek(zstd->base, 0, SEEK_SET) < 0 ||
+      zstd->base->read(zstd->base, compressed_data, compressed_size) < compressed_size) {
+    MEM_freeN(compressed_data);
+    return false;
+  }
+
+  ZstdDecompressAllData data = {
+      .zstd = zstd,
+      .compressed_data = compressed_data,
+      .uncompressed_data = MEM_mallocN(uncompressed_size, __func__),
+      .error = 0,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, frames_num, &data, zstd_decompress_frame_task, &settings);
+
+  MEM_freeN(compressed_data);
+
+  if (data.error) {
+    MEM_freeN(data.uncompressed_data);
+    return false;
+  }
+
+  zstd->decompressed_content = data.uncompressed_data;
+  return true;
+}
+
+static ssize_t zstd_read_decompressed(FileReader *reader, void *buffer, size_t size)
+{
+  ZstdReader *zstd = (ZstdReader *)reader;
+
+  const size_t total_size = zstd->seek.uncompressed_ofs[zstd->seek.frames_num];
+  if (zstd->reader.offset >= total_size) {
+    return 0;
+  }
+  const size_t read_len = min_zz(size, total_size - zstd->reader.offset);
+  memcpy(buffer, zstd->decompressed_content + zstd->reader.offset, read_len);
+  zstd->reader.offset += read_len;
+
+  return read_len;
+}
+
+/** \} */
+
 static off64_t zstd_seek(FileReader *reader, off64_t offset, int whence)
 {
   ZstdReader *zstd = (ZstdReader *)reader;
@@ -281,7 +390,8 @@ static void zstd_close(FileReader *reader)
   if (zstd->reader.seek) {
     MEM_freeN(zstd->seek.uncompressed_ofs);
     MEM_freeN(zstd->seek.compressed_ofs);
-    MEM_freeN(zstd->seek.cached_content);
+    MEM_SAFE_FREE(zstd->seek.cached_content);
+    MEM_SAFE_FREE(zstd->decompressed_content);
   }
   else {
     MEM_freeN((void *)zstd->in_buf.src);
@@ -291,7 +401,7 @@ static void zstd_close(FileReader *reader)
   MEM_freeN(zstd);
 }
 
-FileReader *BLI_filereader_new_zstd(FileReader *base)
+static FileReader *filereader_new_zstd_ex(FileReader *base, const bool use_threads)
 {
   ZstdReader *zstd = MEM_callocN(sizeof(ZstdReader), __func__);
 
@@ -299,7 +409,12 @@ FileReader *BLI_filereader_new_zstd(FileReader *base)
   zstd->base = base;
 
   if (zstd_read_seek_table(zstd)) {
-    zstd->reader.read = zstd_read_seekable;
+    if (use_threads && zstd_decompress_all_frames(zstd)) {
+      zstd->reader.read = zstd_read_decompressed;
+    }
+    else {
+      zstd->reader.read = zstd_read_seekable;
+    }
     zstd->reader.seek = zstd_seek;
   }
   else {
@@ -320,3 +435,13 @@ FileReader *BLI_filereader_new_zstd(FileReader *base)
 
   return (FileReader *)zstd;
 }
+
+FileReader *BLI_filereader_new_zstd(FileReader *base)
+{
+  return filereader_new_zstd_ex(base, false);
+}
+
+FileReader *BLI_filereader_new_zstd_threaded(FileReader *base)
+{
+  return filereader_new_zstd_ex(base, true);
+}
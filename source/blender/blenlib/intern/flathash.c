@@ -0,0 +1,693 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ *
+ * An open-addressing (pointer -> pointer) hash table, see #BLI_flathash.h.
+ *
+ * Entries are stored in a flat array next to an array of control bytes (one per slot):
+ * - `FH_CTRL_EMPTY` the slot has never been used (terminates a probe sequence).
+ * - `FH_CTRL_DELETED` the slot was removed (a tombstone, probing continues past it).
+ * - Otherwise the slot is used and the byte holds 7 bits of the hash.
+ *
+ * Probing is done over groups of #FH_GROUP_WIDTH slots, comparing all control bytes
+ * of a group at once so most lookups only call the compare callback for actual matches.
+ * The first #FH_GROUP_WIDTH control bytes are mirrored after the end of the array,
+ * so a group can always be loaded with a single unaligned read.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math_base.h"
+#include "BLI_math_bits.h"
+#include "BLI_simd.h"
+#include "BLI_utildefines.h"
+
+#include "BLI_flathash.h" /* own include */
+
+/* keep last */
+#include "BLI_strict_flags.h"
+
+/* -------------------------------------------------------------------- */
+/** \name Structs & Constants
+ * \{ */
+
+#define FH_GROUP_WIDTH 16
+#define FH_CAPACITY_MIN FH_GROUP_WIDTH
+
+#define FH_CTRL_EMPTY ((int8_t)-128) /* 0b10000000 */
+#define FH_CTRL_DELETED ((int8_t)-2) /* 0b11111110 */
+
+/** Maximum load factor (7/8), tombstones count as used slots. */
+#define FH_MAX_LOAD_NUM 7
+#define FH_MAX_LOAD_DEN 8
+
+typedef struct FlatHashEntry {
+  void *key, *val;
+} FlatHashEntry;
+
+struct FlatHash {
+  GHashHashFP hashfp;
+  GHashCmpFP cmpfp;
+
+  FlatHashEntry *entries;
+  /** `capacity + FH_GROUP_WIDTH` control bytes. */
+  int8_t *ctrl;
+
+  /** Always a power of two (and at least #FH_CAPACITY_MIN). */
+  uint capacity;
+  uint nentries;
+  /** Number of insertions possible before the table needs to grow or be rehashed. */
+  uint growth_left;
+
+  const char *info;
+};
+
+BLI_STATIC_ASSERT(sizeof(FlatHashEntry) == sizeof(void *[2]), "Must match '_fh_Entry'")
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Group Matching
+ *
+ * Each function returns a bit-mask with one bit set for each matching slot of the group.
+ * \{ */
+
+BLI_INLINE uint fh_group_match(const int8_t *ctrl, const int8_t value)
+{
+#ifdef BLI_HAVE_SSE2
+  const __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+  return (uint)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(value)));
+#else
+  uint mask = 0;
+  for (uint i = 0; i < FH_GROUP_WIDTH; i++) {
+    mask |= (uint)(ctrl[i] == value) << i;
+  }
+  return mask;
+#endif
+}
+
+BLI_INLINE uint fh_group_match_empty(const int8_t *ctrl)
+{
+  return fh_group_match(ctrl, FH_CTRL_EMPTY);
+}
+
+/** Empty or deleted slots, both have their high bit set. */
+BLI_INLINE uint fh_group_match_empty_or_deleted(const int8_t *ctrl)
+{
+#ifdef BLI_HAVE_SSE2
+  const __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+  return (uint)_mm_movemask_epi8(group);
+#else
+  uint mask = 0;
+  for (uint i = 0; i < FH_GROUP_WIDTH; i++) {
+    mask |= (uint)(ctrl[i] < 0) << i;
+  }
+  return mask;
+#endif
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Internal Utility API
+ * \{ */
+
+BLI_INLINE bool fh_ctrl_is_full(const int8_t ctrl)
+{
+  return ctrl >= 0;
+}
+
+/**
+ * Spread the bits of the callbacks hash, since many of the #GHash hash functions
+ * return values with poor entropy in the low bits (aligned pointers for e.g.).
+ */
+BLI_INLINE uint fh_hash_mix(const uint hash)
+{
+  const uint h = hash * 0x9E3779B1u;
+  return h ^ (h >> 16);
+}
+
+BLI_INLINE int8_t fh_hash_h2(const uint hash_mixed)
+{
+  return (int8_t)(hash_mixed >> 25);
+}
+
+BLI_INLINE uint fh_capacity_for_entries(const uint nentries)
+{
+  const uint nslots = nentries + (nentries / (FH_MAX_LOAD_NUM - 1)) + 1;
+  return max_uu(power_of_2_max_u(nslots), FH_CAPACITY_MIN);
+}
+
+BLI_INLINE uint fh_capacity_to_growth(const uint capacity)
+{
+  return (capacity / FH_MAX_LOAD_DEN) * FH_MAX_LOAD_NUM;
+}
+
+BLI_INLINE void fh_ctrl_set(FlatHash *fh, const uint index, const int8_t value)
+{
+  fh->ctrl[index] = value;
+  if (index < FH_GROUP_WIDTH) {
+    fh->ctrl[fh->capacity + index] = value;
+  }
+}
+
+static void fh_buffers_alloc(FlatHash *fh, const uint capacity)
+{
+  BLI_assert(is_power_of_2_i((int)capacity) && capacity >= FH_CAPACITY_MIN);
+  fh->capacity = capacity;
+  fh->entries = MEM_mallocN(sizeof(*fh->entries) * capacity, fh->info);
+  fh->ctrl = MEM_mallocN(sizeof(*fh->ctrl) * (capacity + FH_GROUP_WIDTH), fh->info);
+  memset(fh->ctrl, FH_CTRL_EMPTY, sizeof(*fh->ctrl) * (capacity + FH_GROUP_WIDTH));
+  fh->growth_left = fh_capacity_to_growth(capacity) - fh->nentries;
+}
+
+/**
+ * Find the first slot available for insertion (empty or deleted) for the given hash.
+ */
+BLI_INLINE uint fh_find_insert_slot(const FlatHash *fh, const uint hash_mixed)
+{
+  const uint mask = fh->capacity - 1;
+  uint pos = hash_mixed & mask;
+  uint stride = 0;
+  while (true) {
+    const uint match = fh_group_match_empty_or_deleted(&fh->ctrl[pos]);
+    if (match) {
+      return (pos + bitscan_forward_uint(match)) & mask;
+    }
+    /* Triangular probing visits every group exactly once as the capacity is a power of two. */
+    stride += FH_GROUP_WIDTH;
+    pos = (pos + stride) & mask;
+  }
+}
+
+/**
+ * \return the slot index of \a key or -1 when not found.
+ */
+BLI_INLINE int fh_lookup_index(const FlatHash *fh, const void *key, const uint hash_mixed)
+{
+  const uint mask = fh->capacity - 1;
+  const int8_t h2 = fh_hash_h2(hash_mixed);
+  uint pos = hash_mixed & mask;
+  uint stride = 0;
+  while (true) {
+    const int8_t *group = &fh->ctrl[pos];
+    uint match = fh_group_match(group, h2);
+    while (match) {
+      const uint index = (pos + bitscan_forward_uint(match)) & mask;
+      if (UNLIKELY(!fh->cmpfp(key, fh->entries[index].key))) {
+        return (int)index;
+      }
+      match &= match - 1;
+    }
+    if (LIKELY(fh_group_match_empty(group))) {
+      return -1;
+    }
+    stride += FH_GROUP_WIDTH;
+    if (UNLIKELY(stride > mask)) {
+      /* Only possible when the table holds no empty slots at all. */
+      return -1;
+    }
+    pos = (pos + stride) & mask;
+  }
+}
+
+/**
+ * Re-insert all entries into new buffers of \a capacity, dropping tombstones.
+ */
+static void fh_resize(FlatHash *fh, const uint capacity)
+{
+  FlatHashEntry *entries_old = fh->entries;
+  int8_t *ctrl_old = fh->ctrl;
+  const uint capacity_old = fh->capacity;
+
+  fh_buffers_alloc(fh, capacity);
+
+  for (uint i = 0; i < capacity_old; i++) {
+    if (fh_ctrl_is_full(ctrl_old[i])) {
+      const uint hash_mixed = fh_hash_mix(fh->hashfp(entries_old[i].key));
+      const uint index = fh_find_insert_slot(fh, hash_mixed);
+      fh_ctrl_set(fh, index, fh_hash_h2(hash_mixed));
+      fh->entries[index] = entries_old[i];
+    }
+  }
+
+  MEM_freeN(entries_old);
+  MEM_freeN(ctrl_old);
+}
+
+/**
+ * Make room for one more entry, either growing the table
+ * or (when there are many tombstones) rehashing in-place.
+ */
+static void fh_ensure_growth(FlatHash *fh)
+{
+  if (LIKELY(fh->growth_left != 0)) {
+    return;
+  }
+  /* When less than half the used slots hold entries, the rest are tombstones
+   * and rehashing at the same size is enough. */
+  const bool use_grow = fh->nentries * 2 >= fh_capacity_to_growth(fh->capacity);
+  fh_resize(fh, use_grow ? fh->capacity * 2 : fh->capacity);
+}
+
+/**
+ * Insert into a slot known not to hold \a key.
+ */
+BLI_INLINE FlatHashEntry *fh_insert_new(FlatHash *fh, void *key, const uint hash_mixed)
+{
+  fh_ensure_growth(fh);
+  const uint index = fh_find_insert_slot(fh, hash_mixed);
+  if (fh->ctrl[index] == FH_CTRL_EMPTY) {
+    fh->growth_left--;
+  }
+  fh_ctrl_set(fh, index, fh_hash_h2(hash_mixed));
+  fh->nentries++;
+
+  FlatHashEntry *e = &fh->entries[index];
+  e->key = key;
+  e->val = NULL;
+  return e;
+}
+
+/**
+ * Remove the entry at \a index, it's only marked deleted when it could be part of
+ * a probe sequence that continued past a full group.
+ */
+static void fh_remove_index(FlatHash *fh, const uint index)
+{
+  const uint mask = fh->capacity - 1;
+  const uint index_before = (index - FH_GROUP_WIDTH) & mask;
+  const uint empty_after = fh_group_match_empty(&fh->ctrl[index]);
+  const uint empty_before = fh_group_match_empty(&fh->ctrl[index_before]);
+
+  /* Count the full run of non-empty slots containing `index`,
+   * if it's narrower than a group no probe ever skipped past this slot. */
+  const uint run_after = empty_after ? bitscan_forward_uint(empty_after) : FH_GROUP_WIDTH;
+  /* Leading zeros of the 16 bit mask (#bitscan_reverse_uint counts for 32 bits). */
+  const uint run_before = empty_before ? bitscan_reverse_uint(empty_before) - 16 :
+                                         FH_GROUP_WIDTH;
+  const bool was_never_full = (empty_before && empty_after) &&
+                              (run_before + run_after < FH_GROUP_WIDTH);
+
+  fh_ctrl_set(fh, index, was_never_full ? FH_CTRL_EMPTY : FH_CTRL_DELETED);
+  if (was_never_full) {
+    fh->growth_left++;
+  }
+  fh->nentries--;
+}
+
+static void fh_free_entries(FlatHash *fh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+  BLI_assert(keyfreefp || valfreefp);
+  for (uint i = 0; i < fh->capacity; i++) {
+    if (fh_ctrl_is_full(fh->ctrl[i])) {
+      if (keyfreefp) {
+        keyfreefp(fh->entries[i].key);
+      }
+      if (valfreefp) {
+        valfreefp(fh->entries[i].val);
+      }
+    }
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name FlatHash Public API
+ * \{ */
+
+FlatHash *BLI_flathash_new_ex(GHashHashFP hashfp,
+                              GHashCmpFP cmpfp,
+                              const char *info,
+                              const uint nentries_reserve)
+{
+  FlatHash *fh = MEM_mallocN(sizeof(*fh), info);
+  fh->hashfp = hashfp;
+  fh->cmpfp = cmpfp;
+  fh->info = info;
+  fh->nentries = 0;
+  fh_buffers_alloc(fh, fh_capacity_for_entries(nentries_reserve));
+  return fh;
+}
+
+FlatHash *BLI_flathash_new(GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info)
+{
+  return BLI_flathash_new_ex(hashfp, cmpfp, info, 0);
+}
+
+void BLI_flathash_free(FlatHash *fh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+  if (keyfreefp || valfreefp) {
+    fh_free_entries(fh, keyfreefp, valfreefp);
+  }
+  MEM_freeN(fh->entries);
+  MEM_freeN(fh->ctrl);
+  MEM_freeN(fh);
+}
+
+void BLI_flathash_reserve(FlatHash *fh, const uint nentries_reserve)
+{
+  const uint capacity = fh_capacity_for_entries(nentries_reserve);
+  if (capacity > fh->capacity) {
+    fh_resize(fh, capacity);
+  }
+}
+
+void BLI_flathash_insert(FlatHash *fh, void *key, void *val)
+{
+  const uint hash_mixed = fh_hash_mix(fh->hashfp(key));
+  BLI_assert(fh_lookup_index(fh, key, hash_mixed) == -1);
+  FlatHashEntry *e = fh_insert_new(fh, key, hash_mixed);
+  e->val = val;
+}
+
+bool BLI_flathash_reinsert(
+    FlatHash *fh, void *key, void *val, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+  const uint hash_mixed = fh_hash_mix(fh->hashfp(key));
+  const int index = fh_lookup_index(fh, key, hash_mixed);
+  if (index != -1) {
+    FlatHashEntry *e = &fh->entries[index];
+    if (keyfreefp) {
+      keyfreefp(e->key);
+    }
+    if (valfreefp) {
+      valfreefp(e->val);
+    }
+    e->key = key;
+    e->val = val;
+    return false;
+  }
+  FlatHashEntry *e = fh_insert_new(fh, key, hash_mixed);
+  e->val = val;
+  return true;
+}
+
+void *BLI_flathash_lookup(const FlatHash *fh, const void *key)
+{
+  const int index = fh_lookup_index(fh, key, fh_hash_mix(fh->hashfp(key)));
+  return (index != -1) ? fh->entries[index].val : NULL;
+}
+
+void *BLI_flathash_lookup_default(const FlatHash *fh, const void *key, void *val_default)
+{
+  const int index = fh_lookup_index(fh, key, fh_hash_mix(fh->hashfp(key)));
+  return (index != -1) ? fh->entries[index].val : val_default;
+}
+
+void **BLI_flathash_lookup_p(FlatHash *fh, const void *key)
+{
+  const int index = fh_lookup_index(fh, key, fh_hash_mix(fh->hashfp(key)));
+  return (index != -1) ? &fh->entries[index].val : NULL;
+}
+
+bool BLI_flathash_ensure_p(FlatHash *fh, void *key, void ***r_val)
+{
+  const uint hash_mixed = fh_hash_mix(fh->hashfp(key));
+  const int index = fh_lookup_index(fh, key, hash_mixed);
+  if (index != -1) {
+    *r_val = &fh->entries[index].val;
+    return true;
+  }
+  FlatHashEntry *e = fh_insert_new(fh, key, hash_mixed);
+  *r_val = &e->val;
+  return false;
+}
+
+bool BLI_flathash_ensure_p_ex(FlatHash *fh, const void *key, void ***r_key, void ***r_val)
+{
+  const uint hash_mixed = fh_hash_mix(fh->hashfp(key));
+  const int index = fh_lookup_index(fh, key, hash_mixed);
+  if (index != -1) {
+    *r_key = &fh->entries[index].key;
+    *r_val = &fh->entries[index].val;
+    return true;
+  }
+  /* Note that the caller must re-assign the key. */
+  FlatHashEntry *e = fh_insert_new(fh, (void *)key, hash_mixed);
+  *r_key = &e->key;
+  *r_val = &e->val;
+  return false;
+}
+
+bool BLI_flathash_remove(FlatHash *fh,
+                         const void *key,
+                         GHashKeyFreeFP keyfreefp,
+                         GHashValFreeFP valfreefp)
+{
+  const int index = fh_lookup_index(fh, key, fh_hash_mix(fh->hashfp(key)));
+  if (index == -1) {
+    return false;
+  }
+  FlatHashEntry *e = &fh->entries[index];
+  if (keyfreefp) {
+    keyfreefp(e->key);
+  }
+  if (valfreefp) {
+    valfreefp(e->val);
+  }
+  fh_remove_index(fh, (uint)index);
+  return true;
+}
+
+void *BLI_flathash_popkey(FlatHash *fh, const void *key, GHashKeyFreeFP keyfreefp)
+{
+  const int index = fh_lookup_index(fh, key, fh_hash_mix(fh->hashfp(key)));
+  if (index == -1) {
+    return NULL;
+  }
+  FlatHashEntry *e = &fh->entries[index];
+  void *val = e->val;
+  if (keyfreefp) {
+    keyfreefp(e->key);
+  }
+  fh_remove_index(fh, (uint)index);
+  return val;
+}
+
+bool BLI_flathash_haskey(const FlatHash *fh, const void *key)
+{
+  return fh_lookup_index(fh, key, fh_hash_mix(fh->hashfp(key))) != -1;
+}
+
+bool BLI_flathash_pop(FlatHash *fh, FlatHashIterState *state, void **r_key, void **r_val)
+{
+  if (fh->nentries == 0) {
+    return false;
+  }
+  /* Entries may have been inserted before the current index or moved by a resize since the last
+   * pop, so wrap around like #ghash_find_next_bucket_index. */
+  const uint mask = fh->capacity - 1;
+  uint index = state->curr_index & mask;
+  while (!fh_ctrl_is_full(fh->ctrl[index])) {
+    index = (index + 1) & mask;
+  }
+  *r_key = fh->entries[index].key;
+  *r_val = fh->entries[index].val;
+  fh_remove_index(fh, index);
+  state->curr_index = index;
+  return true;
+}
+
+void BLI_flathash_clear(FlatHash *fh, GHashKeyFreeFP keyfreefp, GHashValFreeFP valfreefp)
+{
+  BLI_flathash_clear_ex(fh, keyfreefp, valfreefp, 0);
+}
+
+void BLI_flathash_clear_ex(FlatHash *fh,
+                           GHashKeyFreeFP keyfreefp,
+                           GHashValFreeFP valfreefp,
+                           const uint nentries_reserve)
+{
+  if (keyfreefp || valfreefp) {
+    fh_free_entries(fh, keyfreefp, valfreefp);
+  }
+  fh->nentries = 0;
+
+  if (nentries_reserve && fh_capacity_for_entries(nentries_reserve) != fh->capacity) {
+    MEM_freeN(fh->entries);
+    MEM_freeN(fh->ctrl);
+    fh_buffers_alloc(fh, fh_capacity_for_entries(nentries_reserve));
+  }
+  else {
+    memset(fh->ctrl, FH_CTRL_EMPTY, sizeof(*fh->ctrl) * (fh->capacity + FH_GROUP_WIDTH));
+    fh->growth_left = fh_capacity_to_growth(fh->capacity);
+  }
+}
+
+uint BLI_flathash_len(const FlatHash *fh)
+{
+  return fh->nentries;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name FlatHash Iterator API
+ * \{ */
+
+static void fh_iterator_find_next(FlatHashIterator *fhi, uint index)
+{
+  const FlatHash *fh = fhi->fh;
+  for (; index < fh->capacity; index++) {
+    if (fh_ctrl_is_full(fh->ctrl[index])) {
+      fhi->curr_index = index;
+      fhi->curr_entry = &fh->entries[index];
+      return;
+    }
+  }
+  fhi->curr_index = fh->capacity;
+  fhi->curr_entry = NULL;
+}
+
+void BLI_flathashIterator_init(FlatHashIterator *fhi, FlatHash *fh)
+{
+  fhi->fh = fh;
+  fh_iterator_find_next(fhi, 0);
+}
+
+void BLI_flathashIterator_step(FlatHashIterator *fhi)
+{
+  if (fhi->curr_entry) {
+    fh_iterator_find_next(fhi, fhi->curr_index + 1);
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name FlatSet Public API
+ *
+ * Use ghash API to give 'set' functionality
+ * \{ */
+
+FlatSet *BLI_flatset_new_ex(GHashHashFP hashfp,
+                            GHashCmpFP cmpfp,
+                            const char *info,
+                            const uint nentries_reserve)
+{
+  return (FlatSet *)BLI_flathash_new_ex(hashfp, cmpfp, info, nentries_reserve);
+}
+
+FlatSet *BLI_flatset_new(GHashHashFP hashfp, GHashCmpFP cmpfp, const char *info)
+{
+  return BLI_flatset_new_ex(hashfp, cmpfp, info, 0);
+}
+
+void BLI_flatset_free(FlatSet *fs, GHashKeyFreeFP keyfreefp)
+{
+  BLI_flathash_free((FlatHash *)fs, keyfreefp, NULL);
+}
+
+void BLI_flatset_reserve(FlatSet *fs, const uint nentries_reserve)
+{
+  BLI_flathash_reserve((FlatHash *)fs, nentries_reserve);
+}
+
+void BLI_flatset_insert(FlatSet *fs, void *key)
+{
+  BLI_flathash_insert((FlatHash *)fs, key, NULL);
+}
+
+bool BLI_flatset_add(FlatSet *fs, void *key)
+{
+  void **val_p;
+  return !BLI_flathash_ensure_p((FlatHash *)fs, key, &val_p);
+}
+
+bool BLI_flatset_ensure_p_ex(FlatSet *fs, const void *key, void ***r_key)
+{
+  void **val_p;
+  return BLI_flathash_ensure_p_ex((FlatHash *)fs, key, r_key, &val_p);
+}
+
+bool BLI_flatset_haskey(const FlatSet *fs, const void *key)
+{
+  return BLI_flathash_haskey((const FlatHash *)fs, key);
+}
+
+bool BLI_flatset_remove(FlatSet *fs, const void *key, GHashKeyFreeFP keyfreefp)
+{
+  return BLI_flathash_remove((FlatHash *)fs, key, keyfreefp, NULL);
+}
+
+bool BLI_flatset_pop(FlatSet *fs, FlatHashIterState *state, void **r_key)
+{
+  void *val;
+  return BLI_flathash_pop((FlatHash *)fs, state, r_key, &val);
+}
+
+void BLI_flatset_clear(FlatSet *fs, GHashKeyFreeFP keyfreefp)
+{
+  BLI_flathash_clear_ex((FlatHash *)fs, keyfreefp, NULL, 0);
+}
+
+void BLI_flatset_clear_ex(FlatSet *fs, GHashKeyFreeFP keyfreefp, const uint nentries_reserve)
+{
+  BLI_flathash_clear_ex((FlatHash *)fs, keyfreefp, NULL, nentries_reserve);
+}
+
+uint BLI_flatset_len(const FlatSet *fs)
+{
+  return BLI_flathash_len((const FlatHash *)fs);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Convenience FlatHash/FlatSet Creation Functions
+ * \{ */
+
+FlatHash *BLI_flathash_ptr_new_ex(const char *info, const uint nentries_reserve)
+{
+  return BLI_flathash_new_ex(BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, info, nentries_reserve);
+}
+FlatHash *BLI_flathash_ptr_new(const char *info)
+{
+  return BLI_flathash_ptr_new_ex(info, 0);
+}
+
+FlatHash *BLI_flathash_str_new_ex(const char *info, const uint nentries_reserve)
+{
+  return BLI_flathash_new_ex(
+      BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp, info, nentries_reserve);
+}
+FlatHash *BLI_flathash_str_new(const char *info)
+{
+  return BLI_flathash_str_new_ex(info, 0);
+}
+
+FlatHash *BLI_flathash_int_new_ex(const char *info, const uint nentries_reserve)
+{
+  return BLI_flathash_new_ex(
+      BLI_ghashutil_inthash_p, BLI_ghashutil_intcmp, info, nentries_reserve);
+}
+FlatHash *BLI_flathash_int_new(const char *info)
+{
+  return BLI_flathash_int_new_ex(info, 0);
+}
+
+FlatSet *BLI_flatset_ptr_new_ex(const char *info, const uint nentries_reserve)
+{
+  return BLI_flatset_new_ex(BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, info, nentries_reserve);
+}
+FlatSet *BLI_flatset_ptr_new(const char *info)
+{
+  return BLI_flatset_ptr_new_ex(info, 0);
+}
+
+FlatSet *BLI_flatset_str_new_ex(const char *info, const uint nentries_reserve)
+{
+  return BLI_flatset_new_ex(BLI_ghashutil_strhash_p, BLI_ghashutil_strcmp, info, nentries_reserve);
+}
+FlatSet *BLI_flatset_str_new(const char *info)
+{
+  return BLI_flatset_str_new_ex(info, 0);
+}
+
+/** \} */
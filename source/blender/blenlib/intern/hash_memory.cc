@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <algorithm>
+
+#include "BLI_array.hh"
+#include "BLI_hash_memory.hh"
+#include "BLI_hash_mm2a.h"
+#include "BLI_task.hh"
+#include "BLI_utildefines.h"
+
+namespace blender {
+
+uint64_t hash_memory(const void *data, const int64_t size)
+{
+  const uchar *bytes = static_cast<const uchar *>(data);
+  return (uint64_t(BLI_hash_mm2(bytes, size_t(size), 0)) << 32) |
+         BLI_hash_mm2(bytes, size_t(size), 1);
+}
+
+uint64_t hash_memory_parallel(const void *data, const int64_t size)
+{
+  const int64_t chunk_size = 1 << 18;
+  if (size <= chunk_size) {
+    return hash_memory(data, size);
+  }
+  const int64_t chunks_num = (size + chunk_size - 1) / chunk_size;
+  Array<uint64_t> chunk_hashes(chunks_num);
+  threading::parallel_for(IndexRange(chunks_num), 4, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      const int64_t offset = i * chunk_size;
+      chunk_hashes[i] = hash_memory(POINTER_OFFSET(data, offset),
+                                    std::min(chunk_size, size - offset));
+    }
+  });
+  return hash_memory(chunk_hashes.data(), chunk_hashes.as_span().size_in_bytes());
+}
+
+}  // namespace blender
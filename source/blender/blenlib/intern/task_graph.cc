@@ -10,6 +10,8 @@
 
 #include "BLI_task.h"
 
+#include "BLI_task_trace_private.hh"
+
 #include <memory>
 #include <vector>
 
@@ -77,14 +79,27 @@ struct TaskNode {
 #ifdef WITH_TBB
   tbb::flow::continue_msg run(const tbb::flow::continue_msg UNUSED(input))
   {
-    run_func(task_data);
+    run_traced();
     return tbb::flow::continue_msg();
   }
 #endif
 
-  void run_serial()
+  void run_traced()
   {
+    if (!task_trace_is_enabled()) {
+      run_func(task_data);
+      return;
+    }
+    /* Nodes are queued by their predecessors inside the flow graph,
+     * so only the execution time is known here. */
+    const uint64_t time_begin = task_trace_time_now();
     run_func(task_data);
+    task_trace_event_add("TaskGraph", "task_graph", time_begin, time_begin, task_trace_time_now());
+  }
+
+  void run_serial()
+  {
+    run_traced();
     for (TaskNode *successor : successors) {
       successor->run_serial();
     }
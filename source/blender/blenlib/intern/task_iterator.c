@@ -221,6 +221,7 @@ static void task_parallel_iterator_do(const TaskParallelSettings *settings,
   const bool use_userdata_chunk = (userdata_chunk_size != 0) && (userdata_chunk != NULL);
 
   TaskPool *task_pool = BLI_task_pool_create(state, TASK_PRIORITY_HIGH);
+  BLI_task_pool_name_set(task_pool, "BLI_task_parallel_iterator");
 
   if (use_userdata_chunk) {
     userdata_chunk_array = MALLOCA(userdata_chunk_size * tasks_num);
@@ -391,6 +392,7 @@ void BLI_task_parallel_mempool(BLI_mempool *mempool,
 
   ParallelMempoolState state;
   TaskPool *task_pool = BLI_task_pool_create(&state, TASK_PRIORITY_HIGH);
+  BLI_task_pool_name_set(task_pool, "BLI_task_parallel_mempool");
   const int threads_num = BLI_task_scheduler_num_threads();
 
   /* The idea here is to prevent creating task for each of the loop iterations
@@ -19,6 +19,8 @@
 #include "BLI_task.h"
 #include "BLI_threads.h"
 
+#include "BLI_task_trace_private.hh"
+
 #ifdef WITH_TBB
 #  include <tbb/blocked_range.h>
 #  include <tbb/task_arena.h>
@@ -36,13 +38,20 @@ class Task {
   void *taskdata;
   bool free_taskdata;
   TaskFreeFunction freedata;
+  /* Time the task was pushed, only set when tracing. */
+  uint64_t trace_time_queued;
 
   Task(TaskPool *pool,
        TaskRunFunction run,
        void *taskdata,
        bool free_taskdata,
        TaskFreeFunction freedata)
-      : pool(pool), run(run), taskdata(taskdata), free_taskdata(free_taskdata), freedata(freedata)
+      : pool(pool),
+        run(run),
+        taskdata(taskdata),
+        free_taskdata(free_taskdata),
+        freedata(freedata),
+        trace_time_queued(task_trace_is_enabled() ? task_trace_time_now() : 0)
   {
   }
 
@@ -67,7 +76,8 @@ class Task {
         run(other.run),
         taskdata(other.taskdata),
         free_taskdata(other.free_taskdata),
-        freedata(other.freedata)
+        freedata(other.freedata),
+        trace_time_queued(other.trace_time_queued)
   {
     other.pool = nullptr;
     other.run = nullptr;
@@ -82,7 +92,8 @@ class Task {
         run(other.run),
         taskdata(other.taskdata),
         free_taskdata(other.free_taskdata),
-        freedata(other.freedata)
+        freedata(other.freedata),
+        trace_time_queued(other.trace_time_queued)
   {
     ((Task &)other).pool = NULL;
     ((Task &)other).run = NULL;
@@ -145,6 +156,9 @@ struct TaskPool {
   ThreadMutex user_mutex;
   void *userdata;
 
+  /* Name shown in task traces. */
+  const char *name;
+
 #ifdef WITH_TBB
   /* TBB task pool. */
   TBBTaskGroup tbb_group;
@@ -161,7 +175,15 @@ struct TaskPool {
 /* Execute task. */
 void Task::operator()() const
 {
+  if (trace_time_queued == 0 || !task_trace_is_enabled()) {
+    run(pool, taskdata);
+    return;
+  }
+
+  const uint64_t time_begin = task_trace_time_now();
   run(pool, taskdata);
+  task_trace_event_add(
+      pool->name, "task_pool", trace_time_queued, time_begin, task_trace_time_now());
 }
 
 /* TBB Task Pool.
@@ -367,6 +389,7 @@ static TaskPool *task_pool_create_ex(void *userdata, TaskPoolType type, eTaskPri
   pool->use_threads = use_threads;
 
   pool->userdata = userdata;
+  pool->name = "TaskPool";
   BLI_mutex_init(&pool->user_mutex);
 
   switch (type) {
@@ -479,6 +502,8 @@ void BLI_task_pool_push(TaskPool *pool,
 
 void BLI_task_pool_work_and_wait(TaskPool *pool)
 {
+  const uint64_t trace_time_begin = task_trace_is_enabled() ? task_trace_time_now() : 0;
+
   switch (pool->type) {
     case TASK_POOL_TBB:
     case TASK_POOL_TBB_SUSPENDED:
@@ -490,6 +515,12 @@ void BLI_task_pool_work_and_wait(TaskPool *pool)
       background_task_pool_work_and_wait(pool);
       break;
   }
+
+  if (trace_time_begin != 0) {
+    /* Time spent waiting, which includes tasks this thread ran in the meantime. */
+    task_trace_event_add(
+        pool->name, "task_pool_wait", trace_time_begin, trace_time_begin, task_trace_time_now());
+  }
 }
 
 void BLI_task_pool_cancel(TaskPool *pool)
@@ -531,3 +562,8 @@ ThreadMutex *BLI_task_pool_user_mutex(TaskPool *pool)
 {
   return &pool->user_mutex;
 }
+
+void BLI_task_pool_name_set(TaskPool *pool, const char *name)
+{
+  pool->name = name;
+}
@@ -17,6 +17,8 @@
 
 #include "atomic_ops.h"
 
+#include "BLI_task_trace_private.hh"
+
 #ifdef WITH_TBB
 #  include <tbb/blocked_range.h>
 #  include <tbb/enumerable_thread_specific.h>
@@ -34,23 +36,35 @@ struct RangeTask {
 
   void *userdata_chunk;
 
+  /* Time the range was started, only set when tracing. */
+  uint64_t trace_time_queued;
+
   /* Root constructor. */
   RangeTask(TaskParallelRangeFunc func, void *userdata, const TaskParallelSettings *settings)
-      : func(func), userdata(userdata), settings(settings)
+      : func(func),
+        userdata(userdata),
+        settings(settings),
+        trace_time_queued(task_trace_is_enabled() ? task_trace_time_now() : 0)
   {
     init_chunk(settings->userdata_chunk);
   }
 
   /* Copy constructor. */
   RangeTask(const RangeTask &other)
-      : func(other.func), userdata(other.userdata), settings(other.settings)
+      : func(other.func),
+        userdata(other.userdata),
+        settings(other.settings),
+        trace_time_queued(other.trace_time_queued)
   {
     init_chunk(settings->userdata_chunk);
   }
 
   /* Splitting constructor for parallel reduce. */
   RangeTask(RangeTask &other, tbb::split /* unused */)
-      : func(other.func), userdata(other.userdata), settings(other.settings)
+      : func(other.func),
+        userdata(other.userdata),
+        settings(other.settings),
+        trace_time_queued(other.trace_time_queued)
   {
     init_chunk(settings->userdata_chunk);
   }
@@ -78,9 +92,17 @@ struct RangeTask {
   {
     TaskParallelTLS tls;
     tls.userdata_chunk = userdata_chunk;
+    const uint64_t trace_time_begin = trace_time_queued ? task_trace_time_now() : 0;
     for (int i = r.begin(); i != r.end(); ++i) {
       func(userdata, i, &tls);
     }
+    if (trace_time_begin != 0) {
+      task_trace_event_add("BLI_task_parallel_range",
+                           "parallel_range",
+                           trace_time_queued,
+                           trace_time_begin,
+                           task_trace_time_now());
+    }
   }
 
   void join(const RangeTask &other)
@@ -11,6 +11,8 @@
 #include "BLI_task.h"
 #include "BLI_threads.h"
 
+#include "BLI_task_trace_private.hh"
+
 #ifdef WITH_TBB
 /* Need to include at least one header to get the version define. */
 #  include <tbb/blocked_range.h>
@@ -54,6 +56,8 @@ void BLI_task_scheduler_init()
 
 void BLI_task_scheduler_exit()
 {
+  task_trace_exit();
+
 #ifdef WITH_TBB_GLOBAL_CONTROL
   MEM_delete(task_scheduler_global_control);
 #endif
@@ -0,0 +1,258 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup bli
+ *
+ * Task tracing, to inspect how tasks are scheduled over threads.
+ *
+ * Each thread records events into its own fixed size ring buffer, so recording doesn't need
+ * any locks: only the owning thread writes to a buffer and publishes the number of written
+ * events atomically. Once the ring buffer is full the oldest events are overwritten.
+ *
+ * Buffers are allocated on first use by a thread and kept until #BLI_task_scheduler_exit.
+ * Disabling tracing waits for the threads that are still writing an event, so buffers can be
+ * read and freed afterwards.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "BLI_task_trace_private.hh"
+
+/** Number of events kept per thread, must be a power of two. */
+#define TASK_TRACE_BUFFER_SIZE (1 << 15)
+
+struct TaskTraceEvent {
+  const char *name;
+  const char *category;
+  uint64_t time_queued;
+  uint64_t time_begin;
+  uint64_t time_end;
+};
+
+struct TaskTraceThreadBuffer {
+  int thread_index;
+  bool is_main;
+  /** Total number of events written, the ring buffer index is this modulo the buffer size. */
+  std::atomic<uint64_t> events_num;
+  TaskTraceEvent events[TASK_TRACE_BUFFER_SIZE];
+};
+
+std::atomic<bool> g_task_trace_is_enabled = false;
+
+static struct {
+  std::mutex mutex;
+  std::vector<TaskTraceThreadBuffer *> buffers;
+  /** Incremented when buffers are freed, so threads don't use stale buffers. */
+  std::atomic<int> generation = 0;
+  /** Number of threads currently writing an event, see #task_trace_recorders_wait. */
+  std::atomic<int> recorders_num = 0;
+  /** Only events within this time range are written. */
+  uint64_t time_begin = 0;
+  uint64_t time_end = UINT64_MAX;
+  /** Written when the task scheduler exits, empty if not set. */
+  std::string exit_filepath;
+} g_task_trace;
+
+struct TaskTraceThreadLocal {
+  TaskTraceThreadBuffer *buffer = nullptr;
+  int generation = -1;
+};
+static thread_local TaskTraceThreadLocal g_task_trace_local;
+
+uint64_t task_trace_time_now()
+{
+  return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch())
+                      .count());
+}
+
+static TaskTraceThreadBuffer *task_trace_thread_buffer_ensure()
+{
+  TaskTraceThreadLocal &local = g_task_trace_local;
+  const int generation = g_task_trace.generation.load(std::memory_order_acquire);
+  if (local.buffer && local.generation == generation) {
+    return local.buffer;
+  }
+
+  TaskTraceThreadBuffer *buffer = static_cast<TaskTraceThreadBuffer *>(
+      MEM_callocN(sizeof(TaskTraceThreadBuffer), __func__));
+  buffer->is_main = BLI_thread_is_main();
+  {
+    std::scoped_lock lock(g_task_trace.mutex);
+    buffer->thread_index = int(g_task_trace.buffers.size());
+    g_task_trace.buffers.push_back(buffer);
+  }
+  local.buffer = buffer;
+  local.generation = generation;
+  return buffer;
+}
+
+void task_trace_event_add(const char *name,
+                          const char *category,
+                          const uint64_t time_queued,
+                          const uint64_t time_begin,
+                          const uint64_t time_end)
+{
+  /* Register before checking whether tracing is still enabled, so that a thread disabling it
+   * either sees this thread as recording, or this thread sees tracing as disabled. */
+  g_task_trace.recorders_num.fetch_add(1, std::memory_order_seq_cst);
+  if (g_task_trace_is_enabled.load(std::memory_order_seq_cst)) {
+    TaskTraceThreadBuffer *buffer = task_trace_thread_buffer_ensure();
+    const uint64_t index = buffer->events_num.load(std::memory_order_relaxed);
+    TaskTraceEvent &event = buffer->events[index & (TASK_TRACE_BUFFER_SIZE - 1)];
+    event.name = name;
+    event.category = category;
+    event.time_queued = time_queued;
+    event.time_begin = time_begin;
+    event.time_end = time_end;
+    buffer->events_num.store(index + 1, std::memory_order_release);
+  }
+  g_task_trace.recorders_num.fetch_sub(1, std::memory_order_release);
+}
+
+/** Wait until no thread is writing an event anymore, once tracing has been disabled. */
+static void task_trace_recorders_wait()
+{
+  while (g_task_trace.recorders_num.load(std::memory_order_seq_cst) != 0) {
+    std::this_thread::yield();
+  }
+}
+
+void BLI_task_trace_begin()
+{
+  g_task_trace.time_begin = task_trace_time_now();
+  g_task_trace.time_end = UINT64_MAX;
+  g_task_trace_is_enabled.store(true, std::memory_order_relaxed);
+}
+
+void BLI_task_trace_end()
+{
+  g_task_trace_is_enabled.store(false, std::memory_order_seq_cst);
+  g_task_trace.time_end = task_trace_time_now();
+  task_trace_recorders_wait();
+}
+
+bool BLI_task_trace_is_enabled()
+{
+  return task_trace_is_enabled();
+}
+
+namespace blender::threading::detail {
+
+bool trace_is_enabled()
+{
+  return task_trace_is_enabled();
+}
+
+uint64_t trace_time_now()
+{
+  return task_trace_time_now();
+}
+
+void trace_event_add(const char *name,
+                     const char *category,
+                     const uint64_t time_queued,
+                     const uint64_t time_begin,
+                     const uint64_t time_end)
+{
+  task_trace_event_add(name, category, time_queued, time_begin, time_end);
+}
+
+}  // namespace blender::threading::detail
+
+bool BLI_task_trace_write_json(const char *filepath)
+{
+  if (task_trace_is_enabled()) {
+    return false;
+  }
+
+  FILE *file = BLI_fopen(filepath, "w");
+  if (file == nullptr) {
+    return false;
+  }
+
+  std::scoped_lock lock(g_task_trace.mutex);
+  const uint64_t time_begin = g_task_trace.time_begin;
+  const uint64_t time_end = g_task_trace.time_end;
+
+  /* Chrome trace event format, times are in micro-seconds. */
+  fprintf(file, "{\"traceEvents\":[\n");
+  bool is_first = true;
+  for (TaskTraceThreadBuffer *buffer : g_task_trace.buffers) {
+    fprintf(file,
+            "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+            "\"args\":{\"name\":\"%s %d\"}}",
+            is_first ? "" : ",\n",
+            buffer->thread_index,
+            buffer->is_main ? "Main" : "Worker",
+            buffer->thread_index);
+    is_first = false;
+
+    const uint64_t events_num = buffer->events_num.load(std::memory_order_acquire);
+    const uint64_t events_first = (events_num > TASK_TRACE_BUFFER_SIZE) ?
+                                      events_num - TASK_TRACE_BUFFER_SIZE :
+                                      0;
+    for (uint64_t i = events_first; i < events_num; i++) {
+      const TaskTraceEvent &event = buffer->events[i & (TASK_TRACE_BUFFER_SIZE - 1)];
+      if (event.time_begin < time_begin || event.time_end > time_end) {
+        continue;
+      }
+      fprintf(file,
+              ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+              "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"queued_us\":%.3f}}",
+              event.name,
+              event.category,
+              buffer->thread_index,
+              double(event.time_begin - time_begin) * 1e-3,
+              double(event.time_end - event.time_begin) * 1e-3,
+              double(event.time_begin - std::min(event.time_queued, event.time_begin)) * 1e-3);
+    }
+  }
+  fprintf(file, "\n]}\n");
+
+  fclose(file);
+  return true;
+}
+
+void BLI_task_trace_write_json_on_exit(const char *filepath)
+{
+  g_task_trace.exit_filepath = filepath;
+}
+
+void task_trace_exit()
+{
+  if (!g_task_trace.exit_filepath.empty()) {
+    if (task_trace_is_enabled()) {
+      BLI_task_trace_end();
+    }
+    if (BLI_task_trace_write_json(g_task_trace.exit_filepath.c_str())) {
+      printf("Task trace written to '%s'\n", g_task_trace.exit_filepath.c_str());
+    }
+    else {
+      printf("Error: cannot write task trace to '%s'\n", g_task_trace.exit_filepath.c_str());
+    }
+    g_task_trace.exit_filepath.clear();
+  }
+
+  g_task_trace_is_enabled.store(false, std::memory_order_seq_cst);
+  task_trace_recorders_wait();
+
+  std::scoped_lock lock(g_task_trace.mutex);
+  g_task_trace.generation.fetch_add(1, std::memory_order_release);
+  for (TaskTraceThreadBuffer *buffer : g_task_trace.buffers) {
+    MEM_freeN(buffer);
+  }
+  g_task_trace.buffers.clear();
+}
@@ -0,0 +1,172 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_flathash.h"
+#include "BLI_rand.h"
+#include "BLI_utildefines.h"
+
+#define TESTCASE_SIZE 10000
+
+static void init_keys(unsigned int keys[TESTCASE_SIZE], const int seed)
+{
+  /* Sequential keys shuffled, so they are known to be unique. */
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    keys[i] = (unsigned int)i + 1;
+  }
+  RNG *rng = BLI_rng_new(seed);
+  BLI_rng_shuffle_array(rng, keys, sizeof(*keys), TESTCASE_SIZE);
+  BLI_rng_free(rng);
+}
+
+TEST(flathash, InsertLookup)
+{
+  FlatHash *fh = BLI_flathash_int_new(__func__);
+  unsigned int keys[TESTCASE_SIZE];
+
+  init_keys(keys, 0);
+
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    BLI_flathash_insert(fh, POINTER_FROM_UINT(keys[i]), POINTER_FROM_UINT(keys[i]));
+  }
+
+  EXPECT_EQ(BLI_flathash_len(fh), TESTCASE_SIZE);
+
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    void *v = BLI_flathash_lookup(fh, POINTER_FROM_UINT(keys[i]));
+    EXPECT_EQ(POINTER_AS_UINT(v), keys[i]);
+  }
+  EXPECT_FALSE(BLI_flathash_haskey(fh, POINTER_FROM_UINT(TESTCASE_SIZE + 1)));
+
+  BLI_flathash_free(fh, nullptr, nullptr);
+}
+
+/* Remove half of the keys and re-insert them repeatedly, so deleted slots are reused. */
+TEST(flathash, InsertRemove)
+{
+  FlatHash *fh = BLI_flathash_int_new(__func__);
+  unsigned int keys[TESTCASE_SIZE];
+
+  init_keys(keys, 10);
+
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    BLI_flathash_insert(fh, POINTER_FROM_UINT(keys[i]), POINTER_FROM_UINT(keys[i]));
+  }
+
+  for (int pass = 0; pass < 4; pass++) {
+    for (int i = 0; i < TESTCASE_SIZE; i += 2) {
+      void *v = BLI_flathash_popkey(fh, POINTER_FROM_UINT(keys[i]), nullptr);
+      EXPECT_EQ(POINTER_AS_UINT(v), keys[i]);
+    }
+    EXPECT_EQ(BLI_flathash_len(fh), TESTCASE_SIZE / 2);
+    for (int i = 0; i < TESTCASE_SIZE; i++) {
+      EXPECT_EQ(BLI_flathash_haskey(fh, POINTER_FROM_UINT(keys[i])), (i % 2) != 0);
+    }
+    for (int i = 0; i < TESTCASE_SIZE; i += 2) {
+      EXPECT_TRUE(BLI_flathash_reinsert(
+          fh, POINTER_FROM_UINT(keys[i]), POINTER_FROM_UINT(keys[i]), nullptr, nullptr));
+    }
+  }
+
+  EXPECT_EQ(BLI_flathash_len(fh), TESTCASE_SIZE);
+
+  FlatHashIterState state = {0};
+  void *k, *v;
+  int pop_count = 0;
+  while (BLI_flathash_pop(fh, &state, &k, &v)) {
+    EXPECT_EQ(k, v);
+    pop_count++;
+  }
+  EXPECT_EQ(pop_count, TESTCASE_SIZE);
+  EXPECT_EQ(BLI_flathash_len(fh), 0);
+
+  BLI_flathash_free(fh, nullptr, nullptr);
+}
+
+/* Insert keys between pops, so entries end up before the current pop index and the table is
+ * resized while popping. */
+TEST(flathash, PopInsert)
+{
+  FlatHash *fh = BLI_flathash_int_new(__func__);
+  unsigned int keys[TESTCASE_SIZE];
+
+  init_keys(keys, 30);
+
+  for (int i = 0; i < TESTCASE_SIZE / 4; i++) {
+    BLI_flathash_insert(fh, POINTER_FROM_UINT(keys[i]), POINTER_FROM_UINT(keys[i]));
+  }
+
+  FlatHashIterState state = {0};
+  void *k, *v;
+  int next_key = TESTCASE_SIZE / 4;
+  int pop_count = 0;
+  while (BLI_flathash_pop(fh, &state, &k, &v)) {
+    EXPECT_EQ(k, v);
+    pop_count++;
+    /* Insert two keys for every pop until all keys are used. */
+    for (int j = 0; j < 2 && next_key < TESTCASE_SIZE; j++, next_key++) {
+      BLI_flathash_insert(
+          fh, POINTER_FROM_UINT(keys[next_key]), POINTER_FROM_UINT(keys[next_key]));
+    }
+  }
+  EXPECT_EQ(pop_count, TESTCASE_SIZE);
+  EXPECT_EQ(BLI_flathash_len(fh), 0);
+
+  BLI_flathash_free(fh, nullptr, nullptr);
+}
+
+TEST(flathash, EnsureIter)
+{
+  FlatHash *fh = BLI_flathash_int_new(__func__);
+  unsigned int keys[TESTCASE_SIZE];
+
+  init_keys(keys, 20);
+
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    void **val_p;
+    EXPECT_FALSE(BLI_flathash_ensure_p(fh, POINTER_FROM_UINT(keys[i]), &val_p));
+    *val_p = POINTER_FROM_UINT(keys[i] * 2);
+  }
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    void **val_p;
+    EXPECT_TRUE(BLI_flathash_ensure_p(fh, POINTER_FROM_UINT(keys[i]), &val_p));
+    EXPECT_EQ(POINTER_AS_UINT(*val_p), keys[i] * 2);
+  }
+
+  FlatHashIterator iter;
+  int iter_count = 0;
+  FLATHASH_ITER (iter, fh) {
+    EXPECT_EQ(POINTER_AS_UINT(BLI_flathashIterator_getKey(&iter)) * 2,
+              POINTER_AS_UINT(BLI_flathashIterator_getValue(&iter)));
+    iter_count++;
+  }
+  EXPECT_EQ(iter_count, TESTCASE_SIZE);
+
+  BLI_flathash_clear(fh, nullptr, nullptr);
+  EXPECT_EQ(BLI_flathash_len(fh), 0);
+  EXPECT_FALSE(BLI_flathash_haskey(fh, POINTER_FROM_UINT(keys[0])));
+
+  BLI_flathash_free(fh, nullptr, nullptr);
+}
+
+TEST(flatset, AddRemove)
+{
+  FlatSet *fs = BLI_flatset_ptr_new(__func__);
+  unsigned int keys[TESTCASE_SIZE];
+
+  init_keys(keys, 30);
+
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    EXPECT_TRUE(BLI_flatset_add(fs, &keys[i]));
+    EXPECT_FALSE(BLI_flatset_add(fs, &keys[i]));
+  }
+  EXPECT_EQ(BLI_flatset_len(fs), TESTCASE_SIZE);
+
+  for (int i = 0; i < TESTCASE_SIZE; i++) {
+    EXPECT_TRUE(BLI_flatset_remove(fs, &keys[i], nullptr));
+    EXPECT_FALSE(BLI_flatset_haskey(fs, &keys[i]));
+  }
+  EXPECT_EQ(BLI_flatset_len(fs), 0);
+
+  BLI_flatset_free(fs, nullptr);
+}
@@ -66,8 +66,12 @@ static void optimal_check_callback(void *userdata,
  * Note that a small epsilon is added to the BVH nodes bounds, even if we pass in zero.
  * Use rounding to ensure very close nodes don't cause the wrong node to be found as nearest.
  */
-static void find_nearest_points_test(
-    int points_len, float scale, int round, int random_seed, bool optimal = false)
+static void find_nearest_points_test(int points_len,
+                                     float scale,
+                                     int round,
+                                     int random_seed,
+                                     bool optimal = false,
+                                     int balance_flag = 0)
 {
   struct RNG *rng = BLI_rng_new(random_seed);
   BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 8, 8);
@@ -79,7 +83,7 @@ static void find_nearest_points_test(
     rng_v3_round(points[i], 3, rng, round, scale);
     BLI_bvhtree_insert(tree, i, points[i], 1);
   }
-  BLI_bvhtree_balance(tree);
+  BLI_bvhtree_balance_ex(tree, balance_flag);
 
   /* first find each point */
   BVHTree_NearestPointCallback callback = optimal ? optimal_check_callback : nullptr;
@@ -132,3 +136,92 @@ TEST(kdopbvh, OptimalFindNearest_500)
 {
   find_nearest_points_test(500, 1.0, 1000, 12, true);
 }
+
+TEST(kdopbvh, SAHFindNearest_1)
+{
+  find_nearest_points_test(1, 1.0, 1000, 1234, false, BVH_BALANCE_SAH);
+}
+TEST(kdopbvh, SAHFindNearest_2)
+{
+  find_nearest_points_test(2, 1.0, 1000, 123, false, BVH_BALANCE_SAH);
+}
+TEST(kdopbvh, SAHFindNearest_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, false, BVH_BALANCE_SAH);
+}
+TEST(kdopbvh, SAHOptimalFindNearest_500)
+{
+  find_nearest_points_test(500, 1.0, 1000, 12, true, BVH_BALANCE_SAH);
+}
+
+/**
+ * Batched queries must find the same distances as separate queries,
+ * only ties between equally distant points may resolve to different indices.
+ */
+static void batch_queries_test(int points_len, int queries_len, int random_seed, int balance_flag)
+{
+  struct RNG *rng = BLI_rng_new(random_seed);
+  BVHTree *tree = BLI_bvhtree_new(points_len, 0.0, 4, 6);
+
+  float(*points)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * points_len, __func__);
+  for (int i = 0; i < points_len; i++) {
+    rng_v3_round(points[i], 3, rng, 1000, 1.0f);
+    BLI_bvhtree_insert(tree, i, points[i], 1);
+  }
+  BLI_bvhtree_balance_ex(tree, balance_flag);
+
+  float(*origins)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * queries_len, __func__);
+  float(*directions)[3] = (float(*)[3])MEM_mallocN(sizeof(float[3]) * queries_len, __func__);
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_mallocN(sizeof(BVHTreeRayHit) * queries_len,
+                                                     __func__);
+  BVHTreeNearest *nearests = (BVHTreeNearest *)MEM_mallocN(
+      sizeof(BVHTreeNearest) * queries_len, __func__);
+  for (int i = 0; i < queries_len; i++) {
+    rng_v3_round(origins[i], 3, rng, 1000, 1.0f);
+    BLI_rng_get_float_unit_v3(rng, directions[i]);
+    hits[i].index = -1;
+    hits[i].dist = BVH_RAYCAST_DIST_MAX;
+    nearests[i].index = -1;
+    nearests[i].dist_sq = FLT_MAX;
+  }
+
+  BLI_bvhtree_ray_cast_batch(
+      tree, origins, directions, queries_len, 0.0f, hits, nullptr, nullptr, BVH_RAYCAST_DEFAULT);
+  BLI_bvhtree_find_nearest_batch(tree, origins, queries_len, nearests, nullptr, nullptr, 0);
+
+  for (int i = 0; i < queries_len; i++) {
+    BVHTreeRayHit hit;
+    hit.index = -1;
+    hit.dist = BVH_RAYCAST_DIST_MAX;
+    BLI_bvhtree_ray_cast(tree, origins[i], directions[i], 0.0f, &hit, nullptr, nullptr);
+    EXPECT_EQ(hits[i].index == -1, hit.index == -1);
+    EXPECT_FLOAT_EQ(hits[i].dist, hit.dist);
+
+    BVHTreeNearest nearest;
+    nearest.index = -1;
+    nearest.dist_sq = FLT_MAX;
+    BLI_bvhtree_find_nearest(tree, origins[i], &nearest, nullptr, nullptr);
+    EXPECT_FLOAT_EQ(nearests[i].dist_sq, nearest.dist_sq);
+  }
+
+  BLI_bvhtree_free(tree);
+  BLI_rng_free(rng);
+  MEM_freeN(points);
+  MEM_freeN(origins);
+  MEM_freeN(directions);
+  MEM_freeN(hits);
+  MEM_freeN(nearests);
+}
+
+TEST(kdopbvh, BatchQueries_1)
+{
+  batch_queries_test(1, 10, 1234, 0);
+}
+TEST(kdopbvh, BatchQueries_500)
+{
+  batch_queries_test(500, 1000, 12, 0);
+}
+TEST(kdopbvh, SAHBatchQueries_500)
+{
+  batch_queries_test(500, 1000, 12, BVH_BALANCE_SAH);
+}
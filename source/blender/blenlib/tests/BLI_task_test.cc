@@ -10,6 +10,7 @@
 
 #include "BLI_utildefines.h"
 
+#include "BLI_fileops.h"
 #include "BLI_listbase.h"
 #include "BLI_mempool.h"
 #include "BLI_task.h"
@@ -294,3 +295,27 @@ TEST(task, ParallelInvoke)
                                       [&]() { counter++; });
   EXPECT_EQ(counter, 6);
 }
+
+TEST(task, TraceParallelFor)
+{
+  const std::string filepath = testing::TempDir() + "task_trace_test.json";
+
+  BLI_task_trace_begin();
+  std::atomic<int> counter = 0;
+  blender::threading::parallel_for(blender::IndexRange(ITEMS_NUM), 100, [&](const auto range) {
+    counter += int(range.size());
+  });
+  /* The events can't be written while they are still recorded. */
+  EXPECT_FALSE(BLI_task_trace_write_json(filepath.c_str()));
+  BLI_task_trace_end();
+  EXPECT_EQ(counter, ITEMS_NUM);
+
+  ASSERT_TRUE(BLI_task_trace_write_json(filepath.c_str()));
+  size_t size;
+  char *json = static_cast<char *>(BLI_file_read_text_as_mem(filepath.c_str(), 1, &size));
+  ASSERT_NE(json, nullptr);
+  json[size] = '\0';
+  EXPECT_NE(strstr(json, "\"name\":\"threading::parallel_for\""), nullptr);
+  MEM_freeN(json);
+  BLI_delete(filepath.c_str(), false, false);
+}
@@ -0,0 +1,278 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "BLI_ressource_strings.h"
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_flathash.h"
+#include "BLI_ghash.h"
+#include "BLI_rand.h"
+#include "BLI_string.h"
+#include "BLI_utildefines.h"
+#include "PIL_time_utildefines.h"
+
+/* Compare #FlatHash against #GHash with the same hash & compare callbacks,
+ * over insert, lookup (hits & misses) and remove workloads. */
+
+/* Run the longest tests! */
+//#define FLATHASH_RUN_BIG
+
+static unsigned int *randint_data_create(const unsigned int count, const unsigned int seed)
+{
+  unsigned int *data = (unsigned int *)MEM_mallocN(sizeof(*data) * (size_t)count, __func__);
+  RNG *rng = BLI_rng_new(seed);
+  for (unsigned int i = 0; i < count; i++) {
+    data[i] = BLI_rng_get_uint(rng);
+  }
+  BLI_rng_free(rng);
+  return data;
+}
+
+/* RandInt: insert, lookup, lookup missing keys, then remove. */
+
+static void randint_ghash_tests(const char *id, const unsigned int count)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  unsigned int *data = randint_data_create(count, 1);
+  unsigned int *data_miss = randint_data_create(count, 2);
+  GHash *ghash = BLI_ghash_int_new(__func__);
+
+  {
+    TIMEIT_START(ghash_insert);
+    for (unsigned int i = 0; i < count; i++) {
+      BLI_ghash_reinsert(ghash, POINTER_FROM_UINT(data[i]), POINTER_FROM_UINT(i), NULL, NULL);
+    }
+    TIMEIT_END(ghash_insert);
+  }
+  {
+    TIMEIT_START(ghash_lookup);
+    for (unsigned int i = 0; i < count; i++) {
+      EXPECT_TRUE(BLI_ghash_haskey(ghash, POINTER_FROM_UINT(data[i])));
+    }
+    TIMEIT_END(ghash_lookup);
+  }
+  {
+    unsigned int found = 0;
+    TIMEIT_START(ghash_lookup_miss);
+    for (unsigned int i = 0; i < count; i++) {
+      found += BLI_ghash_haskey(ghash, POINTER_FROM_UINT(data_miss[i]));
+    }
+    TIMEIT_END(ghash_lookup_miss);
+    UNUSED_VARS(found);
+  }
+  {
+    TIMEIT_START(ghash_remove);
+    for (unsigned int i = 0; i < count; i++) {
+      BLI_ghash_remove(ghash, POINTER_FROM_UINT(data[i]), NULL, NULL);
+    }
+    TIMEIT_END(ghash_remove);
+  }
+  EXPECT_EQ(BLI_ghash_len(ghash), 0);
+
+  BLI_ghash_free(ghash, nullptr, nullptr);
+  MEM_freeN(data);
+  MEM_freeN(data_miss);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+static void randint_flathash_tests(const char *id, const unsigned int count)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  unsigned int *data = randint_data_create(count, 1);
+  unsigned int *data_miss = randint_data_create(count, 2);
+  FlatHash *fh = BLI_flathash_int_new(__func__);
+
+  {
+    TIMEIT_START(flathash_insert);
+    for (unsigned int i = 0; i < count; i++) {
+      BLI_flathash_reinsert(fh, POINTER_FROM_UINT(data[i]), POINTER_FROM_UINT(i), NULL, NULL);
+    }
+    TIMEIT_END(flathash_insert);
+  }
+  {
+    TIMEIT_START(flathash_lookup);
+    for (unsigned int i = 0; i < count; i++) {
+      EXPECT_TRUE(BLI_flathash_haskey(fh, POINTER_FROM_UINT(data[i])));
+    }
+    TIMEIT_END(flathash_lookup);
+  }
+  {
+    unsigned int found = 0;
+    TIMEIT_START(flathash_lookup_miss);
+    for (unsigned int i = 0; i < count; i++) {
+      found += BLI_flathash_haskey(fh, POINTER_FROM_UINT(data_miss[i]));
+    }
+    TIMEIT_END(flathash_lookup_miss);
+    UNUSED_VARS(found);
+  }
+  {
+    TIMEIT_START(flathash_remove);
+    for (unsigned int i = 0; i < count; i++) {
+      BLI_flathash_remove(fh, POINTER_FROM_UINT(data[i]), NULL, NULL);
+    }
+    TIMEIT_END(flathash_remove);
+  }
+  EXPECT_EQ(BLI_flathash_len(fh), 0);
+
+  BLI_flathash_free(fh, nullptr, nullptr);
+  MEM_freeN(data);
+  MEM_freeN(data_miss);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(flathash, RandIntGHash12000)
+{
+  randint_ghash_tests("RandInt - GHash - 12000", 12000);
+}
+
+TEST(flathash, RandIntFlatHash12000)
+{
+  randint_flathash_tests("RandInt - FlatHash - 12000", 12000);
+}
+
+TEST(flathash, RandIntGHash1000000)
+{
+  randint_ghash_tests("RandInt - GHash - 1000000", 1000000);
+}
+
+TEST(flathash, RandIntFlatHash1000000)
+{
+  randint_flathash_tests("RandInt - FlatHash - 1000000", 1000000);
+}
+
+#ifdef FLATHASH_RUN_BIG
+TEST(flathash, RandIntGHash50000000)
+{
+  randint_ghash_tests("RandInt - GHash - 50000000", 50000000);
+}
+
+TEST(flathash, RandIntFlatHash50000000)
+{
+  randint_flathash_tests("RandInt - FlatHash - 50000000", 50000000);
+}
+#endif
+
+/* Words: string keys from a text, the compare callback is more expensive here. */
+
+static char **words_create(char *data, unsigned int *r_count)
+{
+  unsigned int count = 0;
+  for (char *c = data; *c; c++) {
+    count += ELEM(*c, ' ', '.');
+  }
+  char **words = (char **)MEM_mallocN(sizeof(*words) * (size_t)(count + 1), __func__);
+  unsigned int i = 0;
+  char *w = data;
+  for (char *c = data; *c; c++) {
+    if (ELEM(*c, ' ', '.')) {
+      *c = '\0';
+      words[i++] = w;
+      w = c + 1;
+    }
+  }
+  *r_count = i;
+  return words;
+}
+
+TEST(flathash, TextGHashFlatHash)
+{
+  printf("\n========== STARTING Text - GHash vs FlatHash ==========\n");
+
+  char *data = BLI_strdup(words10k);
+  unsigned int count;
+  char **words = words_create(data, &count);
+
+  {
+    GHash *ghash = BLI_ghash_str_new(__func__);
+    TIMEIT_START(ghash_string_insert);
+    for (unsigned int i = 0; i < count; i++) {
+      BLI_ghash_reinsert(ghash, words[i], words[i], NULL, NULL);
+    }
+    TIMEIT_END(ghash_string_insert);
+    TIMEIT_START(ghash_string_lookup);
+    for (unsigned int i = 0; i < count; i++) {
+      EXPECT_TRUE(BLI_ghash_haskey(ghash, words[i]));
+    }
+    TIMEIT_END(ghash_string_lookup);
+    BLI_ghash_free(ghash, nullptr, nullptr);
+  }
+
+  {
+    FlatHash *fh = BLI_flathash_str_new(__func__);
+    TIMEIT_START(flathash_string_insert);
+    for (unsigned int i = 0; i < count; i++) {
+      BLI_flathash_reinsert(fh, words[i], words[i], NULL, NULL);
+    }
+    TIMEIT_END(flathash_string_insert);
+    TIMEIT_START(flathash_string_lookup);
+    for (unsigned int i = 0; i < count; i++) {
+      EXPECT_TRUE(BLI_flathash_haskey(fh, words[i]));
+    }
+    TIMEIT_END(flathash_string_lookup);
+    BLI_flathash_free(fh, nullptr, nullptr);
+  }
+
+  MEM_freeN(words);
+  MEM_freeN(data);
+
+  printf("========== ENDED Text - GHash vs FlatHash ==========\n\n");
+}
+
+/* MultiSmall: create, fill and clear a lot of very small tables
+ * (the common case in operators which build a table per element). */
+
+static void multi_small_tests(const char *id, const unsigned int count, const bool use_flathash)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  RNG *rng = BLI_rng_new(1);
+  unsigned int data[100];
+
+  TIMEIT_START(multi_small);
+  for (unsigned int i = 0; i < count; i++) {
+    const unsigned int len = 1 + (BLI_rng_get_uint(rng) % (!(i % 10) ? 100 : 10));
+    for (unsigned int j = 0; j < len; j++) {
+      data[j] = BLI_rng_get_uint(rng);
+    }
+    if (use_flathash) {
+      FlatHash *fh = BLI_flathash_int_new(__func__);
+      for (unsigned int j = 0; j < len; j++) {
+        BLI_flathash_reinsert(fh, POINTER_FROM_UINT(data[j]), NULL, NULL, NULL);
+      }
+      for (unsigned int j = 0; j < len; j++) {
+        EXPECT_TRUE(BLI_flathash_haskey(fh, POINTER_FROM_UINT(data[j])));
+      }
+      BLI_flathash_free(fh, nullptr, nullptr);
+    }
+    else {
+      GHash *ghash = BLI_ghash_int_new(__func__);
+      for (unsigned int j = 0; j < len; j++) {
+        BLI_ghash_reinsert(ghash, POINTER_FROM_UINT(data[j]), NULL, NULL, NULL);
+      }
+      for (unsigned int j = 0; j < len; j++) {
+        EXPECT_TRUE(BLI_ghash_haskey(ghash, POINTER_FROM_UINT(data[j])));
+      }
+      BLI_ghash_free(ghash, nullptr, nullptr);
+    }
+  }
+  TIMEIT_END(multi_small);
+
+  BLI_rng_free(rng);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(flathash, MultiSmallGHash200000)
+{
+  multi_small_tests("MultiSmall - GHash - 200000", 200000, false);
+}
+
+TEST(flathash, MultiSmallFlatHash200000)
+{
+  multi_small_tests("MultiSmall - FlatHash - 200000", 200000, true);
+}
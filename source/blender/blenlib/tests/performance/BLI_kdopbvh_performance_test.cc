@@ -0,0 +1,246 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_kdopbvh.h"
+#include "BLI_math.h"
+#include "BLI_rand.h"
+#include "BLI_task.hh"
+#include "BLI_utildefines.h"
+#include "PIL_time_utildefines.h"
+
+/* Run the tests on 50 million triangles, this needs more than 10 GB of memory. */
+//#define KDOPBVH_RUN_BIG
+
+#define QUERIES_NUM 1000000
+
+/* Size of the grid in both directions. */
+#define GRID_SIZE 100.0f
+
+namespace blender::tests {
+
+/**
+ * Triangle of a wavy grid with `res * res` quads, which are denser towards one side to get an
+ * uneven distribution like in real meshes. The triangles are computed from their index, so that
+ * large meshes don't need memory besides the tree.
+ */
+static void grid_triangle_get(const int res, const int index, float r_tri[3][3])
+{
+  const int quad = index / 2;
+  const int x = quad % res;
+  const int y = quad / res;
+  const int corners[2][3][2] = {{{0, 0}, {1, 0}, {1, 1}}, {{0, 0}, {1, 1}, {0, 1}}};
+
+  for (int i = 0; i < 3; i++) {
+    float u = float(x + corners[index % 2][i][0]) / float(res);
+    const float v = float(y + corners[index % 2][i][1]) / float(res);
+    u = u * u * u;
+    r_tri[i][0] = u * GRID_SIZE;
+    r_tri[i][1] = v * GRID_SIZE;
+    r_tri[i][2] = sinf(u * 40.0f) * cosf(v * 30.0f) * 3.0f;
+  }
+}
+
+static void grid_raycast_cb(void *userdata, int index, const BVHTreeRay *ray, BVHTreeRayHit *hit)
+{
+  const int res = *static_cast<const int *>(userdata);
+  float tri[3][3];
+  grid_triangle_get(res, index, tri);
+
+  float dist;
+  if (isect_ray_tri_v3(ray->origin, ray->direction, UNPACK3(tri), &dist, nullptr) &&
+      dist < hit->dist) {
+    hit->index = index;
+    hit->dist = dist;
+  }
+}
+
+static void grid_nearest_cb(void *userdata, int index, const float co[3], BVHTreeNearest *nearest)
+{
+  const int res = *static_cast<const int *>(userdata);
+  float tri[3][3];
+  grid_triangle_get(res, index, tri);
+
+  float nearest_co[3];
+  closest_on_tri_to_point_v3(nearest_co, co, UNPACK3(tri));
+  const float dist_sq = len_squared_v3v3(co, nearest_co);
+  if (dist_sq < nearest->dist_sq) {
+    nearest->index = index;
+    nearest->dist_sq = dist_sq;
+    copy_v3_v3(nearest->co, nearest_co);
+  }
+}
+
+static void kdopbvh_grid_tests(const char *id,
+                               const int triangles_num,
+                               const int tree_type,
+                               const int balance_flag)
+{
+  printf("\n========== STARTING %s ==========\n", id);
+
+  const int res = int(sqrtf(float(triangles_num / 2)));
+  BVHTree *tree = BLI_bvhtree_new(res * res * 2, 0.0f, char(tree_type), 6);
+
+  {
+    TIMEIT_START(insert);
+
+    for (int i = 0; i < res * res * 2; i++) {
+      float tri[3][3];
+      grid_triangle_get(res, i, tri);
+      BLI_bvhtree_insert(tree, i, &tri[0][0], 3);
+    }
+
+    TIMEIT_END(insert);
+  }
+
+  {
+    TIMEIT_START(balance);
+
+    BLI_bvhtree_balance_ex(tree, balance_flag);
+
+    TIMEIT_END(balance);
+  }
+
+  /* Rays from above the grid and positions close to its surface. */
+  RNG *rng = BLI_rng_new(0);
+  float(*origins)[3] = (float(*)[3])MEM_malloc_arrayN(QUERIES_NUM, sizeof(float[3]), __func__);
+  float(*directions)[3] = (float(*)[3])MEM_malloc_arrayN(
+      QUERIES_NUM, sizeof(float[3]), __func__);
+  float(*positions)[3] = (float(*)[3])MEM_malloc_arrayN(QUERIES_NUM, sizeof(float[3]), __func__);
+  for (int i = 0; i < QUERIES_NUM; i++) {
+    origins[i][0] = BLI_rng_get_float(rng) * GRID_SIZE;
+    origins[i][1] = BLI_rng_get_float(rng) * GRID_SIZE;
+    origins[i][2] = 10.0f;
+    directions[i][0] = BLI_rng_get_float(rng) - 0.5f;
+    directions[i][1] = BLI_rng_get_float(rng) - 0.5f;
+    directions[i][2] = -1.0f;
+    normalize_v3(directions[i]);
+    positions[i][0] = BLI_rng_get_float(rng) * GRID_SIZE;
+    positions[i][1] = BLI_rng_get_float(rng) * GRID_SIZE;
+    positions[i][2] = BLI_rng_get_float(rng) * 6.0f - 3.0f;
+  }
+
+  BVHTreeRayHit *hits = (BVHTreeRayHit *)MEM_malloc_arrayN(
+      QUERIES_NUM, sizeof(BVHTreeRayHit), __func__);
+  BVHTreeNearest *nearests = (BVHTreeNearest *)MEM_malloc_arrayN(
+      QUERIES_NUM, sizeof(BVHTreeNearest), __func__);
+
+  /* Separate queries are done in parallel like in most callers. */
+  {
+    TIMEIT_START(raycast);
+
+    threading::parallel_for(IndexRange(QUERIES_NUM), 1024, [&](const IndexRange range) {
+      for (const int i : range) {
+        hits[i].index = -1;
+        hits[i].dist = BVH_RAYCAST_DIST_MAX;
+        BLI_bvhtree_ray_cast(
+            tree, origins[i], directions[i], 0.0f, &hits[i], grid_raycast_cb, (void *)&res);
+      }
+    });
+
+    TIMEIT_END(raycast);
+  }
+
+  {
+    TIMEIT_START(raycast_batch);
+
+    for (int i = 0; i < QUERIES_NUM; i++) {
+      hits[i].index = -1;
+      hits[i].dist = BVH_RAYCAST_DIST_MAX;
+    }
+    BLI_bvhtree_ray_cast_batch(tree,
+                               origins,
+                               directions,
+                               QUERIES_NUM,
+                               0.0f,
+                               hits,
+                               grid_raycast_cb,
+                               (void *)&res,
+                               BVH_RAYCAST_DEFAULT);
+
+    TIMEIT_END(raycast_batch);
+
+    int hits_num = 0;
+    for (int i = 0; i < QUERIES_NUM; i++) {
+      hits_num += hits[i].index != -1;
+    }
+    EXPECT_GT(hits_num, 0);
+  }
+
+  {
+    TIMEIT_START(find_nearest);
+
+    threading::parallel_for(IndexRange(QUERIES_NUM), 1024, [&](const IndexRange range) {
+      for (const int i : range) {
+        nearests[i].index = -1;
+        nearests[i].dist_sq = FLT_MAX;
+        BLI_bvhtree_find_nearest(tree, positions[i], &nearests[i], grid_nearest_cb, (void *)&res);
+      }
+    });
+
+    TIMEIT_END(find_nearest);
+  }
+
+  {
+    TIMEIT_START(find_nearest_batch);
+
+    for (int i = 0; i < QUERIES_NUM; i++) {
+      nearests[i].index = -1;
+      nearests[i].dist_sq = FLT_MAX;
+    }
+    BLI_bvhtree_find_nearest_batch(
+        tree, positions, QUERIES_NUM, nearests, grid_nearest_cb, (void *)&res, 0);
+
+    TIMEIT_END(find_nearest_batch);
+
+    for (int i = 0; i < QUERIES_NUM; i++) {
+      EXPECT_NE(nearests[i].index, -1);
+    }
+  }
+
+  MEM_freeN(origins);
+  MEM_freeN(directions);
+  MEM_freeN(positions);
+  MEM_freeN(hits);
+  MEM_freeN(nearests);
+  BLI_rng_free(rng);
+  BLI_bvhtree_free(tree);
+
+  printf("========== ENDED %s ==========\n\n", id);
+}
+
+TEST(kdopbvh, Median1000000)
+{
+  kdopbvh_grid_tests("KDOPBVH - Median - 1000000", 1000000, 4, 0);
+}
+
+TEST(kdopbvh, SAH1000000)
+{
+  kdopbvh_grid_tests("KDOPBVH - SAH - 1000000", 1000000, 4, BVH_BALANCE_SAH);
+}
+
+TEST(kdopbvh, Median10000000)
+{
+  kdopbvh_grid_tests("KDOPBVH - Median - 10000000", 10000000, 4, 0);
+}
+
+TEST(kdopbvh, SAH10000000)
+{
+  kdopbvh_grid_tests("KDOPBVH - SAH - 10000000", 10000000, 4, BVH_BALANCE_SAH);
+}
+
+#ifdef KDOPBVH_RUN_BIG
+TEST(kdopbvh, Median50000000)
+{
+  kdopbvh_grid_tests("KDOPBVH - Median - 50000000", 50000000, 4, 0);
+}
+
+TEST(kdopbvh, SAH50000000)
+{
+  kdopbvh_grid_tests("KDOPBVH - SAH - 50000000", 50000000, 4, BVH_BALANCE_SAH);
+}
+#endif
+
+}  // namespace blender::tests
@@ -20,6 +20,12 @@ typedef struct {
   size_t size;
   /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
   bool is_identical;
+  /**
+   * When true, this chunk doesn't own the memory either, it's shared with a chunk of the previous
+   * #MemFile found by content hash at a different location. Unlike #is_identical this does not
+   * mean that the data at this location is unchanged.
+   */
+  bool is_identical_moved;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
    * Defined when writing the next step (i.e. last undo step has those always false). */
@@ -27,6 +33,10 @@ typedef struct {
   /** Session UUID of the ID being currently written (MAIN_ID_SESSION_UUID_UNSET when not writing
    * ID-related data). Used to find matching chunks in previous memundo step. */
   uint id_session_uuid;
+  /** When true, #hash is computed. It's only computed once the chunk is needed for a lookup. */
+  bool has_hash;
+  /** Hash of the chunk content, used to find identical chunks regardless of their position. */
+  uint32_t hash;
 } MemFileChunk;
 
 typedef struct MemFile {
@@ -43,6 +53,11 @@ typedef struct MemFileWriteData {
 
   /** Maps an ID session uuid to its first reference MemFileChunk, if existing. */
   struct GHash *id_session_uuid_mapping;
+  /**
+   * Maps the content hash of reference chunks to the first chunk with that hash.
+   * Only created when the sequential comparison with the reference fails for the first time.
+   */
+  struct GHash *chunk_hash_mapping;
 } MemFileWriteData;
 
 typedef struct MemFileUndoData {
@@ -67,6 +67,48 @@ extern bool BLO_write_file_mem(struct Main *mainvar,
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name BLO Background Write File API
+ *
+ * Saving split in two parts: serializing the #Main database into an in-memory snapshot,
+ * which has to happen on the calling thread, and writing that snapshot to disk
+ * (including compression), which happens in the background.
+ * \{ */
+
+typedef struct BlendFileWriteTask BlendFileWriteTask;
+
+/**
+ * Snapshot `mainvar` and start writing it to `filepath` in a background thread.
+ * Once this returns, `mainvar` may be freely modified again.
+ *
+ * \return The running task, or NULL when the snapshot could not be created.
+ * Must be finished with #BLO_write_file_background_end.
+ */
+extern BlendFileWriteTask *BLO_write_file_background_begin(
+    struct Main *mainvar,
+    const char *filepath,
+    int write_flags,
+    const struct BlendFileWriteParams *params,
+    struct ReportList *reports);
+
+/**
+ * Check whether the file has been written, without blocking.
+ */
+extern bool BLO_write_file_background_is_finished(BlendFileWriteTask *task);
+
+/**
+ * Wait for the background writing to finish and free the task.
+ *
+ * \param mainvar: The database that has been written, only used to validate it after writing
+ * with `--debug-io`. Can be NULL.
+ * \return Success.
+ */
+extern bool BLO_write_file_background_end(BlendFileWriteTask *task,
+                                          struct Main *mainvar,
+                                          struct ReportList *reports);
+
+/** \} */
+
 #ifdef __cplusplus
 }
 #endif
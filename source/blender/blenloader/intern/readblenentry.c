@@ -49,7 +49,7 @@ BlendHandle *BLO_blendhandle_from_file(const char *filepath, BlendFileReadReport
 {
   BlendHandle *bh;
 
-  bh = (BlendHandle *)blo_filedata_from_file(filepath, reports);
+  bh = (BlendHandle *)blo_filedata_from_file(filepath, reports, false);
 
   return bh;
 }
@@ -110,6 +110,25 @@ LinkNode *BLO_blendhandle_get_datablock_names(BlendHandle *bh,
   BHead *bhead;
   int tot = 0;
 
+  if (fd->id_index != NULL) {
+    /* Avoid reading all blocks when the file has an ID index. */
+    const BlendIDIndexEntry *entries = BLEND_ID_INDEX_ENTRIES(fd->id_index);
+    for (int i = 0; i < fd->id_index->entries_num; i++) {
+      const BlendIDIndexEntry *entry = &entries[i];
+      if (entry->code != ofblocktype) {
+        continue;
+      }
+      if (use_assets_only && (entry->flag & BLEND_ID_INDEX_IS_ASSET) == 0) {
+        continue;
+      }
+      BLI_linklist_prepend(&names, BLI_strdup(entry->name + 2));
+      tot++;
+    }
+
+    *r_tot_names = tot;
+    return names;
+  }
+
   for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
     if (bhead->code == ofblocktype) {
       const char *idname = blo_bhead_id_name(fd, bhead);
@@ -358,7 +377,7 @@ BlendFileData *BLO_read_from_file(const char *filepath,
   BlendFileData *bfd = NULL;
   FileData *fd;
 
-  fd = blo_filedata_from_file(filepath, reports);
+  fd = blo_filedata_from_file(filepath, reports, true);
   if (fd) {
     fd->skip_flags = skip_flags;
     bfd = blo_read_file_internal(fd, filepath);
@@ -165,6 +165,13 @@
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
+/**
+ * Decompress all frames of seekable `Zstd` files up-front using multiple threads,
+ * instead of decompressing each frame on demand while walking the #BHead list.
+ * Only used when the whole file is read, see #blo_filedata_from_file.
+ */
+#define USE_ZSTD_THREADED_DECOMPRESS
+
 /** Use #GHash for #BHead name-based lookups (speeds up linking). */
 #define USE_GHASH_BHEAD
 
@@ -188,6 +195,11 @@ typedef struct BHeadN {
   /** When set, the remainder of this allocation is the data, otherwise it needs to be read. */
   bool has_data;
 #endif
+  /**
+   * Offset of the block in the file. Blocks read through the ID index are inserted out of order,
+   * this is used to find the blocks between them that still have to be read.
+   */
+  off64_t bhead_file_offset;
   bool is_memchunk_identical;
   struct BHead bhead;
 } BHeadN;
@@ -540,9 +552,11 @@ static void read_file_version(FileData *fd, Main *main)
         main->minsubversionfile = fg->minsubversion;
         MEM_freeN(fg);
       }
-      else if (bhead->code == ENDB) {
-        break;
-      }
+      /* There is only one global block, no need to read the rest of the file. */
+      break;
+    }
+    if (bhead->code == ENDB) {
+      break;
     }
   }
   if (main->curlib) {
@@ -749,13 +763,18 @@ static void bh8_from_bh4(BHead *bhead, BHead4 *bhead4)
   }
 }
 
-static BHeadN *get_bhead(FileData *fd)
+/**
+ * Read the block at the current offset of the file and insert it after \a prev_bhead,
+ * or at the start of the list when it's NULL.
+ */
+static BHeadN *get_bhead(FileData *fd, BHeadN *prev_bhead)
 {
   BHeadN *new_bhead = NULL;
   ssize_t readsize;
 
   if (fd) {
     if (!fd->is_eof) {
+      const off64_t bhead_file_offset = fd->file->offset;
       /* initializing to zero isn't strictly needed but shuts valgrind up
        * since uninitialized memory gets compared */
       BHead8 bhead8 = {0};
@@ -835,6 +854,7 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->next = new_bhead->prev = NULL;
           new_bhead->file_offset = fd->file->offset;
           new_bhead->has_data = false;
+          new_bhead->bhead_file_offset = bhead_file_offset;
           new_bhead->is_memchunk_identical = false;
           new_bhead->bhead = bhead;
           off64_t seek_new = fd->file->seek(fd->file, bhead.len, SEEK_CUR);
@@ -858,6 +878,7 @@ static BHeadN *get_bhead(FileData *fd)
           new_bhead->file_offset = 0; /* don't seek. */
           new_bhead->has_data = true;
 #endif
+          new_bhead->bhead_file_offset = bhead_file_offset;
           new_bhead->is_memchunk_identical = false;
           new_bhead->bhead = bhead;
 
@@ -884,12 +905,70 @@ static BHeadN *get_bhead(FileData *fd)
    * of blocks.
    */
   if (new_bhead) {
-    BLI_addtail(&fd->bhead_list, new_bhead);
+    BLI_insertlinkafter(&fd->bhead_list, prev_bhead, new_bhead);
+
+    if (fd->id_index_bhead_hash != NULL && blo_bhead_is_id(&new_bhead->bhead)) {
+      void **entry;
+      if (!BLI_ghash_ensure_p(
+              fd->id_index_bhead_hash, (void *)new_bhead->bhead.old, &entry)) {
+        *entry = &new_bhead->bhead;
+      }
+    }
   }
 
   return new_bhead;
 }
 
+/** Offset in the file right after the block and its data. */
+static off64_t blo_bhead_file_offset_end(const FileData *fd, const BHeadN *bheadn)
+{
+  const size_t bhead_size = (fd->flags & FD_FLAGS_FILE_POINTSIZE_IS_4) ? sizeof(BHead4) :
+                                                                        sizeof(BHead8);
+  return bheadn->bhead_file_offset + (off64_t)bhead_size + bheadn->bhead.len;
+}
+
+/**
+ * Read the block at \a offset and insert it after \a prev_bhead, which may be followed by
+ * blocks that have been read already when blocks were read through the ID index.
+ */
+static BHeadN *get_bhead_at(FileData *fd, BHeadN *prev_bhead, const off64_t offset)
+{
+  if (fd->file->offset != offset && fd->file->seek(fd->file, offset, SEEK_SET) == -1) {
+    return NULL;
+  }
+  const BHeadN *next_bhead = prev_bhead ? prev_bhead->next : fd->bhead_list.first;
+  if (next_bhead == NULL) {
+    return get_bhead(fd, prev_bhead);
+  }
+  /* Reaching the end of the file only matters for the last block in the list. */
+  const bool is_eof = fd->is_eof;
+  fd->is_eof = false;
+  BHeadN *new_bhead = get_bhead(fd, prev_bhead);
+  fd->is_eof = is_eof;
+  return new_bhead;
+}
+
+/**
+ * Get the block following \a prev_bhead in the file, or the first block when it's NULL.
+ * Reads it if needed.
+ */
+static BHeadN *blo_bheadn_next(FileData *fd, BHeadN *prev_bhead)
+{
+  BHeadN *next_bhead = prev_bhead ? prev_bhead->next : fd->bhead_list.first;
+  if (fd->id_index == NULL) {
+    /* Blocks are always read in order. */
+    return next_bhead ? next_bhead : get_bhead(fd, prev_bhead);
+  }
+
+  /* Blocks read through the ID index can leave gaps, fill them as they're reached. */
+  const off64_t offset = prev_bhead ? blo_bhead_file_offset_end(fd, prev_bhead) :
+                                      SIZEOFBLENDERHEADER;
+  if (next_bhead != NULL && next_bhead->bhead_file_offset == offset) {
+    return next_bhead;
+  }
+  return get_bhead_at(fd, prev_bhead, offset);
+}
+
 BHead *blo_bhead_first(FileData *fd)
 {
   BHeadN *new_bhead;
@@ -898,10 +977,7 @@ BHead *blo_bhead_first(FileData *fd)
   /* Rewind the file
    * Read in a new block if necessary
    */
-  new_bhead = fd->bhead_list.first;
-  if (new_bhead == NULL) {
-    new_bhead = get_bhead(fd);
-  }
+  new_bhead = blo_bheadn_next(fd, NULL);
 
   if (new_bhead) {
     bhead = &new_bhead->bhead;
@@ -929,10 +1005,7 @@ BHead *blo_bhead_next(FileData *fd, BHead *thisblock)
     new_bhead = BHEADN_FROM_BHEAD(thisblock);
 
     /* get the next BHeadN. If it doesn't exist we read in the next one */
-    new_bhead = new_bhead->next;
-    if (new_bhead == NULL) {
-      new_bhead = get_bhead(fd);
-    }
+    new_bhead = blo_bheadn_next(fd, new_bhead);
   }
 
   if (new_bhead) {
@@ -997,6 +1070,205 @@ AssetMetaData *blo_bhead_id_asset_data_address(const FileData *fd, const BHead *
              NULL;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name ID Index
+ *
+ * See #BlendIDIndexHeader, the index allows to find the DNA and ID blocks without
+ * reading all the #BHead's before them.
+ * \{ */
+
+static void blo_id_index_read(FileData *fd)
+{
+  BLI_assert(fd->id_index == NULL);
+
+  /* The index is stored in native endianness and pointer size, and it needs random access. */
+  if (fd->file->seek == NULL ||
+      (fd->flags & (FD_FLAGS_SWITCH_ENDIAN | FD_FLAGS_POINTSIZE_DIFFERS | FD_FLAGS_IS_MEMFILE))) {
+    return;
+  }
+
+  const off64_t offset_backup = fd->file->offset;
+
+  /* The index block is directly followed by the #ENDB block. */
+  BlendIDIndexFooter footer;
+  if (fd->file->seek(fd->file, -(off64_t)(sizeof(BHead) + sizeof(footer)), SEEK_END) == -1 ||
+      fd->file->read(fd->file, &footer, sizeof(footer)) != sizeof(footer) ||
+      memcmp(footer.magic, BLEND_ID_INDEX_MAGIC, BLEND_ID_INDEX_MAGIC_LEN) != 0 ||
+      footer.block_size < sizeof(BHead) + sizeof(BlendIDIndexHeader) + sizeof(footer)) {
+    fd->file->seek(fd->file, offset_backup, SEEK_SET);
+    return;
+  }
+
+  BHead bhead;
+  BlendIDIndexHeader *header = NULL;
+  if (fd->file->seek(fd->file, -(off64_t)(sizeof(BHead) + footer.block_size), SEEK_END) != -1 &&
+      fd->file->read(fd->file, &bhead, sizeof(bhead)) == sizeof(bhead) && bhead.code == DATA &&
+      (uint64_t)bhead.len + sizeof(BHead) == footer.block_size) {
+    header = MEM_mallocN((size_t)bhead.len, __func__);
+    if (fd->file->read(fd->file, header, (size_t)bhead.len) != bhead.len ||
+        memcmp(header->magic, BLEND_ID_INDEX_MAGIC, BLEND_ID_INDEX_MAGIC_LEN) != 0 ||
+        sizeof(*header) + sizeof(BlendIDIndexEntry) * (size_t)header->entries_num +
+                sizeof(footer) !=
+            (size_t)bhead.len) {
+      MEM_freeN(header);
+      header = NULL;
+    }
+  }
+
+  fd->file->seek(fd->file, offset_backup, SEEK_SET);
+
+  if (header != NULL) {
+    fd->id_index = header;
+    fd->id_index_bhead_hash = BLI_ghash_ptr_new_ex(__func__, (uint)header->entries_num);
+  }
+}
+
+/**
+ * Look up an ID by its full name (including the ID code).
+ * \return NULL when the file has no index or doesn't contain such an ID.
+ */
+static const BlendIDIndexEntry *blo_id_index_lookup_name(FileData *fd, const char *idname)
+{
+  if (fd->id_index == NULL) {
+    return NULL;
+  }
+  if (fd->id_index_name_hash == NULL) {
+    const int entries_num = fd->id_index->entries_num;
+    const BlendIDIndexEntry *entries = BLEND_ID_INDEX_ENTRIES(fd->id_index);
+    fd->id_index_name_hash = BLI_ghash_str_new_ex(__func__, (uint)entries_num);
+    for (int i = 0; i < entries_num; i++) {
+      BLI_ghash_insert(fd->id_index_name_hash, (void *)entries[i].name, (void *)&entries[i]);
+    }
+  }
+  return BLI_ghash_lookup(fd->id_index_name_hash, idname);
+}
+
+static const BlendIDIndexEntry *blo_id_index_lookup_old(FileData *fd, const void *old)
+{
+  if (fd->id_index == NULL) {
+    return NULL;
+  }
+  if (fd->id_index_old_hash == NULL) {
+    const int entries_num = fd->id_index->entries_num;
+    const BlendIDIndexEntry *entries = BLEND_ID_INDEX_ENTRIES(fd->id_index);
+    fd->id_index_old_hash = BLI_ghash_ptr_new_ex(__func__, (uint)entries_num);
+    for (int i = 0; i < entries_num; i++) {
+      BLI_ghash_insert(fd->id_index_old_hash,
+                       (void *)(uintptr_t)entries[i].old_address,
+                       (void *)&entries[i]);
+    }
+  }
+  return BLI_ghash_lookup(fd->id_index_old_hash, old);
+}
+
+/**
+ * Read the #BHead of an indexed ID at the offset stored in the index. The blocks before it are
+ * only read once they're needed, see #blo_bheadn_next.
+ */
+static BHead *blo_id_index_bhead_read(FileData *fd, const BlendIDIndexEntry *entry)
+{
+  const void *old = (const void *)(uintptr_t)entry->old_address;
+  const off64_t offset = (off64_t)entry->bhead_offset;
+  if (offset < SIZEOFBLENDERHEADER) {
+    return NULL;
+  }
+
+  /* Find the blocks read already around the ID, it has to fit in between them. */
+  BHeadN *prev_bhead = fd->bhead_list.last;
+  while (prev_bhead != NULL && prev_bhead->bhead_file_offset >= offset) {
+    prev_bhead = prev_bhead->prev;
+  }
+  const BHeadN *next_bhead = prev_bhead ? prev_bhead->next : fd->bhead_list.first;
+  if ((prev_bhead != NULL && blo_bhead_file_offset_end(fd, prev_bhead) > offset) ||
+      (next_bhead != NULL && next_bhead->bhead_file_offset == offset)) {
+    return NULL;
+  }
+
+  /* Check the #BHead before adding it to the list, so a wrong offset can't add garbage. The
+   * index is only used when the file has native endianness and pointer size. */
+  BHead bhead;
+  if (fd->file->seek(fd->file, offset, SEEK_SET) == -1 ||
+      fd->file->read(fd->file, &bhead, sizeof(bhead)) != sizeof(bhead) ||
+      bhead.code != entry->code || bhead.old != old || bhead.len <= 0 ||
+      (next_bhead != NULL &&
+       offset + (off64_t)sizeof(bhead) + bhead.len > next_bhead->bhead_file_offset)) {
+    return NULL;
+  }
+
+  BHeadN *new_bhead = get_bhead_at(fd, prev_bhead, offset);
+  if (new_bhead == NULL) {
+    return NULL;
+  }
+  if (!STREQ(blo_bhead_id_name(fd, &new_bhead->bhead), entry->name)) {
+    BLI_ghash_remove(fd->id_index_bhead_hash, old, NULL, NULL);
+    BLI_remlink(&fd->bhead_list, new_bhead);
+    MEM_freeN(new_bhead);
+    return NULL;
+  }
+  return &new_bhead->bhead;
+}
+
+/**
+ * Get the #BHead of an indexed ID, reading it directly if needed.
+ * \return NULL when the index doesn't match the file content.
+ */
+static BHead *blo_id_index_bhead_ensure(FileData *fd, const BlendIDIndexEntry *entry)
+{
+  const void *old = (const void *)(uintptr_t)entry->old_address;
+
+  BHead *bhead = BLI_ghash_lookup(fd->id_index_bhead_hash, old);
+  if (bhead == NULL) {
+    bhead = blo_id_index_bhead_read(fd, entry);
+  }
+
+  if (bhead == NULL || bhead->old != old || bhead->code != entry->code ||
+      !STREQ(blo_bhead_id_name(fd, bhead), entry->name)) {
+    return NULL;
+  }
+  return bhead;
+}
+
+/**
+ * Read the #DNA1 block using the offset stored in the ID index,
+ * without going through the #BHead list.
+ */
+static void *blo_id_index_read_dna(FileData *fd, int *r_len)
+{
+  const off64_t offset_backup = fd->file->offset;
+  void *data = NULL;
+
+  BHead bhead;
+  if (fd->file->seek(fd->file, (off64_t)fd->id_index->dna_bhead_offset, SEEK_SET) != -1 &&
+      fd->file->read(fd->file, &bhead, sizeof(bhead)) == sizeof(bhead) && bhead.code == DNA1 &&
+      bhead.len > 0) {
+    data = MEM_mallocN((size_t)bhead.len, __func__);
+    if (fd->file->read(fd->file, data, (size_t)bhead.len) != bhead.len) {
+      MEM_freeN(data);
+      data = NULL;
+    }
+    *r_len = bhead.len;
+  }
+
+  fd->file->seek(fd->file, offset_backup, SEEK_SET);
+  return data;
+}
+
+static void blo_id_index_free(FileData *fd)
+{
+  if (fd->id_index_name_hash) {
+    BLI_ghash_free(fd->id_index_name_hash, NULL, NULL);
+  }
+  if (fd->id_index_old_hash) {
+    BLI_ghash_free(fd->id_index_old_hash, NULL, NULL);
+  }
+  if (fd->id_index_bhead_hash) {
+    BLI_ghash_free(fd->id_index_bhead_hash, NULL, NULL);
+  }
+  MEM_SAFE_FREE(fd->id_index);
+}
+
+/** \} */
+
 static void decode_blender_header(FileData *fd)
 {
   char header[SIZEOFBLENDERHEADER], num[4];
@@ -1037,6 +1309,31 @@ static void decode_blender_header(FileData *fd)
   }
 }
 
+static bool read_file_dna_decode(FileData *fd,
+                                 const void *data,
+                                 const int data_len,
+                                 const int subversion,
+                                 const char **r_error_message)
+{
+  const bool do_endian_swap = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
+
+  fd->filesdna = DNA_sdna_from_data(data, data_len, do_endian_swap, true, r_error_message);
+  if (fd->filesdna) {
+    blo_do_versions_dna(fd->filesdna, fd->fileversion, subversion);
+    fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
+    fd->reconstruct_info = DNA_reconstruct_info_create(fd->filesdna, fd->memsdna, fd->compflags);
+    /* used to retrieve ID names from (bhead+1) */
+    fd->id_name_offset = DNA_elem_offset(fd->filesdna, "ID", "char", "name[]");
+    BLI_assert(fd->id_name_offset != -1);
+    fd->id_asset_data_offset = DNA_elem_offset(
+        fd->filesdna, "ID", "AssetMetaData", "*asset_data");
+
+    return true;
+  }
+
+  return false;
+}
+
 /**
  * \return Success if the file is read correctly, else set \a r_error_message.
  */
@@ -1060,27 +1357,21 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
       memcpy(num, fg->subvstr, 4);
       num[4] = 0;
       subversion = atoi(num);
-    }
-    else if (bhead->code == DNA1) {
-      const bool do_endian_swap = (fd->flags & FD_FLAGS_SWITCH_ENDIAN) != 0;
-
-      fd->filesdna = DNA_sdna_from_data(
-          &bhead[1], bhead->len, do_endian_swap, true, r_error_message);
-      if (fd->filesdna) {
-        blo_do_versions_dna(fd->filesdna, fd->fileversion, subversion);
-        fd->compflags = DNA_struct_get_compareflags(fd->filesdna, fd->memsdna);
-        fd->reconstruct_info = DNA_reconstruct_info_create(
-            fd->filesdna, fd->memsdna, fd->compflags);
-        /* used to retrieve ID names from (bhead+1) */
-        fd->id_name_offset = DNA_elem_offset(fd->filesdna, "ID", "char", "name[]");
-        BLI_assert(fd->id_name_offset != -1);
-        fd->id_asset_data_offset = DNA_elem_offset(
-            fd->filesdna, "ID", "AssetMetaData", "*asset_data");
 
-        return true;
+      if (fd->id_index != NULL) {
+        /* The DNA is at the end of the file, avoid reading all blocks before it. */
+        int dna_len;
+        void *dna_data = blo_id_index_read_dna(fd, &dna_len);
+        if (dna_data != NULL) {
+          const bool success = read_file_dna_decode(
+              fd, dna_data, dna_len, subversion, r_error_message);
+          MEM_freeN(dna_data);
+          return success;
+        }
       }
-
-      return false;
+    }
+    else if (bhead->code == DNA1) {
+      return read_file_dna_decode(fd, &bhead[1], bhead->len, subversion, r_error_message);
     }
     else if (bhead->code == ENDB) {
       break;
@@ -1159,6 +1450,8 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
   decode_blender_header(fd);
 
   if (fd->flags & FD_FLAGS_FILE_OK) {
+    blo_id_index_read(fd);
+
     const char *error_message = NULL;
     if (read_file_dna(fd, &error_message) == false) {
       BKE_reportf(
@@ -1179,7 +1472,8 @@ static FileData *blo_decode_and_check(FileData *fd, ReportList *reports)
 
 static FileData *blo_filedata_from_file_descriptor(const char *filepath,
                                                    BlendFileReadReport *reports,
-                                                   int filedes)
+                                                   int filedes,
+                                                   const bool read_whole_file)
 {
   char header[7];
   FileReader *rawfile = BLI_filereader_new_file(filedes);
@@ -1222,7 +1516,15 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
     }
   }
   else if (BLI_file_magic_is_zstd(header)) {
+#ifdef USE_ZSTD_THREADED_DECOMPRESS
+    /* Decompressing everything up-front is wasted work when only some blocks are read, e.g. when
+     * linking from a library, those keep decompressing the frames they need on demand. */
+    file = read_whole_file ? BLI_filereader_new_zstd_threaded(rawfile) :
+                             BLI_filereader_new_zstd(rawfile);
+#else
+    UNUSED_VARS(read_whole_file);
     file = BLI_filereader_new_zstd(rawfile);
+#endif
     if (file != NULL) {
       rawfile = NULL; /* The `Zstd` #FileReader takes ownership of `rawfile`. */
     }
@@ -1243,7 +1545,9 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   return fd;
 }
 
-static FileData *blo_filedata_from_file_open(const char *filepath, BlendFileReadReport *reports)
+static FileData *blo_filedata_from_file_open(const char *filepath,
+                                             BlendFileReadReport *reports,
+                                             const bool read_whole_file)
 {
   errno = 0;
   const int file = BLI_open(filepath, O_BINARY | O_RDONLY, 0);
@@ -1255,12 +1559,14 @@ static FileData *blo_filedata_from_file_open(const char *filepath, BlendFileRead
                 errno ? strerror(errno) : TIP_("unknown error reading file"));
     return NULL;
   }
-  return blo_filedata_from_file_descriptor(filepath, reports, file);
+  return blo_filedata_from_file_descriptor(filepath, reports, file, read_whole_file);
 }
 
-FileData *blo_filedata_from_file(const char *filepath, BlendFileReadReport *reports)
+FileData *blo_filedata_from_file(const char *filepath,
+                                 BlendFileReadReport *reports,
+                                 const bool read_whole_file)
 {
-  FileData *fd = blo_filedata_from_file_open(filepath, reports);
+  FileData *fd = blo_filedata_from_file_open(filepath, reports, read_whole_file);
   if (fd != NULL) {
     /* needed for library_append and read_libraries */
     BLI_strncpy(fd->relabase, filepath, sizeof(fd->relabase));
@@ -1276,7 +1582,8 @@ FileData *blo_filedata_from_file(const char *filepath, BlendFileReadReport *repo
  */
 static FileData *blo_filedata_from_file_minimal(const char *filepath)
 {
-  FileData *fd = blo_filedata_from_file_open(filepath, &(BlendFileReadReport){.reports = NULL});
+  FileData *fd = blo_filedata_from_file_open(
+      filepath, &(BlendFileReadReport){.reports = NULL}, false);
   if (fd != NULL) {
     decode_blender_header(fd);
     if (fd->flags & FD_FLAGS_FILE_OK) {
@@ -1388,6 +1695,8 @@ void blo_filedata_free(FileData *fd)
     }
 #endif
 
+    blo_id_index_free(fd);
+
     MEM_freeN(fd);
   }
 }
@@ -4083,6 +4392,15 @@ static BHead *find_bhead(FileData *fd, void *old)
   }
 
   if (fd->bheadmap == NULL) {
+    /* Local IDs can be found without reading the whole file. */
+    const BlendIDIndexEntry *entry = blo_id_index_lookup_old(fd, old);
+    if (entry != NULL) {
+      BHead *bhead = blo_id_index_bhead_ensure(fd, entry);
+      if (bhead != NULL) {
+        return bhead;
+      }
+    }
+
     sort_bhead_old_map(fd);
   }
 
@@ -4104,6 +4422,36 @@ static BHead *find_bhead(FileData *fd, void *old)
   return NULL;
 }
 
+/**
+ * Find an ID #BHead using the ID index of the file.
+ *
+ * \param r_found: Set when the file has a usable index, in which case the result can be
+ * trusted, even when NULL.
+ */
+static BHead *find_bhead_from_idname_index(FileData *fd, const char *idname, bool *r_found)
+{
+  *r_found = false;
+  if (fd->id_index == NULL) {
+    return NULL;
+  }
+
+  const BlendIDIndexEntry *entry = blo_id_index_lookup_name(fd, idname);
+  if (entry == NULL) {
+    /* Not a local ID of this file. */
+    *r_found = true;
+    return NULL;
+  }
+  if (!BKE_idtype_idcode_is_linkable((short)entry->code)) {
+    /* Match #read_file_bhead_idname_map_create. */
+    *r_found = true;
+    return NULL;
+  }
+
+  BHead *bhead = blo_id_index_bhead_ensure(fd, entry);
+  *r_found = (bhead != NULL);
+  return bhead;
+}
+
 static BHead *find_bhead_from_code_name(FileData *fd, const short idcode, const char *name)
 {
 #ifdef USE_GHASH_BHEAD
@@ -4113,7 +4461,7 @@ static BHead *find_bhead_from_code_name(FileData *fd, const short idcode, const
   *((short *)idname_full) = idcode;
   BLI_strncpy(idname_full + 2, name, sizeof(idname_full) - 2);
 
-  return BLI_ghash_lookup(fd->bhead_idname_hash, idname_full);
+  return find_bhead_from_idname(fd, idname_full);
 
 #else
   BHead *bhead;
@@ -4137,6 +4485,15 @@ static BHead *find_bhead_from_code_name(FileData *fd, const short idcode, const
 static BHead *find_bhead_from_idname(FileData *fd, const char *idname)
 {
 #ifdef USE_GHASH_BHEAD
+  if (fd->bhead_idname_hash == NULL) {
+    bool found;
+    BHead *bhead = find_bhead_from_idname_index(fd, idname, &found);
+    if (found) {
+      return bhead;
+    }
+    /* No usable index, fall back to reading all blocks. */
+    read_file_bhead_idname_map_create(fd);
+  }
   return BLI_ghash_lookup(fd->bhead_idname_hash, idname);
 #else
   return find_bhead_from_code_name(fd, GS(idname), idname + 2);
@@ -4454,7 +4811,10 @@ static Main *library_link_begin(Main *mainvar,
   mainl->versionfile = (*fd)->fileversion;
   read_file_version(*fd, mainl);
 #ifdef USE_GHASH_BHEAD
-  read_file_bhead_idname_map_create(*fd);
+  if ((*fd)->id_index == NULL) {
+    read_file_bhead_idname_map_create(*fd);
+  }
+  /* Otherwise IDs are looked up in the ID index, see #find_bhead_from_idname. */
 #endif
 
   return mainl;
@@ -4804,7 +5164,7 @@ static FileData *read_library_file_data(FileData *basefd,
                      mainptr->curlib->filepath_abs,
                      mainptr->curlib->filepath,
                      library_parent_filepath(mainptr->curlib));
-    fd = blo_filedata_from_file(mainptr->curlib->filepath_abs, basefd->reports);
+    fd = blo_filedata_from_file(mainptr->curlib->filepath_abs, basefd->reports, false);
   }
 
   if (fd) {
@@ -4828,7 +5188,10 @@ static FileData *read_library_file_data(FileData *basefd,
     /* subversion */
     read_file_version(fd, mainptr);
 #ifdef USE_GHASH_BHEAD
-    read_file_bhead_idname_map_create(fd);
+    if (fd->id_index == NULL) {
+      read_file_bhead_idname_map_create(fd);
+    }
+    /* Otherwise IDs are looked up in the ID index, see #find_bhead_from_idname. */
 #endif
   }
   else {
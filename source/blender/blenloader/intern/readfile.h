@@ -44,6 +44,56 @@ enum eFileDataFlag {
 #  pragma GCC poison off_t
 #endif
 
+/* -------------------------------------------------------------------- */
+/** \name ID Index
+ *
+ * Regular (non-undo) files end with a #DATA block placed after #DNA1, that lists the offsets
+ * of all ID blocks and of the #DNA1 block in the (uncompressed) file. Readers that support
+ * seeking use it to find the DNA and to look up IDs by name without walking every #BHead.
+ * Older versions simply skip this block, like any other #DATA block not owned by an ID.
+ *
+ * The data is stored in native endianness and pointer size, it's ignored when those differ.
+ * \{ */
+
+#define BLEND_ID_INDEX_MAGIC "BLIDIDX1"
+#define BLEND_ID_INDEX_MAGIC_LEN 8
+
+enum {
+  BLEND_ID_INDEX_IS_ASSET = 1 << 0,
+};
+
+typedef struct BlendIDIndexHeader {
+  char magic[BLEND_ID_INDEX_MAGIC_LEN];
+  /** Offset of the #DNA1 #BHead. */
+  uint64_t dna_bhead_offset;
+  int entries_num;
+  int _pad;
+  /* Followed by `entries_num` #BlendIDIndexEntry. */
+} BlendIDIndexHeader;
+
+typedef struct BlendIDIndexEntry {
+  /** Offset of the ID's #BHead. */
+  uint64_t bhead_offset;
+  /** Address the ID was written with (#BHead.old). */
+  uint64_t old_address;
+  int code;
+  /** See #BLEND_ID_INDEX_IS_ASSET. */
+  int flag;
+  /** Full ID name (including the ID code), #MAX_ID_NAME padded for alignment. */
+  char name[72];
+} BlendIDIndexEntry;
+
+/** Stored at the very end of the index block, so it can be found from the end of the file. */
+typedef struct BlendIDIndexFooter {
+  /** Size of the whole index block, including its #BHead. */
+  uint64_t block_size;
+  char magic[BLEND_ID_INDEX_MAGIC_LEN];
+} BlendIDIndexFooter;
+
+#define BLEND_ID_INDEX_ENTRIES(header) ((BlendIDIndexEntry *)((header) + 1))
+
+/** \} */
+
 typedef struct FileData {
   /** Linked list of BHeadN's. */
   ListBase bhead_list;
@@ -98,6 +148,15 @@ typedef struct FileData {
   /** See: #USE_GHASH_BHEAD. */
   struct GHash *bhead_idname_hash;
 
+  /** Optional ID index read from the end of the file, NULL when not available. */
+  BlendIDIndexHeader *id_index;
+  /** Maps full ID names to entries of #FileData.id_index, created on first use. */
+  struct GHash *id_index_name_hash;
+  /** Maps old ID addresses to entries of #FileData.id_index, created on first use. */
+  struct GHash *id_index_old_hash;
+  /** Maps old ID addresses to the ID #BHead's read so far, only used with an ID index. */
+  struct GHash *id_index_bhead_hash;
+
   ListBase *mainlist;
   /** Used for undo. */
   ListBase *old_mainlist;
@@ -119,8 +178,13 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath);
  * On each new library added, it now checks for the current #FileData and expands relativeness
  *
  * cannot be called with relative paths anymore!
+ *
+ * \param read_whole_file: All blocks of the file are going to be read, as opposed to only some
+ * of them (e.g. when linking from a library). Compressed files are then decompressed up-front.
  */
-FileData *blo_filedata_from_file(const char *filepath, struct BlendFileReadReport *reports);
+FileData *blo_filedata_from_file(const char *filepath,
+                                 struct BlendFileReadReport *reports,
+                                 bool read_whole_file);
 FileData *blo_filedata_from_memory(const void *mem,
                                    int memsize,
                                    struct BlendFileReadReport *reports);
@@ -25,6 +25,7 @@
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -43,7 +44,7 @@ void BLO_memfile_free(MemFile *memfile)
   MemFileChunk *chunk;
 
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
+    if (chunk->is_identical == false && chunk->is_identical_moved == false) {
       MEM_freeN((void *)chunk->buf);
     }
     MEM_freeN(chunk);
@@ -58,21 +59,27 @@ void BLO_memfile_merge(MemFile *first, MemFile *second)
   GHash *buffer_to_second_memchunk = BLI_ghash_new(
       BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
 
-  /* First, detect all memchunks in second memfile that are not owned by it. */
+  /* First, detect all memchunks in second memfile that are not owned by it.
+   * Several of them may share the same buffer when found by content hash, any one of them can
+   * take over the ownership. */
   for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
+    if (sc->is_identical || sc->is_identical_moved) {
+      void **entry;
+      if (!BLI_ghash_ensure_p(buffer_to_second_memchunk, (void *)sc->buf, &entry)) {
+        *entry = sc;
+      }
     }
   }
 
   /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
    * it is also used by the second memfile, transfer the ownership. */
   for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
+    if (!fc->is_identical && !fc->is_identical_moved) {
       MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
       if (sc != NULL) {
-        BLI_assert(sc->is_identical);
+        BLI_assert(sc->is_identical || sc->is_identical_moved);
         sc->is_identical = false;
+        sc->is_identical_moved = false;
         fc->is_identical = true;
       }
       /* Note that if the second memfile does not use that chunk, we assume that the first one
@@ -100,6 +107,7 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
   mem_data->written_memfile = written_memfile;
   mem_data->reference_memfile = reference_memfile;
   mem_data->reference_current_chunk = reference_memfile ? reference_memfile->chunks.first : NULL;
+  mem_data->chunk_hash_mapping = NULL;
 
   /* If we have a reference memfile, we generate a mapping between the session_uuid's of the
    * IDs stored in that previous undo step, and its first matching memchunk. This will allow
@@ -132,6 +140,58 @@ void BLO_memfile_write_finalize(MemFileWriteData *mem_data)
   if (mem_data->id_session_uuid_mapping != NULL) {
     BLI_ghash_free(mem_data->id_session_uuid_mapping, NULL, NULL);
   }
+  if (mem_data->chunk_hash_mapping != NULL) {
+    BLI_ghash_free(mem_data->chunk_hash_mapping, NULL, NULL);
+  }
+}
+
+static uint32_t memfile_chunk_hash(const char *buf, size_t size)
+{
+  return BLI_hash_mm2((const uchar *)buf, size, 0);
+}
+
+static void memfile_chunk_ensure_hash(MemFileChunk *mem_chunk)
+{
+  if (!mem_chunk->has_hash) {
+    mem_chunk->hash = memfile_chunk_hash(mem_chunk->buf, mem_chunk->size);
+    mem_chunk->has_hash = true;
+  }
+}
+
+/**
+ * Find a chunk of the reference memfile with the same content, wherever it is located.
+ *
+ * This catches data that moved compared to the previous step (re-ordered IDs, or data
+ * following a chunk whose size changed), which the sequential comparison misses.
+ * Only chunks of the reference memfile are considered, so the ownership of shared buffers
+ * keeps being handled by #BLO_memfile_merge. The hashes of the reference chunks are computed
+ * here when they are missing, so steps without changes never hash their chunks.
+ */
+static MemFileChunk *memfile_chunk_find_by_hash(MemFileWriteData *mem_data,
+                                                const char *buf,
+                                                const size_t size,
+                                                const uint32_t hash)
+{
+  BLI_assert(mem_data->reference_memfile != NULL);
+
+  if (mem_data->chunk_hash_mapping == NULL) {
+    mem_data->chunk_hash_mapping = BLI_ghash_int_new(__func__);
+    LISTBASE_FOREACH (MemFileChunk *, mem_chunk, &mem_data->reference_memfile->chunks) {
+      memfile_chunk_ensure_hash(mem_chunk);
+      void **entry;
+      if (!BLI_ghash_ensure_p(
+              mem_data->chunk_hash_mapping, POINTER_FROM_UINT(mem_chunk->hash), &entry)) {
+        *entry = mem_chunk;
+      }
+    }
+  }
+
+  MemFileChunk *mem_chunk = BLI_ghash_lookup(mem_data->chunk_hash_mapping,
+                                             POINTER_FROM_UINT(hash));
+  if (mem_chunk != NULL && mem_chunk->size == size && memcmp(mem_chunk->buf, buf, size) == 0) {
+    return mem_chunk;
+  }
+  return NULL;
 }
 
 void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t size)
@@ -143,11 +203,13 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
   curchunk->size = size;
   curchunk->buf = NULL;
   curchunk->is_identical = false;
+  curchunk->is_identical_moved = false;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
    * will then not be undo. Though it's not entirely clear that is wrong behavior. */
   curchunk->is_identical_future = true;
   curchunk->id_session_uuid = mem_data->current_id_session_uuid;
+  curchunk->has_hash = false;
   BLI_addtail(&memfile->chunks, curchunk);
 
   /* we compare compchunk with buf */
@@ -156,6 +218,8 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     if (compchunk->size == curchunk->size) {
       if (memcmp(compchunk->buf, buf, size) == 0) {
         curchunk->buf = compchunk->buf;
+        curchunk->has_hash = compchunk->has_hash;
+        curchunk->hash = compchunk->hash;
         curchunk->is_identical = true;
         compchunk->is_identical_future = true;
       }
@@ -163,6 +227,21 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, size_t s
     *compchunk_step = compchunk->next;
   }
 
+  /* Not equal to the expected chunk, look for the same content anywhere in the reference. Without
+   * a reference there is nothing to look up, the hash is computed once this memfile is used as
+   * reference. */
+  if (curchunk->buf == NULL && mem_data->reference_memfile != NULL) {
+    curchunk->hash = memfile_chunk_hash(buf, size);
+    curchunk->has_hash = true;
+    MemFileChunk *hashchunk = memfile_chunk_find_by_hash(mem_data, buf, size, curchunk->hash);
+    if (hashchunk != NULL) {
+      curchunk->buf = hashchunk->buf;
+      curchunk->is_identical_moved = true;
+      /* Don't set `hashchunk->is_identical_future`, that flag is used to detect unchanged IDs,
+       * which requires the chunk to also be at the same location in the next step. */
+    }
+  }
+
   /* not equal... */
   if (curchunk->buf == NULL) {
     char *buf_new = MEM_mallocN(size, "Chunk buffer");
@@ -2677,5 +2677,15 @@ void blo_do_versions_300(FileData *fd, Library *UNUSED(lib), Main *bmain)
    */
   {
     /* Keep this block, even when empty. */
+
+    if (!DNA_struct_elem_find(fd->filesdna, "NodesModifierData", "int", "cache_memory_limit")) {
+      LISTBASE_FOREACH (Object *, ob, &bmain->objects) {
+        LISTBASE_FOREACH (ModifierData *, md, &ob->modifiers) {
+          if (md->type == eModifierType_Nodes) {
+            ((NodesModifierData *)md)->cache_memory_limit = 512;
+          }
+        }
+      }
+    }
   }
 }
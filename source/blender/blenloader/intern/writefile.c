@@ -89,9 +89,12 @@
 #include "BLI_linklist.h"
 #include "BLI_math_base.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 #include "MEM_guardedalloc.h" /* MEM_freeN */
 
+#include "atomic_ops.h"
+
 #include "BKE_blender_version.h"
 #include "BKE_bpath.h"
 #include "BKE_global.h" /* for G */
@@ -133,8 +136,11 @@
 
 #define ZSTD_COMPRESSION_LEVEL 3
 
-/** Use if we want to store how many bytes have been written to the file. */
-// #define USE_WRITE_DATA_LEN
+/**
+ * Use if we want to store how many bytes have been written to the file.
+ * Needed to store block offsets in the ID index, see #BlendIDIndexHeader.
+ */
+#define USE_WRITE_DATA_LEN
 
 /* -------------------------------------------------------------------- */
 /** \name Internal Write Wrapper's (Abstracts Compression)
@@ -143,6 +149,8 @@
 typedef enum {
   WW_WRAP_NONE = 1,
   WW_WRAP_ZSTD,
+  /** Write into a #MemFile, used to snapshot a file that is written to disk later. */
+  WW_WRAP_MEMFILE,
 } eWriteWrapType;
 
 typedef struct ZstdFrame {
@@ -177,6 +185,9 @@ struct WriteWrap {
 
     bool write_error;
   } zstd;
+  struct {
+    MemFileWriteData mem_data;
+  } memfile;
 };
 
 /* none */
@@ -360,6 +371,26 @@ static size_t ww_write_zstd(WriteWrap *ww, const char *buf, size_t buf_len)
   return buf_len;
 }
 
+/* memfile */
+
+static bool ww_open_memfile(WriteWrap *UNUSED(ww), const char *UNUSED(filepath))
+{
+  /* The #MemFile is set up by the caller, see #ww_handle_init_memfile. */
+  return true;
+}
+
+static bool ww_close_memfile(WriteWrap *ww)
+{
+  BLO_memfile_write_finalize(&ww->memfile.mem_data);
+  return true;
+}
+
+static size_t ww_write_memfile(WriteWrap *ww, const char *buf, size_t buf_len)
+{
+  BLO_memfile_chunk_add(&ww->memfile.mem_data, buf, buf_len);
+  return buf_len;
+}
+
 /* --- end compression types --- */
 
 static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
@@ -374,6 +405,13 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
       r_ww->use_buf = true;
       break;
     }
+    case WW_WRAP_MEMFILE: {
+      r_ww->open = ww_open_memfile;
+      r_ww->close = ww_close_memfile;
+      r_ww->write = ww_write_memfile;
+      r_ww->use_buf = true;
+      break;
+    }
     default: {
       r_ww->open = ww_open_none;
       r_ww->close = ww_close_none;
@@ -384,6 +422,13 @@ static void ww_handle_init(eWriteWrapType ww_type, WriteWrap *r_ww)
   }
 }
 
+static void ww_handle_init_memfile(MemFile *memfile, WriteWrap *r_ww)
+{
+  ww_handle_init(WW_WRAP_MEMFILE, r_ww);
+  /* No reference, every chunk is a plain copy of the written data. */
+  BLO_memfile_write_init(&r_ww->memfile.mem_data, memfile, NULL);
+}
+
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -413,6 +458,15 @@ typedef struct {
   /** Set on unlikely case of an error (ignores further file writing). */
   bool error;
 
+  /** ID index written at the end of regular files, see #BlendIDIndexHeader. */
+  struct {
+    BlendIDIndexEntry *entries;
+    int entries_num;
+    int entries_len_alloc;
+    /** Offset of the #BHead of the ID being written, -1 when not written yet. */
+    int64_t id_bhead_offset;
+  } id_index;
+
   /** #MemFile writing (used for undo). */
   MemFileWriteData mem;
   /** When true, write to #WriteData.current, could also call 'is_undo'. */
@@ -484,6 +538,7 @@ static void writedata_free(WriteData *wd)
   if (wd->buffer.buf) {
     MEM_freeN(wd->buffer.buf);
   }
+  MEM_SAFE_FREE(wd->id_index.entries);
   MEM_freeN(wd);
 }
 
@@ -674,6 +729,11 @@ static void writestruct_at_address_nr(
     return;
   }
 
+  if (filecode <= 0xFFFF && wd->id_index.id_bhead_offset == -1) {
+    /* First ID block written for the current ID, remember where it starts for the ID index. */
+    wd->id_index.id_bhead_offset = (int64_t)wd->write_len;
+  }
+
   mywrite(wd, &bh, sizeof(BHead));
   mywrite(wd, data, (size_t)bh.len);
 }
@@ -1066,6 +1126,62 @@ static void write_thumb(WriteData *wd, const BlendThumbnail *thumb)
 
 /** \} */
 
+/* -------------------------------------------------------------------- */
+/** \name ID Index Writing
+ * \{ */
+
+static void write_id_index_add(WriteData *wd, const ID *id)
+{
+  if (wd->id_index.id_bhead_offset == -1) {
+    /* The ID block itself was not written. */
+    return;
+  }
+
+  if (wd->id_index.entries_num == wd->id_index.entries_len_alloc) {
+    wd->id_index.entries_len_alloc = max_ii(256, wd->id_index.entries_len_alloc * 2);
+    wd->id_index.entries = MEM_reallocN(
+        wd->id_index.entries, sizeof(BlendIDIndexEntry) * (size_t)wd->id_index.entries_len_alloc);
+  }
+
+  BlendIDIndexEntry *entry = &wd->id_index.entries[wd->id_index.entries_num++];
+  memset(entry, 0, sizeof(*entry));
+  entry->bhead_offset = (uint64_t)wd->id_index.id_bhead_offset;
+  entry->old_address = (uint64_t)(uintptr_t)id;
+  entry->code = GS(id->name);
+  entry->flag = ID_IS_ASSET(id) ? BLEND_ID_INDEX_IS_ASSET : 0;
+  BLI_strncpy(entry->name, id->name, sizeof(entry->name));
+}
+
+static void write_id_index(WriteData *wd, const size_t dna_bhead_offset)
+{
+  const size_t entries_size = sizeof(BlendIDIndexEntry) * (size_t)wd->id_index.entries_num;
+  const size_t data_len = sizeof(BlendIDIndexHeader) + entries_size + sizeof(BlendIDIndexFooter);
+  BLI_STATIC_ASSERT((sizeof(BlendIDIndexHeader) % 4) == 0 && (sizeof(BlendIDIndexEntry) % 4) == 0 &&
+                        (sizeof(BlendIDIndexFooter) % 4) == 0,
+                    "ID index data must not be padded by writedata()")
+
+  char *data = MEM_mallocN(data_len, __func__);
+
+  BlendIDIndexHeader *header = (BlendIDIndexHeader *)data;
+  memset(header, 0, sizeof(*header));
+  memcpy(header->magic, BLEND_ID_INDEX_MAGIC, BLEND_ID_INDEX_MAGIC_LEN);
+  header->dna_bhead_offset = dna_bhead_offset;
+  header->entries_num = wd->id_index.entries_num;
+  if (entries_size != 0) {
+    memcpy(BLEND_ID_INDEX_ENTRIES(header), wd->id_index.entries, entries_size);
+  }
+
+  BlendIDIndexFooter *footer = (BlendIDIndexFooter *)(data + data_len - sizeof(*footer));
+  footer->block_size = sizeof(BHead) + data_len;
+  memcpy(footer->magic, BLEND_ID_INDEX_MAGIC, BLEND_ID_INDEX_MAGIC_LEN);
+
+  writedata(wd, DATA, data_len, data);
+
+  MEM_freeN(data);
+}
+
+/** \} */
+
 /* -------------------------------------------------------------------- */
 /** \name File Writing (Private)
  * \{ */
@@ -1197,11 +1313,17 @@ static bool write_file_handle(Main *mainvar,
          * #direct_link_id_common in `readfile.c` anyway, */
         ((ID *)id_buffer)->py_instance = NULL;
 
+        wd->id_index.id_bhead_offset = -1;
+
         const IDTypeInfo *id_type = BKE_idtype_get_info_from_id(id);
         if (id_type->blend_write != NULL) {
           id_type->blend_write(&writer, (ID *)id_buffer, id);
         }
 
+        if (!wd->use_memfile) {
+          write_id_index_add(wd, id);
+        }
+
         if (do_override) {
           BKE_lib_override_library_operations_store_end(override_storage, id);
         }
@@ -1236,8 +1358,14 @@ static bool write_file_handle(Main *mainvar,
    *
    * Note that we *borrow* the pointer to 'DNAstr',
    * so writing each time uses the same address and doesn't cause unnecessary undo overhead. */
+  const size_t dna_bhead_offset = wd->write_len;
   writedata(wd, DNA1, (size_t)wd->sdna->data_len, wd->sdna->data);
 
+  if (!wd->use_memfile) {
+    /* Must directly follow DNA and precede ENDB, so it can be found from the end of the file. */
+    write_id_index(wd, dna_bhead_offset);
+  }
+
   /* end of file */
   memset(&bhead, 0, sizeof(BHead));
   bhead.code = ENDB;
@@ -1296,20 +1424,18 @@ static bool do_history(const char *name, ReportList *reports)
 /** \name File Writing (Public)
  * \{ */
 
-bool BLO_write_file(Main *mainvar,
-                    const char *filepath,
-                    const int write_flags,
-                    const struct BlendFileWriteParams *params,
-                    ReportList *reports)
+/**
+ * Write `mainvar` into `ww`, handling the path remapping requested by `params`.
+ *
+ * \return True if write failed.
+ */
+static bool write_file_main(Main *mainvar,
+                            WriteWrap *ww,
+                            const char *filepath,
+                            const int write_flags,
+                            const struct BlendFileWriteParams *params)
 {
-  BLI_assert(!BLI_path_is_rel(filepath));
-  BLI_assert(BLI_path_is_abs_from_cwd(filepath));
-
-  char tempname[FILE_MAX + 1];
-  WriteWrap ww;
-
   eBLO_WritePathRemap remap_mode = params->remap_mode;
-  const bool use_save_versions = params->use_save_versions;
   const bool use_save_as_copy = params->use_save_as_copy;
   const bool use_userdef = params->use_userdef;
   const BlendThumbnail *thumb = params->thumb;
@@ -1320,23 +1446,6 @@ bool BLO_write_file(Main *mainvar,
   const eBPathForeachFlag path_list_flag = (BKE_BPATH_FOREACH_PATH_SKIP_LINKED |
                                             BKE_BPATH_FOREACH_PATH_SKIP_MULTIFILE);
 
-  if (G.debug & G_DEBUG_IO && mainvar->lock != NULL) {
-    BKE_report(reports, RPT_INFO, "Checking sanity of current .blend file *BEFORE* save to disk");
-    BLO_main_validate_libraries(mainvar, reports);
-    BLO_main_validate_shapekeys(mainvar, reports);
-  }
-
-  /* open temporary file, so we preserve the original in case we crash */
-  BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
-
-  ww_handle_init((write_flags & G_FILE_COMPRESS) ? WW_WRAP_ZSTD : WW_WRAP_NONE, &ww);
-
-  if (ww.open(&ww, tempname) == false) {
-    BKE_reportf(
-        reports, RPT_ERROR, "Cannot open file %s for writing: %s", tempname, strerror(errno));
-    return false;
-  }
-
   if (remap_mode == BLO_WRITE_PATH_REMAP_ABSOLUTE) {
     /* Paths will already be absolute, no remapping to do. */
     if (relbase_valid == false) {
@@ -1413,22 +1522,27 @@ bool BLO_write_file(Main *mainvar,
   }
 
   /* actual file writing */
-  const bool err = write_file_handle(mainvar, &ww, NULL, NULL, write_flags, use_userdef, thumb);
-
-  ww.close(&ww);
+  const bool err = write_file_handle(mainvar, ww, NULL, NULL, write_flags, use_userdef, thumb);
 
   if (UNLIKELY(path_list_backup)) {
     BKE_bpath_list_restore(mainvar, path_list_flag, path_list_backup);
     BKE_bpath_list_free(path_list_backup);
   }
 
-  if (err) {
-    BKE_report(reports, RPT_ERROR, strerror(errno));
-    remove(tempname);
-
-    return false;
-  }
+  return err;
+}
 
+/**
+ * Move the successfully written temporary file to its final location,
+ * doing the version backups first when requested.
+ *
+ * \return Success.
+ */
+static bool write_file_finalize(const char *filepath,
+                                const char *tempname,
+                                const bool use_save_versions,
+                                ReportList *reports)
+{
   /* file save to temporary file was successful */
   /* now do reverse file history (move .blend1 -> .blend2, .blend -> .blend1) */
   if (use_save_versions) {
@@ -1444,6 +1558,53 @@ bool BLO_write_file(Main *mainvar,
     return false;
   }
 
+  return true;
+}
+
+bool BLO_write_file(Main *mainvar,
+                    const char *filepath,
+                    const int write_flags,
+                    const struct BlendFileWriteParams *params,
+                    ReportList *reports)
+{
+  BLI_assert(!BLI_path_is_rel(filepath));
+  BLI_assert(BLI_path_is_abs_from_cwd(filepath));
+
+  char tempname[FILE_MAX + 1];
+  WriteWrap ww;
+
+  if (G.debug & G_DEBUG_IO && mainvar->lock != NULL) {
+    BKE_report(reports, RPT_INFO, "Checking sanity of current .blend file *BEFORE* save to disk");
+    BLO_main_validate_libraries(mainvar, reports);
+    BLO_main_validate_shapekeys(mainvar, reports);
+  }
+
+  /* open temporary file, so we preserve the original in case we crash */
+  BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
+
+  ww_handle_init((write_flags & G_FILE_COMPRESS) ? WW_WRAP_ZSTD : WW_WRAP_NONE, &ww);
+
+  if (ww.open(&ww, tempname) == false) {
+    BKE_reportf(
+        reports, RPT_ERROR, "Cannot open file %s for writing: %s", tempname, strerror(errno));
+    return false;
+  }
+
+  const bool err = write_file_main(mainvar, &ww, filepath, write_flags, params);
+
+  ww.close(&ww);
+
+  if (err) {
+    BKE_report(reports, RPT_ERROR, strerror(errno));
+    remove(tempname);
+
+    return false;
+  }
+
+  if (!write_file_finalize(filepath, tempname, params->use_save_versions, reports)) {
+    return false;
+  }
+
   if (G.debug & G_DEBUG_IO && mainvar->lock != NULL) {
     BKE_report(reports, RPT_INFO, "Checking sanity of current .blend file *AFTER* save to disk");
     BLO_main_validate_libraries(mainvar, reports);
@@ -1452,6 +1613,147 @@ bool BLO_write_file(Main *mainvar,
   return true;
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Background File Writing
+ *
+ * The #Main database is serialized into a #MemFile snapshot on the calling thread
+ * (this is a plain memory copy and comparatively cheap), writing the snapshot to disk
+ * including compression then happens on a background thread.
+ * \{ */
+
+struct BlendFileWriteTask {
+  char filepath[FILE_MAX];
+  char tempname[FILE_MAX + 1];
+  int write_flags;
+  bool use_save_versions;
+
+  /** Serialized file content, owned by the task. */
+  MemFile memfile;
+
+  TaskPool *task_pool;
+  /** Reports generated on the background thread, moved to the caller's reports at the end. */
+  ReportList reports;
+  bool success;
+  /** Set once the background thread is done, accessed atomically. */
+  int32_t is_finished;
+};
+
+static void write_file_background_task(TaskPool *__restrict pool, void *UNUSED(taskdata))
+{
+  BlendFileWriteTask *task = BLI_task_pool_user_data(pool);
+  WriteWrap ww;
+
+  ww_handle_init((task->write_flags & G_FILE_COMPRESS) ? WW_WRAP_ZSTD : WW_WRAP_NONE, &ww);
+
+  if (ww.open(&ww, task->tempname) == false) {
+    BKE_reportf(&task->reports,
+                RPT_ERROR,
+                "Cannot open file %s for writing: %s",
+                task->tempname,
+                strerror(errno));
+  }
+  else {
+    bool err = false;
+    LISTBASE_FOREACH (MemFileChunk *, chunk, &task->memfile.chunks) {
+      if (ww.write(&ww, chunk->buf, chunk->size) != chunk->size) {
+        err = true;
+        break;
+      }
+    }
+    if (!ww.close(&ww)) {
+      err = true;
+    }
+
+    if (err) {
+      BKE_report(&task->reports, RPT_ERROR, strerror(errno));
+      remove(task->tempname);
+    }
+    else {
+      task->success = write_file_finalize(
+          task->filepath, task->tempname, task->use_save_versions, &task->reports);
+    }
+  }
+
+  /* The snapshot is not needed anymore, free it as early as possible. */
+  BLO_memfile_free(&task->memfile);
+
+  atomic_add_and_fetch_int32(&task->is_finished, 1);
+}
+
+BlendFileWriteTask *BLO_write_file_background_begin(Main *mainvar,
+                                                    const char *filepath,
+                                                    const int write_flags,
+                                                    const struct BlendFileWriteParams *params,
+                                                    ReportList *reports)
+{
+  BLI_assert(!BLI_path_is_rel(filepath));
+  BLI_assert(BLI_path_is_abs_from_cwd(filepath));
+
+  if (G.debug & G_DEBUG_IO && mainvar->lock != NULL) {
+    BKE_report(reports, RPT_INFO, "Checking sanity of current .blend file *BEFORE* save to disk");
+    BLO_main_validate_libraries(mainvar, reports);
+    BLO_main_validate_shapekeys(mainvar, reports);
+  }
+
+  BlendFileWriteTask *task = MEM_callocN(sizeof(*task), __func__);
+  BLI_strncpy(task->filepath, filepath, sizeof(task->filepath));
+  /* open temporary file, so we preserve the original in case we crash */
+  BLI_snprintf(task->tempname, sizeof(task->tempname), "%s@", filepath);
+  task->write_flags = write_flags;
+  task->use_save_versions = params->use_save_versions;
+  BKE_reports_init(&task->reports, RPT_STORE);
+
+  WriteWrap ww;
+  ww_handle_init_memfile(&task->memfile, &ww);
+
+  const bool err = write_file_main(mainvar, &ww, filepath, write_flags, params);
+
+  ww.close(&ww);
+
+  if (err) {
+    BKE_report(reports, RPT_ERROR, "Failed to create a snapshot of the file for saving");
+    BLO_memfile_free(&task->memfile);
+    BKE_reports_clear(&task->reports);
+    MEM_freeN(task);
+    return NULL;
+  }
+
+  task->task_pool = BLI_task_pool_create_background(task, TASK_PRIORITY_HIGH);
+  BLI_task_pool_push(task->task_pool, write_file_background_task, NULL, false, NULL);
+
+  return task;
+}
+
+bool BLO_write_file_background_is_finished(BlendFileWriteTask *task)
+{
+  return atomic_add_and_fetch_int32(&task->is_finished, 0) != 0;
+}
+
+bool BLO_write_file_background_end(BlendFileWriteTask *task,
+                                   Main *mainvar,
+                                   ReportList *reports)
+{
+  BLI_task_pool_work_and_wait(task->task_pool);
+  BLI_task_pool_free(task->task_pool);
+
+  LISTBASE_FOREACH (Report *, report, &task->reports.list) {
+    BKE_report(reports, report->type, report->message);
+  }
+  BKE_reports_clear(&task->reports);
+
+  const bool success = task->success;
+  MEM_freeN(task);
+
+  if (success && G.debug & G_DEBUG_IO && mainvar != NULL && mainvar->lock != NULL) {
+    BKE_report(reports, RPT_INFO, "Checking sanity of current .blend file *AFTER* save to disk");
+    BLO_main_validate_libraries(mainvar, reports);
+  }
+
+  return success;
+}
+
+/** \} */
+
 bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, int write_flags)
 {
   bool use_userdef = false;
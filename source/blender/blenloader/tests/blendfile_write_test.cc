@@ -0,0 +1,149 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+#include "blendfile_loading_base_test.h"
+
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_main.h"
+
+#include "BLI_fileops.h"
+#include "BLI_linklist.h"
+#include "BLI_listbase.h"
+#include "BLI_path_util.h"
+
+#include "BLO_readfile.h"
+#include "BLO_writefile.h"
+
+#include "DNA_ID.h"
+#include "DNA_object_types.h"
+
+class BlendfileWriteTest : public BlendfileLoadingBaseTest {
+ protected:
+  void SetUp() override
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    BKE_tempdir_init("");
+  }
+
+  std::string temp_filepath(const char *filename)
+  {
+    char filepath[FILE_MAX];
+    BLI_join_dirfile(filepath, sizeof(filepath), BKE_tempdir_session(), filename);
+    return filepath;
+  }
+};
+
+static bool files_are_equal(const char *filepath_a, const char *filepath_b)
+{
+  size_t size_a, size_b;
+  void *data_a = BLI_file_read_binary_as_mem(filepath_a, 0, &size_a);
+  void *data_b = BLI_file_read_binary_as_mem(filepath_b, 0, &size_b);
+  const bool is_equal = data_a != nullptr && data_b != nullptr && size_a == size_b &&
+                        memcmp(data_a, data_b, size_a) == 0;
+  MEM_SAFE_FREE(data_a);
+  MEM_SAFE_FREE(data_b);
+  return is_equal;
+}
+
+TEST_F(BlendfileWriteTest, BackgroundWriteMatchesRegularWrite)
+{
+  if (!blendfile_load("modifier_stack/array_test.blend")) {
+    return;
+  }
+  const std::string regular_filepath = temp_filepath("regular_write.blend");
+  const std::string background_filepath = temp_filepath("background_write.blend");
+  const BlendFileWriteParams params = {BLO_WRITE_PATH_REMAP_NONE};
+
+  ASSERT_TRUE(BLO_write_file(bfile->main, regular_filepath.c_str(), 0, &params, nullptr));
+
+  BlendFileWriteTask *task = BLO_write_file_background_begin(
+      bfile->main, background_filepath.c_str(), 0, &params, nullptr);
+  ASSERT_NE(task, nullptr);
+  /* The database can be used again while the file is written. */
+  EXPECT_FALSE(BLI_listbase_is_empty(&bfile->main->objects));
+  EXPECT_TRUE(BLO_write_file_background_end(task, bfile->main, nullptr));
+
+  EXPECT_TRUE(files_are_equal(regular_filepath.c_str(), background_filepath.c_str()));
+
+  /* The written file can be read again. */
+  BlendFileReadReport bf_reports = {nullptr};
+  BlendFileData *written_bfile = BLO_read_from_file(
+      background_filepath.c_str(), BLO_READ_SKIP_NONE, &bf_reports);
+  ASSERT_NE(written_bfile, nullptr);
+  EXPECT_EQ(BLI_listbase_count(&written_bfile->main->objects),
+            BLI_listbase_count(&bfile->main->objects));
+  BLO_blendfiledata_free(written_bfile);
+
+  BLI_delete(regular_filepath.c_str(), false, false);
+  BLI_delete(background_filepath.c_str(), false, false);
+}
+
+TEST_F(BlendfileWriteTest, BackgroundWriteFailsForInvalidPath)
+{
+  if (!blendfile_load("modifier_stack/array_test.blend")) {
+    return;
+  }
+  const std::string filepath = temp_filepath("missing_directory/background_write.blend");
+  const BlendFileWriteParams params = {BLO_WRITE_PATH_REMAP_NONE};
+
+  BlendFileWriteTask *task = BLO_write_file_background_begin(
+      bfile->main, filepath.c_str(), 0, &params, nullptr);
+  ASSERT_NE(task, nullptr);
+  EXPECT_FALSE(BLO_write_file_background_end(task, bfile->main, nullptr));
+  EXPECT_FALSE(BLI_exists(filepath.c_str()));
+}
+
+TEST_F(BlendfileWriteTest, LinkFromWrittenFile)
+{
+  if (!blendfile_load("modifier_stack/array_test.blend")) {
+    return;
+  }
+  const Object *library_object = static_cast<const Object *>(bfile->main->objects.first);
+  ASSERT_NE(library_object, nullptr);
+  const std::string library_filepath = temp_filepath("library.blend");
+  const std::string user_filepath = temp_filepath("user.blend");
+  const BlendFileWriteParams params = {BLO_WRITE_PATH_REMAP_NONE};
+  ASSERT_TRUE(BLO_write_file(bfile->main, library_filepath.c_str(), 0, &params, nullptr));
+
+  BlendFileReadReport bf_reports = {nullptr};
+  BlendHandle *bh = BLO_blendhandle_from_file(library_filepath.c_str(), &bf_reports);
+  ASSERT_NE(bh, nullptr);
+
+  /* The names are listed from the ID index of the written file. */
+  int names_num;
+  LinkNode *names = BLO_blendhandle_get_datablock_names(bh, ID_OB, false, &names_num);
+  EXPECT_EQ(names_num, BLI_listbase_count(&bfile->main->objects));
+  BLI_linklist_freeN(names);
+
+  Main *bmain = BKE_main_new();
+  LibraryLink_Params link_params;
+  BLO_library_link_params_init(&link_params, bmain, 0, 0);
+  Main *mainl = BLO_library_link_begin(&bh, library_filepath.c_str(), &link_params);
+  ASSERT_NE(mainl, nullptr);
+  ID *id = BLO_library_link_named_part(
+      mainl, &bh, ID_OB, library_object->id.name + 2, &link_params);
+  BLO_library_link_end(mainl, &bh, &link_params);
+  BLO_blendhandle_close(bh);
+  ASSERT_NE(id, nullptr);
+  EXPECT_NE(reinterpret_cast<Object *>(id)->data, nullptr);
+
+  /* Reading a file that links the object reads it from the library again. */
+  EXPECT_TRUE(BLO_write_file(bmain, user_filepath.c_str(), 0, &params, nullptr));
+  BKE_main_free(bmain);
+
+  BlendFileData *user_bfile = BLO_read_from_file(
+      user_filepath.c_str(), BLO_READ_SKIP_NONE, &bf_reports);
+  ASSERT_NE(user_bfile, nullptr);
+  const Object *object = static_cast<const Object *>(
+      BLI_findstring(&user_bfile->main->objects, library_object->id.name, offsetof(ID, name)));
+  ASSERT_NE(object, nullptr);
+  EXPECT_NE(object->id.lib, nullptr);
+  EXPECT_EQ(object->id.tag & LIB_TAG_MISSING, 0);
+  EXPECT_NE(object->data, nullptr);
+  BLO_blendfiledata_free(user_bfile);
+
+  BLI_delete(library_filepath.c_str(), false, false);
+  BLI_delete(user_filepath.c_str(), false, false);
+}
@@ -67,6 +67,18 @@ void DEG_graph_relations_update(struct Depsgraph *graph);
 /** Tag all relations in the database for update. */
 void DEG_relations_tag_update(struct Main *bmain);
 
+/**
+ * Tag relations of the given ID for update in the given graph.
+ *
+ * To be used for changes which only affect relations of this ID (such as adding a constraint or a
+ * driver to an object), which allows to only rebuild nodes and relations of the tagged IDs
+ * instead of the whole graph when possible.
+ */
+void DEG_graph_id_tag_relations_update(struct Depsgraph *graph, struct ID *id);
+
+/** Tag relations of the given ID for update in all graphs of the database. */
+void DEG_id_tag_relations_update(struct Main *bmain, struct ID *id);
+
 /* Add Dependencies  ----------------------------- */
 
 /**
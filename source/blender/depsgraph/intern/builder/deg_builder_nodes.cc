@@ -332,38 +332,14 @@ void DepsgraphNodeBuilder::begin_build()
   /* Store existing copy-on-write versions of datablock, so we can re-use
    * them for new ID nodes. */
   for (IDNode *id_node : graph_->id_nodes) {
-    /* It is possible that the ID does not need to have CoW version in which case id_cow is the
-     * same as id_orig. Additionally, such ID might have been removed, which makes the check
-     * for whether id_cow is expanded to access freed memory. In order to deal with this we
-     * check whether CoW is needed based on a scalar value which does not lead to access of
-     * possibly deleted memory. */
-    IDInfo *id_info = (IDInfo *)MEM_mallocN(sizeof(IDInfo), "depsgraph id info");
-    if (deg_copy_on_write_is_needed(id_node->id_type) &&
-        deg_copy_on_write_is_expanded(id_node->id_cow) && id_node->id_orig != id_node->id_cow) {
-      id_info->id_cow = id_node->id_cow;
-    }
-    else {
-      id_info->id_cow = nullptr;
-    }
-    id_info->previously_visible_components_mask = id_node->visible_components_mask;
-    id_info->previous_eval_flags = id_node->eval_flags;
-    id_info->previous_customdata_masks = id_node->customdata_masks;
-    BLI_assert(!id_info_hash_.contains(id_node->id_orig_session_uuid));
-    id_info_hash_.add_new(id_node->id_orig_session_uuid, id_info);
-    id_node->id_cow = nullptr;
+    save_id_info(id_node);
   }
 
   for (OperationNode *op_node : graph_->entry_tags) {
-    ComponentNode *comp_node = op_node->owner;
-    IDNode *id_node = comp_node->owner;
-
-    SavedEntryTag entry_tag;
-    entry_tag.id_orig = id_node->id_orig;
-    entry_tag.component_type = comp_node->type;
-    entry_tag.opcode = op_node->opcode;
-    entry_tag.name = op_node->name;
-    entry_tag.name_tag = op_node->name_tag;
-    saved_entry_tags_.append(entry_tag);
+    save_entry_tag(op_node);
+  }
+  for (OperationNode *op_node : graph_->operations) {
+    save_operation_time(op_node);
   }
 
   /* Make sure graph has no nodes left from previous state. */
@@ -372,6 +348,100 @@ void DepsgraphNodeBuilder::begin_build()
   graph_->entry_tags.clear();
 }
 
+void DepsgraphNodeBuilder::begin_build_incremental(Scene *scene,
+                                                   ViewLayer *view_layer,
+                                                   Span<IDNode *> id_nodes)
+{
+  /* Setup the same context as #build_view_layer. */
+  view_layer_index_ = 0;
+  scene_ = scene;
+  view_layer_ = view_layer;
+
+  Set<IDNode *> rebuild_id_nodes;
+  for (IDNode *id_node : id_nodes) {
+    save_id_info(id_node);
+    rebuild_id_nodes.add(id_node);
+  }
+  for (OperationNode *op_node : graph_->entry_tags) {
+    if (rebuild_id_nodes.contains(op_node->owner->owner)) {
+      save_entry_tag(op_node);
+    }
+  }
+  for (OperationNode *op_node : graph_->operations) {
+    if (rebuild_id_nodes.contains(op_node->owner->owner)) {
+      save_operation_time(op_node);
+    }
+  }
+  for (IDNode *id_node : graph_->id_nodes) {
+    if (rebuild_id_nodes.contains(id_node)) {
+      continue;
+    }
+    built_map_.tagBuild(id_node->id_orig);
+    /* Nodes which are kept compare against their current state when finalizing the build. */
+    id_node->previously_visible_components_mask = id_node->visible_components_mask;
+    id_node->previous_eval_flags = id_node->eval_flags;
+    id_node->previous_customdata_masks = id_node->customdata_masks;
+  }
+
+  graph_->remove_id_nodes(id_nodes);
+}
+
+void DepsgraphNodeBuilder::save_id_info(IDNode *id_node)
+{
+  /* It is possible that the ID does not need to have CoW version in which case id_cow is the
+   * same as id_orig. Additionally, such ID might have been removed, which makes the check
+   * for whether id_cow is expanded to access freed memory. In order to deal with this we
+   * check whether CoW is needed based on a scalar value which does not lead to access of
+   * possibly deleted memory. */
+  IDInfo *id_info = (IDInfo *)MEM_mallocN(sizeof(IDInfo), "depsgraph id info");
+  if (deg_copy_on_write_is_needed(id_node->id_type) &&
+      deg_copy_on_write_is_expanded(id_node->id_cow) && id_node->id_orig != id_node->id_cow) {
+    id_info->id_cow = id_node->id_cow;
+  }
+  else {
+    id_info->id_cow = nullptr;
+  }
+  id_info->previously_visible_components_mask = id_node->visible_components_mask;
+  id_info->previous_eval_flags = id_node->eval_flags;
+  id_info->previous_customdata_masks = id_node->customdata_masks;
+  BLI_assert(!id_info_hash_.contains(id_node->id_orig_session_uuid));
+  id_info_hash_.add_new(id_node->id_orig_session_uuid, id_info);
+  id_node->id_cow = nullptr;
+}
+
+void DepsgraphNodeBuilder::save_entry_tag(OperationNode *op_node)
+{
+  ComponentNode *comp_node = op_node->owner;
+  IDNode *id_node = comp_node->owner;
+
+  SavedEntryTag entry_tag;
+  entry_tag.id_orig = id_node->id_orig;
+  entry_tag.component_type = comp_node->type;
+  entry_tag.opcode = op_node->opcode;
+  entry_tag.name = op_node->name;
+  entry_tag.name_tag = op_node->name_tag;
+  saved_entry_tags_.append(entry_tag);
+}
+
+void DepsgraphNodeBuilder::save_operation_time(OperationNode *op_node)
+{
+  if (op_node->stats.average_time == 0.0) {
+    /* Operation was never timed. */
+    return;
+  }
+  ComponentNode *comp_node = op_node->owner;
+  IDNode *id_node = comp_node->owner;
+
+  SavedOperationTime operation_time;
+  operation_time.id_orig = id_node->id_orig;
+  operation_time.component_type = comp_node->type;
+  operation_time.opcode = op_node->opcode;
+  operation_time.name = op_node->name;
+  operation_time.name_tag = op_node->name_tag;
+  operation_time.average_time = op_node->stats.average_time;
+  saved_operation_times_.append(operation_time);
+}
+
 /* Util callbacks for `BKE_library_foreach_ID_link`, used to detect when a COW ID is using ID
  * pointers that are either:
  *  - COW ID pointers that do not exist anymore in current depsgraph.
@@ -479,19 +549,23 @@ void DepsgraphNodeBuilder::update_invalid_cow_pointers()
   }
 }
 
+OperationNode *DepsgraphNodeBuilder::find_saved_operation_node(const SavedEntryTag &entry_tag)
+{
+  IDNode *id_node = find_id_node(entry_tag.id_orig);
+  if (id_node == nullptr) {
+    return nullptr;
+  }
+  ComponentNode *comp_node = id_node->find_component(entry_tag.component_type);
+  if (comp_node == nullptr) {
+    return nullptr;
+  }
+  return comp_node->find_operation(entry_tag.opcode, entry_tag.name.c_str(), entry_tag.name_tag);
+}
+
 void DepsgraphNodeBuilder::tag_previously_tagged_nodes()
 {
   for (const SavedEntryTag &entry_tag : saved_entry_tags_) {
-    IDNode *id_node = find_id_node(entry_tag.id_orig);
-    if (id_node == nullptr) {
-      continue;
-    }
-    ComponentNode *comp_node = id_node->find_component(entry_tag.component_type);
-    if (comp_node == nullptr) {
-      continue;
-    }
-    OperationNode *op_node = comp_node->find_operation(
-        entry_tag.opcode, entry_tag.name.c_str(), entry_tag.name_tag);
+    OperationNode *op_node = find_saved_operation_node(entry_tag);
     if (op_node == nullptr) {
       continue;
     }
@@ -501,9 +575,21 @@ void DepsgraphNodeBuilder::tag_previously_tagged_nodes()
   }
 }
 
+void DepsgraphNodeBuilder::restore_operation_times()
+{
+  for (const SavedOperationTime &operation_time : saved_operation_times_) {
+    OperationNode *op_node = find_saved_operation_node(operation_time);
+    if (op_node == nullptr) {
+      continue;
+    }
+    op_node->stats.average_time = operation_time.average_time;
+  }
+}
+
 void DepsgraphNodeBuilder::end_build()
 {
   tag_previously_tagged_nodes();
+  restore_operation_times();
   update_invalid_cow_pointers();
 }
 
@@ -84,6 +84,13 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   }
 
   virtual void begin_build();
+  /* Begin rebuilding nodes of the given IDs of an existing graph: the nodes are removed from the
+   * graph, keeping their copy-on-write datablocks and update tags for the nodes which are built
+   * again. All other IDs of the graph are considered to be built already.
+   * Used by #IncrementalBuilderPipeline instead of #begin_build. */
+  virtual void begin_build_incremental(Scene *scene,
+                                       ViewLayer *view_layer,
+                                       Span<IDNode *> id_nodes);
   virtual void end_build();
 
   /**
@@ -163,6 +170,12 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  /* Build an object removed by #begin_build_incremental. Objects which have a base in the view
+   * layer are built the same way as from the view layer, otherwise the given linked state and
+   * visibility are used. */
+  virtual void build_object_incremental(Object *object,
+                                        eDepsNode_LinkedState_Type linked_state,
+                                        bool is_visible);
   virtual void build_collection(LayerCollection *from_layer_collection, Collection *collection);
   virtual void build_object(int base_index,
                             Object *object,
@@ -267,6 +280,13 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   };
   Vector<SavedEntryTag> saved_entry_tags_;
 
+  /* Averaged evaluation time of an operation, so that scheduling of the evaluation does not have
+   * to learn it again after relations are updated. */
+  struct SavedOperationTime : public SavedEntryTag {
+    double average_time;
+  };
+  Vector<SavedOperationTime> saved_operation_times_;
+
   struct BuilderWalkUserData {
     DepsgraphNodeBuilder *builder;
   };
@@ -279,7 +299,12 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
                               bool is_reference,
                               void *user_data);
 
+  void save_id_info(IDNode *id_node);
+  void save_entry_tag(OperationNode *op_node);
+  void save_operation_time(OperationNode *op_node);
+  OperationNode *find_saved_operation_node(const SavedEntryTag &entry_tag);
   void tag_previously_tagged_nodes();
+  void restore_operation_times();
   /**
    * Check for IDs that need to be flushed (COW-updated)
    * because the depsgraph itself created or removed some of their evaluated dependencies.
@@ -160,4 +160,24 @@ void DepsgraphNodeBuilder::build_view_layer(Scene *scene,
   }
 }
 
+void DepsgraphNodeBuilder::build_object_incremental(Object *object,
+                                                    eDepsNode_LinkedState_Type linked_state,
+                                                    bool is_visible)
+{
+  /* NOTE: Base index is only counted for the bases pulled into the graph, matching
+   * #build_view_layer. */
+  int base_index = 0;
+  LISTBASE_FOREACH (Base *, base, &view_layer_->object_bases) {
+    if (!need_pull_base_into_graph(base)) {
+      continue;
+    }
+    if (base->object == object) {
+      build_object(base_index, object, DEG_ID_LINKED_DIRECTLY, true);
+      return;
+    }
+    base_index++;
+  }
+  build_object(-1, object, linked_state, is_visible);
+}
+
 }  // namespace blender::deg
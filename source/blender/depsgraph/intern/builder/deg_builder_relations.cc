@@ -15,7 +15,9 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_blenlib.h"
+#include "BLI_task.hh"
 #include "BLI_utildefines.h"
 
 #include "DNA_action_types.h"
@@ -233,7 +235,10 @@ bool object_have_geometry_component(const Object *object)
 DepsgraphRelationBuilder::DepsgraphRelationBuilder(Main *bmain,
                                                    Depsgraph *graph,
                                                    DepsgraphBuilderCache *cache)
-    : DepsgraphBuilder(bmain, graph, cache), scene_(nullptr), rna_node_query_(graph, this)
+    : DepsgraphBuilder(bmain, graph, cache),
+      scene_(nullptr),
+      rna_node_query_(graph, this),
+      extra_relation_flags_(0)
 {
 }
 
@@ -339,7 +344,8 @@ Relation *DepsgraphRelationBuilder::add_time_relation(TimeSourceNode *timesrc,
                                                       int flags)
 {
   if (timesrc && node_to) {
-    return graph_->add_new_relation(timesrc, node_to, description, flags);
+    return graph_->add_new_relation(
+        timesrc, node_to, description, flags | extra_relation_flags_);
   }
 
   DEG_DEBUG_PRINTF((::Depsgraph *)graph_,
@@ -367,7 +373,8 @@ Relation *DepsgraphRelationBuilder::add_operation_relation(OperationNode *node_f
                                                            int flags)
 {
   if (node_from && node_to) {
-    return graph_->add_new_relation(node_from, node_to, description, flags);
+    return graph_->add_new_relation(
+        node_from, node_to, description, flags | extra_relation_flags_);
   }
 
   DEG_DEBUG_PRINTF((::Depsgraph *)graph_,
@@ -481,6 +488,15 @@ void DepsgraphRelationBuilder::begin_build()
 {
 }
 
+void DepsgraphRelationBuilder::begin_build_incremental(const Set<ID *> &built_ids)
+{
+  for (ID *id : built_ids) {
+    built_map_.tagBuild(id);
+  }
+  /* Relations of the IDs which are built again partially exist in the graph already. */
+  extra_relation_flags_ |= RELATION_CHECK_BEFORE_ADD;
+}
+
 void DepsgraphRelationBuilder::build_id(ID *id)
 {
   if (id == nullptr) {
@@ -1383,7 +1399,7 @@ void DepsgraphRelationBuilder::build_animdata_curves_targets(ID *id,
       add_relation(adt_key, pose_init_key, "Animation -> Prop", RELATION_CHECK_BEFORE_ADD);
       continue;
     }
-    graph_->add_new_relation(
+    add_operation_relation(
         operation_from, operation_to, "Animation -> Prop", RELATION_CHECK_BEFORE_ADD);
     /* It is possible that animation is writing to a nested ID data-block,
      * need to make sure animation is evaluated after target ID is copied. */
@@ -2878,8 +2894,25 @@ void DepsgraphRelationBuilder::build_vfont(VFont *vfont)
 
 void DepsgraphRelationBuilder::build_copy_on_write_relations()
 {
-  for (IDNode *id_node : graph_->id_nodes) {
-    build_copy_on_write_relations(id_node);
+  /* Relations of every ID only depend on the nodes and relations built so far, so they are
+   * collected in parallel into a buffer per ID. Adding them in the ID order afterwards gives the
+   * same graph as building them one ID after the other. */
+  const Span<IDNode *> id_nodes = graph_->id_nodes;
+  Array<Vector<PendingRelation>> id_relations(id_nodes.size());
+  threading::parallel_for(id_nodes.index_range(), 64, [&](const IndexRange range) {
+    for (const int64_t i : range) {
+      collect_copy_on_write_relations(id_nodes[i], id_relations[i]);
+    }
+  });
+  for (const Vector<PendingRelation> &relations : id_relations) {
+    add_pending_relations(relations);
+  }
+}
+
+void DepsgraphRelationBuilder::add_pending_relations(Span<PendingRelation> relations)
+{
+  for (const PendingRelation &relation : relations) {
+    add_operation_relation(relation.from, relation.to, relation.description, relation.flags);
   }
 }
 
@@ -2921,6 +2954,14 @@ void DepsgraphRelationBuilder::build_nested_shapekey(ID *owner, Key *key)
 }
 
 void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
+{
+  Vector<PendingRelation> relations;
+  collect_copy_on_write_relations(id_node, relations);
+  add_pending_relations(relations);
+}
+
+void DepsgraphRelationBuilder::collect_copy_on_write_relations(
+    IDNode *id_node, Vector<PendingRelation> &r_relations)
 {
   ID *id_orig = id_node->id_orig;
 
@@ -2930,10 +2971,7 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
     return;
   }
 
-  TimeSourceKey time_source_key;
   OperationKey copy_on_write_key(id_orig, NodeType::COPY_ON_WRITE, OperationCode::COPY_ON_WRITE);
-  /* XXX: This is a quick hack to make Alt-A to work. */
-  // add_relation(time_source_key, copy_on_write_key, "Fluxgate capacitor hack");
   /* Resat of code is using rather low level trickery, so need to get some
    * explicit pointers. */
   Node *node_cow = find_node(copy_on_write_key);
@@ -2977,17 +3015,15 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
      * copy of ID. */
     OperationNode *op_entry = comp_node->get_entry_operation();
     if (op_entry != nullptr) {
-      Relation *rel = graph_->add_new_relation(op_cow, op_entry, "CoW Dependency");
-      rel->flag |= rel_flag;
+      r_relations.append({op_cow, op_entry, "CoW Dependency", rel_flag});
     }
     /* All dangling operations should also be executed after copy-on-write. */
-    for (OperationNode *op_node : comp_node->operations_map->values()) {
+    auto add_dangling_operation_relation = [&](OperationNode *op_node) {
       if (op_node == op_entry) {
-        continue;
+        return;
       }
       if (op_node->inlinks.is_empty()) {
-        Relation *rel = graph_->add_new_relation(op_cow, op_node, "CoW Dependency");
-        rel->flag |= rel_flag;
+        r_relations.append({op_cow, op_node, "CoW Dependency", rel_flag});
       }
       else {
         bool has_same_comp_dependency = false;
@@ -3002,10 +3038,20 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
           }
         }
         if (!has_same_comp_dependency) {
-          Relation *rel = graph_->add_new_relation(op_cow, op_node, "CoW Dependency");
-          rel->flag |= rel_flag;
+          r_relations.append({op_cow, op_node, "CoW Dependency", rel_flag});
         }
       }
+    };
+    /* Components of IDs which are kept by an incremental update are finalized already. */
+    if (comp_node->operations_map != nullptr) {
+      for (OperationNode *op_node : comp_node->operations_map->values()) {
+        add_dangling_operation_relation(op_node);
+      }
+    }
+    else {
+      for (OperationNode *op_node : comp_node->operations) {
+        add_dangling_operation_relation(op_node);
+      }
     }
     /* NOTE: We currently ignore implicit relations to an external
      * data-blocks for copy-on-write operations. This means, for example,
@@ -3024,8 +3070,9 @@ void DepsgraphRelationBuilder::build_copy_on_write_relations(IDNode *id_node)
       if (deg_copy_on_write_is_needed(object_data_id)) {
         OperationKey data_copy_on_write_key(
             object_data_id, NodeType::COPY_ON_WRITE, OperationCode::COPY_ON_WRITE);
-        add_relation(
-            data_copy_on_write_key, copy_on_write_key, "Eval Order", RELATION_FLAG_GODMODE);
+        /* A missing node is reported by #get_node and #add_operation_relation. */
+        OperationNode *op_data_cow = get_node(data_copy_on_write_key);
+        r_relations.append({op_data_cow, op_cow, "Eval Order", RELATION_FLAG_GODMODE});
       }
     }
     else {
@@ -148,6 +148,10 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   DepsgraphRelationBuilder(Main *bmain, Depsgraph *graph, DepsgraphBuilderCache *cache);
 
   void begin_build();
+  /* Begin building relations of some IDs of an existing graph: the given IDs are considered to be
+   * built already, and relations which already exist in the graph are not added again.
+   * Used by #IncrementalBuilderPipeline instead of #begin_build. */
+  void begin_build_incremental(const Set<ID *> &built_ids);
 
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
@@ -196,6 +200,12 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  /* Build relations of the given objects as if they were built from the view layer, followed by
+   * the relations of the given dependent IDs. See #IncrementalBuilderPipeline. */
+  virtual void build_objects_incremental(Scene *scene,
+                                         ViewLayer *view_layer,
+                                         Span<Object *> objects,
+                                         Span<ID *> dependent_ids);
   virtual void build_collection(LayerCollection *from_layer_collection,
                                 Object *object,
                                 Collection *collection);
@@ -296,8 +306,21 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
                                          bool add_absorption,
                                          const char *name);
 
+  /* Relation collected by the copy-on-write relations pass, which runs in parallel for all IDs.
+   * They are added to the graph with #add_operation_relation once all IDs are handled. */
+  struct PendingRelation {
+    OperationNode *from;
+    OperationNode *to;
+    const char *description;
+    int flags;
+  };
+
   virtual void build_copy_on_write_relations();
   virtual void build_copy_on_write_relations(IDNode *id_node);
+  /* Only reads the graph (and caches entry/exit operations of the ID's own components),
+   * so it is safe to call for different IDs from multiple threads. */
+  void collect_copy_on_write_relations(IDNode *id_node, Vector<PendingRelation> &r_relations);
+  void add_pending_relations(Span<PendingRelation> relations);
   virtual void build_driver_relations();
   virtual void build_driver_relations(IDNode *id_node);
 
@@ -363,6 +386,9 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   BuilderMap built_map_;
   RNANodeQuery rna_node_query_;
+
+  /* Flags which are added to all the relations created by this builder. */
+  int extra_relation_flags_;
 };
 
 struct DepsNodeHandle {
@@ -138,4 +138,26 @@ void DepsgraphRelationBuilder::build_view_layer(Scene *scene,
   }
 }
 
+void DepsgraphRelationBuilder::build_objects_incremental(Scene *scene,
+                                                         ViewLayer *view_layer,
+                                                         Span<Object *> objects,
+                                                         Span<ID *> dependent_ids)
+{
+  scene_ = scene;
+  for (Object *object : objects) {
+    Base *base = BKE_view_layer_base_find(view_layer, object);
+    if (base != nullptr && need_pull_base_into_graph(base)) {
+      build_object_from_view_layer_base(object);
+    }
+    else {
+      build_object(object);
+    }
+  }
+  /* Relations of the dependent IDs to the objects were removed together with the nodes of the
+   * objects. Build them again, relations to other IDs already exist and are not duplicated. */
+  for (ID *id : dependent_ids) {
+    build_id(id);
+  }
+}
+
 }  // namespace blender::deg
@@ -32,15 +32,27 @@ void AbstractBuilderPipeline::build()
   }
 
   build_step_sanity_check();
-  build_step_nodes();
-  build_step_relations();
-  build_step_finalize();
+  build_step_timed("nodes", &AbstractBuilderPipeline::build_step_nodes);
+  build_step_timed("relations", &AbstractBuilderPipeline::build_step_relations);
+  build_step_timed("finalize", &AbstractBuilderPipeline::build_step_finalize);
 
   if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
     printf("Depsgraph built in %f seconds.\n", PIL_check_seconds_timer() - start_time);
   }
 }
 
+void AbstractBuilderPipeline::build_step_timed(const char *name,
+                                               void (AbstractBuilderPipeline::*step)())
+{
+  if ((G.debug & G_DEBUG_DEPSGRAPH_TIME) == 0) {
+    (this->*step)();
+    return;
+  }
+  const double start_time = PIL_check_seconds_timer();
+  (this->*step)();
+  printf("Depsgraph build step %s: %f seconds.\n", name, PIL_check_seconds_timer() - start_time);
+}
+
 void AbstractBuilderPipeline::build_step_sanity_check()
 {
   BLI_assert(BLI_findindex(&scene_->view_layers, view_layer_) != -1);
@@ -91,6 +103,8 @@ void AbstractBuilderPipeline::build_step_finalize()
 #endif
   /* Relations are up to date. */
   deg_graph_->need_update = false;
+  deg_graph_->need_incremental_update = false;
+  deg_graph_->incremental_update_ids.clear();
 }
 
 unique_ptr<DepsgraphNodeBuilder> AbstractBuilderPipeline::construct_node_builder()
@@ -49,9 +49,11 @@ class AbstractBuilderPipeline {
   virtual unique_ptr<DepsgraphRelationBuilder> construct_relation_builder();
 
   virtual void build_step_sanity_check();
-  void build_step_nodes();
-  void build_step_relations();
+  virtual void build_step_nodes();
+  virtual void build_step_relations();
   void build_step_finalize();
+  /* Run a build step, printing its time when depsgraph time debugging is enabled. */
+  void build_step_timed(const char *name, void (AbstractBuilderPipeline::*step)());
 
   virtual void build_nodes(DepsgraphNodeBuilder &node_builder) = 0;
   virtual void build_relations(DepsgraphRelationBuilder &relation_builder) = 0;
@@ -0,0 +1,228 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "pipeline_incremental.h"
+
+#include "DNA_layer_types.h"
+#include "DNA_object_types.h"
+
+#include "BKE_layer.h"
+
+#include "intern/builder/deg_builder_nodes.h"
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender::deg {
+
+IncrementalBuilderPipeline::IncrementalBuilderPipeline(::Depsgraph *graph)
+    : AbstractBuilderPipeline(graph), is_supported_(false), has_unused_ids_(false)
+{
+  is_supported_ = collect_ids();
+}
+
+bool IncrementalBuilderPipeline::is_supported() const
+{
+  return is_supported_;
+}
+
+bool IncrementalBuilderPipeline::is_object_supported(Object *object, IDNode *id_node) const
+{
+  /* Objects of set scenes are built by a different view layer. */
+  if (id_node->linked_state == DEG_ID_LINKED_VIA_SET) {
+    return false;
+  }
+  /* Change of bases is only handled by rebuilding the view layer. */
+  const bool has_base = BKE_view_layer_base_find(view_layer_, object) != nullptr;
+  if (has_base != id_node->has_base) {
+    return false;
+  }
+  /* Nodes of the instanced collection and particle systems are built with visibility of the
+   * object, which might differ from the visibility the collection was built with. */
+  if (object->instance_collection != nullptr || object->particlesystem.first != nullptr) {
+    return false;
+  }
+  /* Rigid body operations of the object are created by the scene. */
+  if (object->rigidbody_object != nullptr || object->rigidbody_constraint != nullptr) {
+    return false;
+  }
+  for (ComponentNode *comp_node : id_node->components.values()) {
+    for (OperationNode *op_node : comp_node->operations) {
+      /* ID properties operations might be created by drivers of other IDs. */
+      if (op_node->opcode == OperationCode::ID_PROPERTY) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+bool IncrementalBuilderPipeline::collect_ids()
+{
+  if (!deg_graph_->need_incremental_update || deg_graph_->id_nodes.is_empty()) {
+    return false;
+  }
+
+  Set<IDNode *> tagged_id_nodes;
+  for (ID *id : deg_graph_->incremental_update_ids) {
+    if (GS(id->name) != ID_OB) {
+      return false;
+    }
+    IDNode *id_node = deg_graph_->find_id_node(id);
+    if (id_node == nullptr) {
+      return false;
+    }
+    Object *object = reinterpret_cast<Object *>(id);
+    if (!is_object_supported(object, id_node)) {
+      return false;
+    }
+    tagged_objects_.append({object, id_node, id_node->linked_state, id_node->is_directly_visible});
+    tagged_id_nodes.add(id_node);
+  }
+
+  /* Relations between the tagged objects and other IDs are removed with the nodes, so they need
+   * to be built again from both sides. */
+  Set<IDNode *> dependent_id_nodes;
+  auto add_dependent = [&](Node *node) {
+    if (node->type != NodeType::OPERATION) {
+      return true;
+    }
+    OperationNode *op_node = static_cast<OperationNode *>(node);
+    IDNode *id_node = op_node->owner->owner;
+    if (tagged_id_nodes.contains(id_node)) {
+      return true;
+    }
+    /* ID property operations (and their relations) are created for the drivers of the tagged
+     * objects, but belong to the other ID. They would be kept when the drivers change. */
+    if (op_node->opcode == OperationCode::ID_PROPERTY) {
+      return false;
+    }
+    dependent_id_nodes.add(id_node);
+    return true;
+  };
+  for (const TaggedObject &tagged_object : tagged_objects_) {
+    for (ComponentNode *comp_node : tagged_object.id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        for (Relation *rel : op_node->inlinks) {
+          if (!add_dependent(rel->from)) {
+            return false;
+          }
+        }
+        for (Relation *rel : op_node->outlinks) {
+          if (!add_dependent(rel->to)) {
+            return false;
+          }
+        }
+      }
+    }
+  }
+
+  /* Rebuilding most of the graph this way is slower than building it from scratch. */
+  if ((tagged_id_nodes.size() + dependent_id_nodes.size()) * 2 > deg_graph_->id_nodes.size()) {
+    return false;
+  }
+
+  for (IDNode *id_node : deg_graph_->id_nodes) {
+    if (dependent_id_nodes.contains(id_node)) {
+      dependent_ids_.append(id_node->id_orig);
+    }
+    else if (!tagged_id_nodes.contains(id_node)) {
+      untouched_ids_.add(id_node->id_orig);
+    }
+  }
+  return true;
+}
+
+void IncrementalBuilderPipeline::build_step_nodes()
+{
+  unique_ptr<DepsgraphNodeBuilder> node_builder = construct_node_builder();
+  Vector<IDNode *> id_nodes;
+  for (const TaggedObject &tagged_object : tagged_objects_) {
+    id_nodes.append(tagged_object.id_node);
+  }
+  node_builder->begin_build_incremental(scene_, view_layer_, id_nodes);
+  build_nodes(*node_builder);
+  node_builder->end_build();
+}
+
+void IncrementalBuilderPipeline::build_step_relations()
+{
+  /* Cycles are detected again for the whole graph, the relations which were cyclic with the
+   * previous relations of the tagged objects might not be anymore. */
+  for (OperationNode *op_node : deg_graph_->operations) {
+    for (Relation *rel : op_node->inlinks) {
+      rel->flag &= ~RELATION_FLAG_CYCLIC;
+    }
+  }
+
+  unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
+  relation_builder->begin_build_incremental(untouched_ids_);
+  build_relations(*relation_builder);
+  /* Copy-on-write and driver relations only depend on the ID itself, they are only built for the
+   * rebuilt IDs, including IDs which were added to the graph by the tagged objects. */
+  const Set<ID *> dependent_ids(dependent_ids_);
+  for (IDNode *id_node : deg_graph_->id_nodes) {
+    if (!untouched_ids_.contains(id_node->id_orig) && !dependent_ids.contains(id_node->id_orig)) {
+      relation_builder->build_copy_on_write_relations(id_node);
+      relation_builder->build_driver_relations(id_node);
+    }
+  }
+
+  has_unused_ids_ = find_unused_dependent_ids();
+}
+
+bool IncrementalBuilderPipeline::find_unused_dependent_ids() const
+{
+  for (ID *id : dependent_ids_) {
+    if (GS(id->name) == ID_SCE) {
+      continue;
+    }
+    const IDNode *id_node = deg_graph_->find_id_node(id);
+    if (id_node == nullptr || id_node->has_base) {
+      continue;
+    }
+    /* IDs without a base are in the graph because other IDs depend on them. When the tagged
+     * objects were their only users, a full build would not contain them anymore. */
+    bool has_users = false;
+    for (const ComponentNode *comp_node : id_node->components.values()) {
+      for (const OperationNode *op_node : comp_node->operations) {
+        for (const Relation *rel : op_node->outlinks) {
+          if (rel->to->type == NodeType::OPERATION &&
+              static_cast<const OperationNode *>(rel->to)->owner->owner != id_node) {
+            has_users = true;
+            break;
+          }
+        }
+      }
+    }
+    if (!has_users) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool IncrementalBuilderPipeline::has_unused_ids() const
+{
+  return has_unused_ids_;
+}
+
+void IncrementalBuilderPipeline::build_nodes(DepsgraphNodeBuilder &node_builder)
+{
+  for (const TaggedObject &tagged_object : tagged_objects_) {
+    node_builder.build_object_incremental(
+        tagged_object.object, tagged_object.linked_state, tagged_object.is_visible);
+  }
+}
+
+void IncrementalBuilderPipeline::build_relations(DepsgraphRelationBuilder &relation_builder)
+{
+  Vector<Object *> objects;
+  for (const TaggedObject &tagged_object : tagged_objects_) {
+    objects.append(tagged_object.object);
+  }
+  relation_builder.build_objects_incremental(scene_, view_layer_, objects, dependent_ids_);
+}
+
+}  // namespace blender::deg
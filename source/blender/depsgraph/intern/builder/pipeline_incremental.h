@@ -0,0 +1,70 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "pipeline.h"
+
+#include "intern/node/deg_node_id.h"
+
+struct ID;
+struct Object;
+
+namespace blender {
+namespace deg {
+
+struct IDNode;
+
+/* Update of a graph built from the view layer, which only rebuilds nodes and relations of the IDs
+ * tagged with #DEG_id_tag_relations_update.
+ *
+ * Nodes of the tagged objects are removed from the graph (together with all their relations) and
+ * built again. Relations are then built again for the tagged objects and for all the IDs which
+ * were connected to them, with all other IDs considered to be built already.
+ *
+ * Only objects are supported, for other IDs (or objects which get nodes from other builders,
+ * such as rigid body) the whole graph is to be rebuilt, see #is_supported. The same goes for
+ * objects which create nodes in other IDs (ID properties used by drivers), since those nodes and
+ * their relations would be left over, and when IDs are not used anymore, see #has_unused_ids. */
+class IncrementalBuilderPipeline : public AbstractBuilderPipeline {
+ public:
+  IncrementalBuilderPipeline(::Depsgraph *graph);
+
+  /* Check whether the tagged IDs can be updated without rebuilding the whole graph. */
+  bool is_supported() const;
+  /* After building: whether IDs which were only used by the previous state of the tagged objects
+   * are still in the graph. Removing them is not supported, the whole graph is to be rebuilt. */
+  bool has_unused_ids() const;
+
+ protected:
+  struct TaggedObject {
+    Object *object;
+    IDNode *id_node;
+    eDepsNode_LinkedState_Type linked_state;
+    bool is_visible;
+  };
+
+  Vector<TaggedObject> tagged_objects_;
+  /* IDs which have relations to or from the tagged objects, in the order of the graph. */
+  Vector<ID *> dependent_ids_;
+  /* IDs of the graph which are not affected by the update. */
+  Set<ID *> untouched_ids_;
+  bool is_supported_;
+  bool has_unused_ids_;
+
+  bool collect_ids();
+  bool find_unused_dependent_ids() const;
+  bool is_object_supported(Object *object, IDNode *id_node) const;
+
+  virtual void build_step_nodes() override;
+  virtual void build_step_relations() override;
+
+  virtual void build_nodes(DepsgraphNodeBuilder &node_builder) override;
+  virtual void build_relations(DepsgraphRelationBuilder &relation_builder) override;
+};
+
+}  // namespace deg
+}  // namespace blender
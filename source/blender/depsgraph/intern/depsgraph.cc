@@ -46,6 +46,7 @@ namespace blender::deg {
 Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluationMode mode)
     : time_source(nullptr),
       need_update(true),
+      need_incremental_update(false),
       need_visibility_update(true),
       need_visibility_time_update(false),
       bmain(bmain),
@@ -166,6 +167,55 @@ void Depsgraph::clear_id_nodes()
   clear_physics_relations(this);
 }
 
+static void remove_node_relations(Node *node)
+{
+  /* Copy the links, since unlinking modifies them. */
+  for (Relation *rel : Vector<Relation *>(node->inlinks)) {
+    rel->unlink();
+    delete rel;
+  }
+  for (Relation *rel : Vector<Relation *>(node->outlinks)) {
+    rel->unlink();
+    delete rel;
+  }
+}
+
+void Depsgraph::remove_id_nodes(Span<IDNode *> id_nodes_to_remove)
+{
+  Set<IDNode *> removed_id_nodes;
+  Set<OperationNode *> removed_operations;
+  for (IDNode *id_node : id_nodes_to_remove) {
+    removed_id_nodes.add(id_node);
+    remove_node_relations(id_node);
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      remove_node_relations(comp_node);
+      for (OperationNode *op_node : comp_node->operations) {
+        remove_node_relations(op_node);
+        removed_operations.add(op_node);
+        entry_tags.remove(op_node);
+      }
+    }
+  }
+
+  operations.resize(std::remove_if(operations.begin(),
+                                   operations.end(),
+                                   [&](OperationNode *op_node) {
+                                     return removed_operations.contains(op_node);
+                                   }) -
+                    operations.begin());
+  id_nodes.resize(std::remove_if(id_nodes.begin(),
+                                 id_nodes.end(),
+                                 [&](IDNode *id_node) {
+                                   return removed_id_nodes.contains(id_node);
+                                 }) -
+                  id_nodes.begin());
+
+  for (IDNode *id_node : id_nodes_to_remove) {
+    id_hash.remove(id_node->id_orig);
+    delete id_node;
+  }
+}
+
 Relation *Depsgraph::add_new_relation(Node *from, Node *to, const char *description, int flags)
 {
   Relation *rel = nullptr;
@@ -55,6 +55,9 @@ struct Depsgraph {
   IDNode *find_id_node(const ID *id) const;
   IDNode *add_id_node(ID *id, ID *id_cow_hint = nullptr);
   void clear_id_nodes();
+  /* Remove nodes of the given IDs together with all relations from and to their operations.
+   * The copy-on-write datablocks are freed unless ownership was taken from the nodes. */
+  void remove_id_nodes(Span<IDNode *> id_nodes_to_remove);
 
   /** Add new relationship between two nodes. */
   Relation *add_new_relation(Node *from, Node *to, const char *description, int flags = 0);
@@ -92,6 +95,12 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* Relations only need to be updated for the IDs in #incremental_update_ids, which allows to
+   * only rebuild nodes and relations of those IDs instead of the whole graph.
+   * See #DEG_id_tag_relations_update. */
+  bool need_incremental_update;
+  Set<ID *> incremental_update_ids;
+
   /* Indicated whether IDs in this graph are to be tagged as if they first appear visible, with
    * an optional tag for their animation (time) update. */
   bool need_visibility_update;
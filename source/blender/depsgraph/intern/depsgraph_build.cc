@@ -23,6 +23,7 @@
 #include "DNA_simulation_types.h"
 
 #include "BKE_collection.h"
+#include "BKE_global.h"
 #include "BKE_main.h"
 #include "BKE_scene.h"
 
@@ -34,6 +35,7 @@
 #include "builder/pipeline_all_objects.h"
 #include "builder/pipeline_compositor.h"
 #include "builder/pipeline_from_ids.h"
+#include "builder/pipeline_incremental.h"
 #include "builder/pipeline_render.h"
 #include "builder/pipeline_view_layer.h"
 
@@ -271,6 +273,8 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
   DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations for update.\n", __func__);
   deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
   deg_graph->need_update = true;
+  deg_graph->need_incremental_update = false;
+  deg_graph->incremental_update_ids.clear();
   /* NOTE: When relations are updated, it's quite possible that
    * we've got new bases in the scene. This means, we need to
    * re-create flat array of bases in view layer.
@@ -283,6 +287,57 @@ void DEG_graph_tag_relations_update(Depsgraph *graph)
   }
 }
 
+void DEG_graph_id_tag_relations_update(Depsgraph *graph, ID *id)
+{
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
+  if (deg_graph->need_update && !deg_graph->need_incremental_update) {
+    /* The whole graph is to be rebuilt already. */
+    return;
+  }
+  deg::IDNode *id_node = deg_graph->find_id_node(id);
+  if (id_node == nullptr) {
+    /* Relations of an ID which is not in the graph do not affect it. */
+    return;
+  }
+  DEG_DEBUG_PRINTF(graph, TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  deg_graph->need_update = true;
+  deg_graph->need_incremental_update = true;
+  deg_graph->incremental_update_ids.add(id);
+  id_node->tag_update(deg_graph, deg::DEG_UPDATE_SOURCE_RELATIONS);
+}
+
+/* Compare the graph with one built from scratch, used to validate incremental updates. */
+static bool deg_graph_matches_full_build(Depsgraph *graph)
+{
+  deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(graph);
+  Depsgraph *temp_graph = DEG_graph_new(
+      deg_graph->bmain, deg_graph->scene, deg_graph->view_layer, deg_graph->mode);
+  DEG_graph_build_from_view_layer(temp_graph);
+  const bool is_equal = DEG_debug_compare(temp_graph, graph);
+  DEG_graph_free(temp_graph);
+  return is_equal;
+}
+
+static bool deg_graph_relations_update_incremental(Depsgraph *graph)
+{
+  deg::IncrementalBuilderPipeline builder(graph);
+  if (!builder.is_supported()) {
+    return false;
+  }
+  builder.build();
+  if (builder.has_unused_ids()) {
+    return false;
+  }
+  if (G.debug & G_DEBUG_DEPSGRAPH_INCREMENTAL) {
+    if (!deg_graph_matches_full_build(graph)) {
+      fprintf(stderr, "Incremental relations update differs from a full build, rebuilding.\n");
+      BLI_assert_msg(0, "Incremental relations update should match a full build!");
+      return false;
+    }
+  }
+  return true;
+}
+
 void DEG_graph_relations_update(Depsgraph *graph)
 {
   deg::Depsgraph *deg_graph = (deg::Depsgraph *)graph;
@@ -290,6 +345,9 @@ void DEG_graph_relations_update(Depsgraph *graph)
     /* Graph is up to date, nothing to do. */
     return;
   }
+  if (deg_graph->need_incremental_update && deg_graph_relations_update_incremental(graph)) {
+    return;
+  }
   DEG_graph_build_from_view_layer(graph);
 }
 
@@ -300,3 +358,11 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+void DEG_id_tag_relations_update(Main *bmain, ID *id)
+{
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
+    DEG_graph_id_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph), id);
+  }
+}
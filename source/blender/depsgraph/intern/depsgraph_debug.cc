@@ -24,6 +24,7 @@
 #include "intern/depsgraph_type.h"
 #include "intern/node/deg_node_component.h"
 #include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
 #include "intern/node/deg_node_time.h"
 
 namespace deg = blender::deg;
@@ -52,22 +53,69 @@ const char *DEG_debug_name_get(struct Depsgraph *depsgraph)
   return deg_graph->debug.name.c_str();
 }
 
+/* Identifier of a node which is the same for graphs built for the same data. */
+static std::string deg_debug_node_key(const deg::Node *node)
+{
+  if (node->type != deg::NodeType::OPERATION) {
+    return node->identifier();
+  }
+  const deg::OperationNode *op_node = static_cast<const deg::OperationNode *>(node);
+  return op_node->full_identifier() + " [" + deg::nodeTypeAsString(op_node->owner->type) + " " +
+         std::to_string(op_node->name_tag) + "]";
+}
+
+/* Operations and relations of the graph as strings, relations flags which depend on the order
+ * in which the graph was built are ignored. */
+static void deg_debug_graph_keys(const deg::Depsgraph *deg_graph,
+                                 blender::Set<std::string> &r_operations,
+                                 blender::Set<std::string> &r_relations)
+{
+  const int ignored_flags = deg::RELATION_FLAG_CYCLIC | deg::RELATION_CHECK_BEFORE_ADD;
+  for (const deg::OperationNode *op_node : deg_graph->operations) {
+    const std::string op_key = deg_debug_node_key(op_node);
+    r_operations.add(op_key);
+    for (const deg::Relation *rel : op_node->inlinks) {
+      r_relations.add(deg_debug_node_key(rel->from) + " -> " + op_key + " (" + rel->name + ", " +
+                      std::to_string(rel->flag & ~ignored_flags) + ")");
+    }
+  }
+}
+
+static bool deg_debug_keys_compare(const blender::Set<std::string> &keys1,
+                                   const blender::Set<std::string> &keys2,
+                                   const char *what)
+{
+  bool is_equal = true;
+  for (const std::string &key : keys1) {
+    if (!keys2.contains(key)) {
+      fprintf(stderr, "%s only in first graph: %s\n", what, key.c_str());
+      is_equal = false;
+    }
+  }
+  for (const std::string &key : keys2) {
+    if (!keys1.contains(key)) {
+      fprintf(stderr, "%s only in second graph: %s\n", what, key.c_str());
+      is_equal = false;
+    }
+  }
+  return is_equal;
+}
+
 bool DEG_debug_compare(const struct Depsgraph *graph1, const struct Depsgraph *graph2)
 {
   BLI_assert(graph1 != nullptr);
   BLI_assert(graph2 != nullptr);
   const deg::Depsgraph *deg_graph1 = reinterpret_cast<const deg::Depsgraph *>(graph1);
   const deg::Depsgraph *deg_graph2 = reinterpret_cast<const deg::Depsgraph *>(graph2);
-  if (deg_graph1->operations.size() != deg_graph2->operations.size()) {
-    return false;
-  }
-  /* TODO(sergey): Currently we only do real stupid check,
-   * which is fast but which isn't 100% reliable.
-   *
-   * Would be cool to make it more robust, but it's good enough
-   * for now. Also, proper graph check is actually NP-complex
-   * problem. */
-  return true;
+  /* NOTE: Operations and relations are compared by their identifiers, which is not 100% reliable
+   * (identifiers are not guaranteed to be unique), but is good enough to validate that two graphs
+   * were built for the same data. Proper graph check is actually NP-complex problem. */
+  blender::Set<std::string> operations1, operations2, relations1, relations2;
+  deg_debug_graph_keys(deg_graph1, operations1, relations1);
+  deg_debug_graph_keys(deg_graph2, operations2, relations2);
+  const bool operations_equal = deg_debug_keys_compare(operations1, operations2, "Operation");
+  const bool relations_equal = deg_debug_keys_compare(relations1, relations2, "Relation");
+  return operations_equal && relations_equal;
 }
 
 bool DEG_debug_graph_relations_validate(Depsgraph *graph,
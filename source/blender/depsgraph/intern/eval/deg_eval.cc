@@ -9,12 +9,15 @@
 
 #include "intern/eval/deg_eval.h"
 
+#include <algorithm>
+
 #include "PIL_time.h"
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
 #include "BLI_task.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_global.h"
 
@@ -62,6 +65,20 @@ void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), Tas
   BLI_task_pool_push(pool, deg_task_run_func, node, false, nullptr);
 }
 
+using ReadyNodes = Vector<OperationNode *, 16>;
+
+void schedule_node_to_ready_nodes(OperationNode *node,
+                                  const int /*thread_id*/,
+                                  ReadyNodes *ready_nodes)
+{
+  ready_nodes->append(node);
+}
+
+bool operation_node_critical_path_greater(const OperationNode *a, const OperationNode *b)
+{
+  return a->critical_path_time > b->critical_path_time;
+}
+
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
   /* Stage 1: Only  Copy-on-Write operations are to be evaluated, prior to anything else.
@@ -82,8 +99,15 @@ enum class EvaluationStage {
 struct DepsgraphEvalState {
   Depsgraph *graph;
   bool do_stats;
+  /* Schedule operations with the longest critical path first. Only done when operations are
+   * evaluated in multiple threads, the order does not matter otherwise. */
+  bool do_critical_path_scheduling;
   EvaluationStage stage;
   bool need_single_thread_pass;
+  /* Prediction of the evaluation based on timing of the previous evaluations: the longest chain
+   * of dependent operations, and the time of all operations summed up. */
+  double predicted_critical_path_time;
+  double predicted_total_time;
 };
 
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
@@ -93,14 +117,21 @@ void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_nod
   /* Sanity checks. */
   BLI_assert_msg(!operation_node->is_noop(), "NOOP nodes should not actually be scheduled");
   /* Perform operation. */
-  if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
+  if (!state->do_stats && !state->do_critical_path_scheduling) {
     operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+    return;
   }
-  else {
-    operation_node->evaluate(depsgraph);
+  /* The timing is used for statistics and for scheduling of the next evaluation. */
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  const double time = PIL_check_seconds_timer() - start_time;
+
+  Node::Stats &stats = operation_node->stats;
+  if (state->do_stats) {
+    stats.current_time += time;
   }
+  /* Smooth out the timing, so a single slow evaluation does not throw off scheduling. */
+  stats.average_time = (stats.average_time == 0.0) ? time : (stats.average_time + time) * 0.5;
 }
 
 void deg_task_run_func(TaskPool *pool, void *taskdata)
@@ -108,12 +139,28 @@ void deg_task_run_func(TaskPool *pool, void *taskdata)
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
-  /* Evaluate node. */
   OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
-  evaluate_node(state, operation_node);
+  ReadyNodes ready_nodes;
+  while (operation_node != nullptr) {
+    /* Evaluate node. */
+    evaluate_node(state, operation_node);
 
-  /* Schedule children. */
-  schedule_children(state, operation_node, schedule_node_to_pool, pool);
+    /* Schedule children. The one with the longest critical path is evaluated next in this thread,
+     * the others are pushed to the pool with the longest critical path first, so they are the
+     * first ones to be picked up by other threads. */
+    ready_nodes.clear();
+    schedule_children(state, operation_node, schedule_node_to_ready_nodes, &ready_nodes);
+    if (ready_nodes.is_empty()) {
+      break;
+    }
+    if (state->do_critical_path_scheduling) {
+      std::sort(ready_nodes.begin(), ready_nodes.end(), operation_node_critical_path_greater);
+    }
+    operation_node = ready_nodes[0];
+    for (OperationNode *node : ready_nodes.as_span().drop_front(1)) {
+      schedule_node_to_pool(node, 0, pool);
+    }
+  }
 }
 
 bool check_operation_node_visible(OperationNode *op_node)
@@ -166,10 +213,71 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
+bool need_evaluate_operation(OperationNode *node)
+{
+  return (node->flag & DEPSOP_FLAG_NEEDS_UPDATE) && check_operation_node_visible(node);
+}
+
+/* Calculate how long the longest chain of operations starting at every operation which is to be
+ * evaluated takes, from the averaged timing of previous evaluations.
+ *
+ * Operations are visited in reverse topological order, with Node::custom_flags used as counter of
+ * children which are not visited yet. */
+void calculate_critical_path_times(DepsgraphEvalState *state, Depsgraph *graph)
+{
+  Vector<OperationNode *> ready_nodes;
+  for (OperationNode *node : graph->operations) {
+    node->critical_path_time = 0.0;
+    node->custom_flags = 0;
+    if (!need_evaluate_operation(node)) {
+      continue;
+    }
+    for (Relation *rel : node->outlinks) {
+      OperationNode *child = (OperationNode *)rel->to;
+      if ((rel->flag & RELATION_FLAG_CYCLIC) == 0 && need_evaluate_operation(child)) {
+        ++node->custom_flags;
+      }
+    }
+    if (node->custom_flags == 0) {
+      ready_nodes.append(node);
+    }
+  }
+
+  state->predicted_critical_path_time = 0.0;
+  state->predicted_total_time = 0.0;
+  while (!ready_nodes.is_empty()) {
+    OperationNode *node = ready_nodes.pop_last();
+    double children_time = 0.0;
+    for (Relation *rel : node->outlinks) {
+      OperationNode *child = (OperationNode *)rel->to;
+      if ((rel->flag & RELATION_FLAG_CYCLIC) == 0 && need_evaluate_operation(child)) {
+        children_time = std::max(children_time, child->critical_path_time);
+      }
+    }
+    node->critical_path_time = node->stats.average_time + children_time;
+    state->predicted_critical_path_time = std::max(state->predicted_critical_path_time,
+                                                   node->critical_path_time);
+    state->predicted_total_time += node->stats.average_time;
+
+    for (Relation *rel : node->inlinks) {
+      if (rel->from->type != NodeType::OPERATION || (rel->flag & RELATION_FLAG_CYCLIC) != 0) {
+        continue;
+      }
+      OperationNode *parent = (OperationNode *)rel->from;
+      if (need_evaluate_operation(parent) && --parent->custom_flags == 0) {
+        ready_nodes.append(parent);
+      }
+    }
+  }
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
+  if (state->do_critical_path_scheduling || do_stats) {
+    calculate_critical_path_times(state, graph);
+  }
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
     if (do_stats) {
@@ -269,7 +377,18 @@ void schedule_graph(DepsgraphEvalState *state,
                     ScheduleFunction *schedule_function,
                     ScheduleFunctionArgs... schedule_function_args)
 {
+  /* Schedule operations with the longest critical path first. Only operations which have no
+   * pending parents can be scheduled here, so only those are sorted. */
+  Vector<OperationNode *> root_nodes;
   for (OperationNode *node : state->graph->operations) {
+    if (node->num_links_pending == 0 && (node->flag & DEPSOP_FLAG_NEEDS_UPDATE)) {
+      root_nodes.append(node);
+    }
+  }
+  if (state->do_critical_path_scheduling) {
+    std::sort(root_nodes.begin(), root_nodes.end(), operation_node_critical_path_greater);
+  }
+  for (OperationNode *node : root_nodes) {
     schedule_node(state, node, false, schedule_function, schedule_function_args...);
   }
 }
@@ -365,9 +484,12 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   DepsgraphEvalState state;
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
+  state.do_critical_path_scheduling = (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) == 0 &&
+                                      BLI_task_scheduler_num_threads() > 1;
   state.need_single_thread_pass = false;
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
+  const double start_time = PIL_check_seconds_timer();
 
   /* Do actual evaluation now. */
   /* First, process all Copy-On-Write nodes. */
@@ -394,6 +516,12 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
    * synchronization. */
   if (state.do_stats) {
     deg_eval_stats_aggregate(graph);
+    deg_eval_stats_print_makespan(state.predicted_critical_path_time,
+                                  state.predicted_total_time,
+                                  (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS) ?
+                                      1 :
+                                      BLI_task_scheduler_num_threads(),
+                                  PIL_check_seconds_timer() - start_time);
   }
   /* Clear any uncleared tags - just in case. */
   deg_graph_clear_tags(graph);
@@ -7,6 +7,9 @@
 
 #include "intern/eval/deg_eval_stats.h"
 
+#include <algorithm>
+#include <cstdio>
+
 #include "BLI_utildefines.h"
 
 #include "intern/depsgraph.h"
@@ -38,4 +41,22 @@ void deg_eval_stats_aggregate(Depsgraph *graph)
   }
 }
 
+void deg_eval_stats_print_makespan(const double critical_path_time,
+                                   const double total_time,
+                                   const int num_threads,
+                                   const double actual_time)
+{
+  /* Evaluation can not be faster than its critical path, nor than the total work spread evenly
+   * over all threads. */
+  const double predicted_time = std::max(critical_path_time, total_time / num_threads);
+  printf(
+      "Depsgraph evaluation predicted in %f seconds (critical path %f, total %f, %d threads), "
+      "evaluated in %f seconds.\n",
+      predicted_time,
+      critical_path_time,
+      total_time,
+      num_threads,
+      actual_time);
+}
+
 }  // namespace blender::deg
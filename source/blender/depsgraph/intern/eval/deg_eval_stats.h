@@ -15,5 +15,12 @@ struct Depsgraph;
 /* Aggregate operation timings to overall component and ID nodes timing. */
 void deg_eval_stats_aggregate(Depsgraph *graph);
 
+/* Print evaluation time predicted from the critical path and total time of operations, as timed
+ * during previous evaluations, next to the actual evaluation time. */
+void deg_eval_stats_print_makespan(double critical_path_time,
+                                   double total_time,
+                                   int num_threads,
+                                   double actual_time);
+
 }  // namespace deg
 }  // namespace blender
@@ -162,6 +162,10 @@ struct Node {
     void reset_current();
     /* Time spend on this node during current graph evaluation. */
     double current_time;
+    /* Time spend on this node averaged over the graph evaluations it was timed in. Only filled in
+     * for operations, where it is used to predict how long their evaluation takes. Kept when the
+     * relations are updated. */
+    double average_time;
   };
   /* Relationships between nodes
    * The reason why all depsgraph nodes are descended from this type (apart
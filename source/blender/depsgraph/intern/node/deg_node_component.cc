@@ -163,8 +163,14 @@ OperationNode *ComponentNode::add_operation(const DepsEvalOperationCb &op,
     op_node = (OperationNode *)factory->create_node(this->owner->id_orig, "", name);
 
     /* register opnode in this component's operation set */
-    OperationIDKey key(opcode, name, name_tag);
-    operations_map->add(key, op_node);
+    if (operations_map != nullptr) {
+      OperationIDKey key(opcode, name, name_tag);
+      operations_map->add(key, op_node);
+    }
+    else {
+      /* Component of an ID which is not rebuilt by an incremental update is finalized already. */
+      operations.append(op_node);
+    }
 
     /* Set back-link. */
     op_node->owner = this;
@@ -274,6 +280,10 @@ OperationNode *ComponentNode::get_exit_operation()
 
 void ComponentNode::finalize_build(Depsgraph * /*graph*/)
 {
+  if (operations_map == nullptr) {
+    /* Finalized already, happens for IDs which are not rebuilt by an incremental update. */
+    return;
+  }
   operations.reserve(operations_map->size());
   for (OperationNode *op_node : operations_map->values()) {
     operations.append(op_node);
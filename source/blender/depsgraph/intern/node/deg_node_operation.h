@@ -256,6 +256,10 @@ struct OperationNode : public Node {
   uint32_t num_links_pending;
   bool scheduled;
 
+  /* Predicted time of evaluating this operation and the longest chain of operations which depend
+   * on it. Operations with the longest chain are scheduled first. Only valid during evaluation. */
+  double critical_path_time;
+
   /* Identifier for the operation being performed. */
   OperationCode opcode;
   int name_tag;
@@ -959,7 +959,7 @@ static int add_driver_button_none(bContext *C, wmOperator *op, short mapping_typ
   if (success) {
     /* send updates */
     UI_context_update_anim_flag(C);
-    DEG_relations_tag_update(CTX_data_main(C));
+    DEG_id_tag_relations_update(CTX_data_main(C), ptr.owner_id);
     WM_event_add_notifier(C, NC_ANIMATION | ND_FCURVES_ORDER, NULL); /* XXX */
 
     return OPERATOR_FINISHED;
@@ -1054,7 +1054,7 @@ static int add_driver_button_invoke(bContext *C, wmOperator *op, const wmEvent *
       /* send updates */
       UI_context_update_anim_flag(C);
       DEG_id_tag_update(ptr.owner_id, ID_RECALC_COPY_ON_WRITE);
-      DEG_relations_tag_update(CTX_data_main(C));
+      DEG_id_tag_relations_update(CTX_data_main(C), ptr.owner_id);
       WM_event_add_notifier(C, NC_ANIMATION | ND_FCURVES_ORDER, NULL);
     }
 
@@ -1112,7 +1112,7 @@ static int remove_driver_button_exec(bContext *C, wmOperator *op)
   if (changed) {
     /* send updates */
     UI_context_update_anim_flag(C);
-    DEG_relations_tag_update(CTX_data_main(C));
+    DEG_id_tag_relations_update(CTX_data_main(C), ptr.owner_id);
     WM_event_add_notifier(C, NC_ANIMATION | ND_FCURVES_ORDER, NULL); /* XXX */
   }
 
@@ -1237,7 +1237,7 @@ static int paste_driver_button_exec(bContext *C, wmOperator *op)
 
       UI_context_update_anim_flag(C);
 
-      DEG_relations_tag_update(CTX_data_main(C));
+      DEG_id_tag_relations_update(CTX_data_main(C), ptr.owner_id);
 
       DEG_id_tag_update(ptr.owner_id, ID_RECALC_ANIMATION);
 
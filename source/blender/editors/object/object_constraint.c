@@ -1350,7 +1350,7 @@ void ED_object_constraint_dependency_update(Main *bmain, Object *ob)
   if (ob->pose) {
     object_pose_tag_update(bmain, ob);
   }
-  DEG_relations_tag_update(bmain);
+  DEG_id_tag_relations_update(bmain, &ob->id);
 }
 
 void ED_object_constraint_tag_update(Main *bmain, Object *ob, bConstraint *con)
@@ -1383,7 +1383,7 @@ void ED_object_constraint_dependency_tag_update(Main *bmain, Object *ob, bConstr
   if (ob->pose) {
     object_pose_tag_update(bmain, ob);
   }
-  DEG_relations_tag_update(bmain);
+  DEG_id_tag_relations_update(bmain, &ob->id);
 }
 
 bool ED_object_constraint_move_to_index(Object *ob, bConstraint *con, const int index)
@@ -2446,7 +2446,7 @@ static int constraint_add_exec(
   }
 
   /* force depsgraph to get recalculated since new relationships added */
-  DEG_relations_tag_update(bmain);
+  DEG_id_tag_relations_update(bmain, &ob->id);
 
   if ((ob->type == OB_ARMATURE) && (pchan)) {
     BKE_pose_tag_recalc(bmain, ob->pose); /* sort pose channels */
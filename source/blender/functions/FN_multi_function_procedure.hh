@@ -270,6 +270,13 @@ class MFProcedure : NonCopyable, NonMovable {
   MFDummyInstruction &new_dummy_instruction();
   MFReturnInstruction &new_return_instruction();
 
+  /**
+   * Remove a call or destruct instruction from the procedure. It must not be the next instruction
+   * of any other instruction anymore. This is used by optimization passes that replace
+   * instructions.
+   */
+  void delete_instruction(MFInstruction &instruction);
+
   void add_parameter(MFParamType::InterfaceType interface_type, MFVariable &variable);
   Span<ConstMFParameter> params() const;
 
@@ -44,4 +44,24 @@ namespace blender::fn::procedure_optimization {
  */
 void move_destructs_up(MFProcedure &procedure, MFInstruction &block_end_instr);
 
+/**
+ * When a procedure is executed, every call instruction is evaluated for the entire mask before the
+ * next instruction starts. For long chains of cheap element-wise functions (e.g. field math), that
+ * is bound by memory bandwidth, because every intermediate variable is a buffer for all indices
+ * which is written by one function and read again by the next.
+ *
+ * This optimization pass replaces chains of consecutive call instructions, whose functions only
+ * have single value parameters, with a single call of a fused function. That function evaluates
+ * the original functions one after another on small chunks of the mask, so the buffers of
+ * intermediate variables only have to hold a chunk and stay in the CPU cache.
+ *
+ * Calls without inputs (e.g. constants) are moved in front of the fused call instead of being
+ * fused, so their outputs can still be passed on as single values.
+ *
+ * Like #move_destructs_up, this only works on the linear chain of instructions starting at the
+ * entry of the procedure, and it is best to run it after #move_destructs_up, because variables
+ * that are destructed within a chain don't have to be outputs of the fused function.
+ */
+void fuse_element_wise_calls(MFProcedure &procedure);
+
 }  // namespace blender::fn::procedure_optimization
@@ -0,0 +1,116 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup fn
+ *
+ * Vectorized execution of simple element-wise math operations on float and float3 values.
+ *
+ * When the mask is a range and all inputs are spans or single values, the values can be
+ * processed as one flat array of floats, so a float3 addition is the same kernel as a float
+ * addition with three times as many elements. Other cases fall back to the element-wise
+ * implementation of #CustomMF_SI_SI_SO.
+ */
+
+#include <optional>
+
+#include "BLI_math_vec_types.hh"
+
+#include "FN_multi_function_builder.hh"
+
+namespace blender::fn {
+
+/** Element-wise operations with two inputs that have a vectorized implementation. */
+enum class SimdBinaryOperation {
+  Add,
+  Subtract,
+  Multiply,
+  /** Like #safe_divide, division by zero results in zero. */
+  SafeDivide,
+  Minimum,
+  Maximum,
+};
+
+/**
+ * Size of the repeated pattern used for single input values. It's a multiple of the number of
+ * floats in all supported types and of the SIMD register width, so every register is loaded from
+ * the same position in the pattern for every block.
+ */
+static constexpr int64_t SIMD_PATTERN_SIZE = 12;
+
+struct SimdFloatInput {
+  /** Either contiguous input values, or #SIMD_PATTERN_SIZE values that are repeated. */
+  const float *data;
+  bool is_pattern;
+};
+
+/**
+ * Compute `size` floats of the operation into \a r_out, which may alias one of the inputs.
+ */
+void simd_binary_operation(SimdBinaryOperation operation,
+                           SimdFloatInput a,
+                           SimdFloatInput b,
+                           float *r_out,
+                           int64_t size);
+
+/**
+ * Same as #CustomMF_SI_SI_SO with the same type for all parameters, but evaluates \a operation
+ * with #simd_binary_operation when possible. Without an operation this behaves exactly like the
+ * base class, which allows using this class for all operations of a node.
+ */
+template<typename T> class CustomMF_SI_SI_SO_Simd : public CustomMF_SI_SI_SO<T, T, T> {
+ private:
+  static_assert(std::is_same_v<T, float> || std::is_same_v<T, float3>);
+  static constexpr int64_t FloatsPerElement = sizeof(T) / sizeof(float);
+  std::optional<SimdBinaryOperation> operation_;
+
+ public:
+  template<typename ElementFuncT>
+  CustomMF_SI_SI_SO_Simd(const char *name,
+                         ElementFuncT element_fn,
+                         const std::optional<SimdBinaryOperation> operation)
+      : CustomMF_SI_SI_SO<T, T, T>(name, element_fn), operation_(operation)
+  {
+  }
+
+  void call(IndexMask mask, MFParams params, MFContext context) const override
+  {
+    if (operation_.has_value() && mask.is_range()) {
+      const VArray<T> &in1 = params.readonly_single_input<T>(0);
+      const VArray<T> &in2 = params.readonly_single_input<T>(1);
+      if ((in1.is_span() || in1.is_single()) && (in2.is_span() || in2.is_single())) {
+        const IndexRange range = mask.as_range();
+        MutableSpan<T> out1 = params.uninitialized_single_output<T>(2);
+        float pattern1[SIMD_PATTERN_SIZE];
+        float pattern2[SIMD_PATTERN_SIZE];
+        simd_binary_operation(*operation_,
+                              simd_input(in1, range, pattern1),
+                              simd_input(in2, range, pattern2),
+                              reinterpret_cast<float *>(out1.data() + range.start()),
+                              range.size() * FloatsPerElement);
+        return;
+      }
+    }
+    CustomMF_SI_SI_SO<T, T, T>::call(mask, params, context);
+  }
+
+ private:
+  static SimdFloatInput simd_input(const VArray<T> &varray,
+                                   const IndexRange range,
+                                   float (&r_pattern)[SIMD_PATTERN_SIZE])
+  {
+    if (varray.is_single()) {
+      const T value = varray.get_internal_single();
+      const float *value_floats = reinterpret_cast<const float *>(&value);
+      for (const int64_t i : IndexRange(SIMD_PATTERN_SIZE)) {
+        r_pattern[i] = value_floats[i % FloatsPerElement];
+      }
+      return {r_pattern, true};
+    }
+    const Span<T> span = varray.get_internal_span();
+    return {reinterpret_cast<const float *>(span.data() + range.start()), false};
+  }
+};
+
+}  // namespace blender::fn
@@ -269,11 +269,104 @@ static void build_multi_function_procedure_for_fields(MFProcedure &procedure,
   MFReturnInstruction &return_instr = builder.add_return();
 
   procedure_optimization::move_destructs_up(procedure, return_instr);
+  procedure_optimization::fuse_element_wise_calls(procedure);
 
   // std::cout << procedure.to_dot() << "\n";
   BLI_assert(procedure.validate());
 }
 
+/**
+ * Number of indices that are evaluated at once by #evaluate_procedure_chunk. It is chosen so that
+ * the values of all variables of the procedure for one chunk roughly fit into the L2 cache. Then
+ * values are still cached when they are used by the next function or copied to the destination.
+ */
+static int64_t compute_procedure_chunk_size(const MFProcedure &procedure)
+{
+  /* Conservative estimate of the L2 cache size available to every core. */
+  const int64_t cache_size = 256 * 1024;
+  int64_t bytes_per_index = 0;
+  for (const MFVariable *variable : procedure.variables()) {
+    const MFDataType data_type = variable->data_type();
+    if (data_type.is_single()) {
+      bytes_per_index += data_type.single_type().size();
+    }
+  }
+  /* Smaller chunks have too much overhead for the procedure and larger chunks don't improve the
+   * performance of the individual functions much anymore. */
+  return std::clamp<int64_t>(cache_size / std::max<int64_t>(bytes_per_index, 1), 1024, 16384);
+}
+
+/**
+ * Evaluate the procedure for the indices in one chunk of the mask. The indices are offset, so that
+ * the procedure only has to allocate chunk-sized buffers for intermediate values. Outputs without
+ * an output buffer are computed into a temporary buffer and moved to their destination right
+ * away, which avoids allocating a buffer for the entire output and copying it in a second pass.
+ *
+ * When the chunk contains the entire mask, the indices are not offset and the procedure is called
+ * with #MultiFunction::call_auto, like it is done without chunking.
+ */
+static void evaluate_procedure_chunk(const MFProcedureExecutor &procedure_executor,
+                                     const IndexMask mask,
+                                     const IndexRange chunk,
+                                     const Span<GVArray> inputs,
+                                     const Span<const CPPType *> output_types,
+                                     const Span<void *> output_buffers,
+                                     const MutableSpan<GVMutableArray> output_dst_varrays)
+{
+  const bool is_entire_mask = chunk == mask.index_range();
+  Vector<int64_t> offset_mask_indices;
+  const IndexMask offset_mask = is_entire_mask ?
+                                    mask :
+                                    mask.slice_and_offset(chunk, offset_mask_indices);
+  const int64_t offset = is_entire_mask ? 0 : mask[chunk.start()];
+  const IndexRange slice_range{offset, offset_mask.min_array_size()};
+
+  LinearAllocator<> allocator;
+  MFParamsBuilder mf_params{procedure_executor, slice_range.size()};
+  MFContextBuilder mf_context;
+
+  for (const GVArray &varray : inputs) {
+    if (is_entire_mask) {
+      mf_params.add_readonly_single_input(varray);
+    }
+    else {
+      mf_params.add_readonly_single_input(varray.slice(slice_range));
+    }
+  }
+
+  Array<void *> chunk_buffers(output_types.size(), nullptr);
+  for (const int i : output_types.index_range()) {
+    const CPPType &type = *output_types[i];
+    if (output_buffers[i] != nullptr) {
+      void *buffer = POINTER_OFFSET(output_buffers[i], type.size() * offset);
+      mf_params.add_uninitialized_single_output({type, buffer, slice_range.size()});
+    }
+    else {
+      chunk_buffers[i] = allocator.allocate(type.size() * slice_range.size(), type.alignment());
+      mf_params.add_uninitialized_single_output({type, chunk_buffers[i], slice_range.size()});
+    }
+  }
+
+  if (is_entire_mask) {
+    procedure_executor.call_auto(offset_mask, mf_params, mf_context);
+  }
+  else {
+    procedure_executor.call(offset_mask, mf_params, mf_context);
+  }
+
+  for (const int i : output_types.index_range()) {
+    void *buffer = chunk_buffers[i];
+    if (buffer == nullptr) {
+      continue;
+    }
+    const CPPType &type = *output_types[i];
+    GVMutableArray &dst_varray = output_dst_varrays[i];
+    offset_mask.foreach_index([&](const int64_t index) {
+      dst_varray.set_by_relocate(offset + index, POINTER_OFFSET(buffer, type.size() * index));
+    });
+  }
+}
+
 Vector<GVArray> evaluate_fields(ResourceScope &scope,
                                 Span<GFieldRef> fields_to_evaluate,
                                 IndexMask mask,
@@ -369,25 +462,24 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
         procedure, scope, field_tree_info, varying_fields_to_evaluate);
     MFProcedureExecutor procedure_executor{procedure};
 
-    MFParamsBuilder mf_params{procedure_executor, &mask};
-    MFContextBuilder mf_context;
-
-    /* Provide inputs to the procedure executor. */
-    for (const GVArray &varray : field_context_inputs) {
-      mf_params.add_readonly_single_input(varray);
-    }
+    /* Buffers that the procedure writes the outputs into. Outputs without a buffer are moved to
+     * their destination virtual array chunk by chunk. */
+    Array<const CPPType *> output_types(varying_fields_to_evaluate.size());
+    Array<void *> output_buffers(varying_fields_to_evaluate.size(), nullptr);
+    Array<GVMutableArray> output_dst_varrays(varying_fields_to_evaluate.size());
 
     for (const int i : varying_fields_to_evaluate.index_range()) {
       const GFieldRef &field = varying_fields_to_evaluate[i];
       const CPPType &type = field.cpp_type();
       const int out_index = varying_field_indices[i];
+      output_types[i] = &type;
 
       /* Try to get an existing virtual array that the result should be written into. */
       GVMutableArray dst_varray = get_dst_varray(out_index);
-      void *buffer;
-      if (!dst_varray || !dst_varray.is_span()) {
+      if (!dst_varray) {
         /* Allocate a new buffer for the computed result. */
-        buffer = scope.linear_allocator().allocate(type.size() * array_size, type.alignment());
+        void *buffer = scope.linear_allocator().allocate(type.size() * array_size,
+                                                         type.alignment());
 
         if (!type.is_trivially_destructible()) {
           /* Destruct values in the end. */
@@ -395,22 +487,49 @@ Vector<GVArray> evaluate_fields(ResourceScope &scope,
               [buffer, mask, &type]() { type.destruct_indices(buffer, mask); });
         }
 
+        output_buffers[i] = buffer;
         r_varrays[out_index] = GVArray::ForSpan({type, buffer, array_size});
       }
       else {
-        /* Write the result into the existing span. */
-        buffer = dst_varray.get_internal_span().data();
-
+        if (dst_varray.is_span()) {
+          /* Write the result into the existing span. */
+          output_buffers[i] = dst_varray.get_internal_span().data();
+        }
+        else {
+          /* Move the result into the destination after each chunk. */
+          output_dst_varrays[i] = dst_varray;
+        }
         r_varrays[out_index] = dst_varray;
         is_output_written_to_dst[out_index] = true;
       }
-
-      /* Pass output buffer to the procedure executor. */
-      const GMutableSpan span{type, buffer, array_size};
-      mf_params.add_uninitialized_single_output(span);
     }
 
-    procedure_executor.call_auto(mask, mf_params, mf_context);
+    /* Evaluate the procedure in cache-sized chunks. */
+    const int64_t chunk_size = compute_procedure_chunk_size(procedure);
+    if (mask.size() <= chunk_size) {
+      evaluate_procedure_chunk(procedure_executor,
+                               mask,
+                               mask.index_range(),
+                               field_context_inputs,
+                               output_types,
+                               output_buffers,
+                               output_dst_varrays);
+    }
+    else {
+      threading::parallel_for(mask.index_range(), chunk_size, [&](const IndexRange range) {
+        /* The grain size is only the minimum size of the ranges, so split them up further. */
+        for (int64_t start = range.start(); start < range.one_after_last(); start += chunk_size) {
+          const IndexRange chunk{start, std::min(chunk_size, range.one_after_last() - start)};
+          evaluate_procedure_chunk(procedure_executor,
+                                   mask,
+                                   chunk,
+                                   field_context_inputs,
+                                   output_types,
+                                   output_buffers,
+                                   output_dst_varrays);
+        }
+      });
+    }
   }
 
   /* Evaluate constant fields if necessary. */
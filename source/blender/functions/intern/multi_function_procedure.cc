@@ -221,6 +221,35 @@ MFReturnInstruction &MFProcedure::new_return_instruction()
   return instruction;
 }
 
+void MFProcedure::delete_instruction(MFInstruction &instruction)
+{
+  BLI_assert(instruction.prev().is_empty());
+  switch (instruction.type()) {
+    case MFInstructionType::Call: {
+      MFCallInstruction &call_instr = static_cast<MFCallInstruction &>(instruction);
+      for (const int param_index : call_instr.params_.index_range()) {
+        call_instr.set_param_variable(param_index, nullptr);
+      }
+      call_instr.set_next(nullptr);
+      call_instructions_.remove_first_occurrence_and_reorder(&call_instr);
+      call_instr.~MFCallInstruction();
+      break;
+    }
+    case MFInstructionType::Destruct: {
+      MFDestructInstruction &destruct_instr = static_cast<MFDestructInstruction &>(instruction);
+      destruct_instr.set_variable(nullptr);
+      destruct_instr.set_next(nullptr);
+      destruct_instructions_.remove_first_occurrence_and_reorder(&destruct_instr);
+      destruct_instr.~MFDestructInstruction();
+      break;
+    }
+    default: {
+      BLI_assert_unreachable();
+      break;
+    }
+  }
+}
+
 void MFProcedure::add_parameter(MFParamType::InterfaceType interface_type, MFVariable &variable)
 {
   params_.append({interface_type, &variable});
@@ -2,6 +2,10 @@
 
 #include "FN_multi_function_procedure_optimization.hh"
 
+#include "BLI_linear_allocator.hh"
+#include "BLI_set.hh"
+#include "BLI_vector_set.hh"
+
 namespace blender::fn::procedure_optimization {
 
 void move_destructs_up(MFProcedure &procedure, MFInstruction &block_end_instr)
@@ -73,4 +77,433 @@ void move_destructs_up(MFProcedure &procedure, MFInstruction &block_end_instr)
   }
 }
 
+namespace {
+
+/**
+ * Evaluates a chain of element-wise multi-functions on chunks of the mask. The parameters of the
+ * fused function are the inputs of the chain followed by its outputs. Values that are only used
+ * within the chain are stored in buffers that are large enough for one chunk.
+ */
+class FusedMultiFunction : public MultiFunction {
+ public:
+  enum class ValueSource {
+    Input,
+    Output,
+    Intermediate,
+  };
+
+  /** Where the value passed to a parameter of one of the fused functions is stored. */
+  struct ValueRef {
+    ValueSource source;
+    /** Index of the input, output or intermediate value. */
+    int index;
+  };
+
+  struct FusedCall {
+    const MultiFunction *fn;
+    /** Value for every parameter of the function. */
+    Vector<ValueRef> values;
+  };
+
+ private:
+  /** Number of indices evaluated at once, chosen so that a few buffers fit in the L2 cache. */
+  static constexpr int64_t ChunkSize = 1024;
+
+  MFSignature signature_;
+  Vector<FusedCall> calls_;
+  Vector<const CPPType *> intermediate_types_;
+  int inputs_num_;
+  int outputs_num_;
+
+ public:
+  FusedMultiFunction(Vector<FusedCall> calls,
+                     Span<const CPPType *> input_types,
+                     Span<const CPPType *> output_types,
+                     Vector<const CPPType *> intermediate_types)
+      : calls_(std::move(calls)),
+        intermediate_types_(std::move(intermediate_types)),
+        inputs_num_(input_types.size()),
+        outputs_num_(output_types.size())
+  {
+    MFSignatureBuilder signature{"Fused"};
+    for (const CPPType *type : input_types) {
+      signature.single_input("Input", *type);
+    }
+    for (const CPPType *type : output_types) {
+      signature.single_output("Output", *type);
+    }
+    for (const FusedCall &call : calls_) {
+      if (call.fn->depends_on_context()) {
+        signature.depends_on_context();
+      }
+    }
+    signature_ = signature.build();
+    this->set_signature(&signature_);
+  }
+
+  std::string debug_name() const override
+  {
+    std::string name = "Fused";
+    for (const FusedCall &call : calls_) {
+      name += " " + call.fn->debug_name();
+    }
+    return name;
+  }
+
+  void call(IndexMask mask, MFParams params, MFContext context) const override
+  {
+    /* Buffers are allocated once and reused for every chunk. Buffers for inputs and outputs are
+     * only needed when a chunk of the mask is not a range. Small masks only need small buffers. */
+    const int64_t buffer_size = std::min(mask.size(), ChunkSize);
+    LinearAllocator<> allocator;
+    auto allocate_buffers = [&](auto get_type, const int buffers_num) {
+      Array<void *> buffers(buffers_num);
+      for (const int i : IndexRange(buffers_num)) {
+        const CPPType &type = get_type(i);
+        buffers[i] = allocator.allocate(type.size() * buffer_size, type.alignment());
+      }
+      return buffers;
+    };
+    const Array<void *> intermediate_buffers = allocate_buffers(
+        [&](const int i) -> const CPPType & { return *intermediate_types_[i]; },
+        intermediate_types_.size());
+    Array<void *> input_buffers;
+    Array<void *> output_buffers;
+    if (!mask.is_range()) {
+      input_buffers = allocate_buffers(
+          [&](const int i) -> const CPPType & { return params.readonly_single_input(i).type(); },
+          inputs_num_);
+      output_buffers = allocate_buffers(
+          [&](const int i) -> const CPPType & {
+            return this->param_type(inputs_num_ + i).data_type().single_type();
+          },
+          outputs_num_);
+    }
+
+    Vector<GVArray> inputs(inputs_num_);
+    Vector<GMutableSpan> outputs;
+    for (int64_t chunk_start = 0; chunk_start < mask.size(); chunk_start += ChunkSize) {
+      const IndexMask chunk_mask = mask.slice(chunk_start,
+                                              std::min(ChunkSize, mask.size() - chunk_start));
+      const int64_t chunk_size = chunk_mask.size();
+      const bool is_range = chunk_mask.is_range();
+
+      /* Make inputs and outputs of the chunk accessible with indices starting at zero. Ranges
+       * can use the original data directly, other chunks are gathered into and scattered from
+       * the buffers. */
+      for (const int i : IndexRange(inputs_num_)) {
+        const GVArray &varray = params.readonly_single_input(i);
+        if (is_range) {
+          inputs[i] = varray.slice(chunk_mask.as_range());
+        }
+        else {
+          varray.materialize_compressed_to_uninitialized(chunk_mask, input_buffers[i]);
+          inputs[i] = GVArray::ForSpan(GSpan(varray.type(), input_buffers[i], chunk_size));
+        }
+      }
+      outputs.clear();
+      for (const int i : IndexRange(outputs_num_)) {
+        const GMutableSpan span = params.uninitialized_single_output(inputs_num_ + i);
+        outputs.append(is_range ? span.slice(chunk_mask.as_range()) :
+                                  GMutableSpan(span.type(), output_buffers[i], chunk_size));
+      }
+
+      for (const FusedCall &call : calls_) {
+        this->call_chunk(call, chunk_size, inputs, outputs, intermediate_buffers, context);
+      }
+
+      for (const int i : intermediate_types_.index_range()) {
+        intermediate_types_[i]->destruct_n(intermediate_buffers[i], chunk_size);
+      }
+      if (!is_range) {
+        for (const int i : IndexRange(inputs_num_)) {
+          inputs[i].type().destruct_n(input_buffers[i], chunk_size);
+        }
+        for (const int i : IndexRange(outputs_num_)) {
+          const GMutableSpan span = params.uninitialized_single_output(inputs_num_ + i);
+          const CPPType &type = span.type();
+          for (const int64_t j : IndexRange(chunk_size)) {
+            type.relocate_construct(POINTER_OFFSET(output_buffers[i], type.size() * j),
+                                    span[chunk_mask[j]]);
+          }
+        }
+      }
+    }
+  }
+
+ private:
+  void call_chunk(const FusedCall &call,
+                  const int64_t chunk_size,
+                  Span<GVArray> inputs,
+                  Span<GMutableSpan> outputs,
+                  Span<void *> intermediate_buffers,
+                  MFContext context) const
+  {
+    const MultiFunction &fn = *call.fn;
+    MFParamsBuilder params(fn, chunk_size);
+    for (const int param_index : fn.param_indices()) {
+      const MFParamType param_type = fn.param_type(param_index);
+      const ValueRef value = call.values[param_index];
+      if (value.source == ValueSource::Input) {
+        BLI_assert(param_type.interface_type() == MFParamType::Input);
+        params.add_readonly_single_input(inputs[value.index]);
+        continue;
+      }
+      const GMutableSpan span = (value.source == ValueSource::Output) ?
+                                    outputs[value.index] :
+                                    GMutableSpan(*intermediate_types_[value.index],
+                                                 intermediate_buffers[value.index],
+                                                 chunk_size);
+      if (param_type.interface_type() == MFParamType::Input) {
+        params.add_readonly_single_input(GSpan(span));
+      }
+      else {
+        params.add_uninitialized_single_output(span);
+      }
+    }
+    fn.call(IndexRange(chunk_size), params, context);
+  }
+
+  ExecutionHints get_execution_hints() const override
+  {
+    ExecutionHints hints;
+    for (const FusedCall &call : calls_) {
+      const ExecutionHints call_hints = call.fn->execution_hints();
+      hints.min_grain_size = std::min(hints.min_grain_size, call_hints.min_grain_size);
+      hints.uniform_execution_time &= call_hints.uniform_execution_time;
+    }
+    return hints;
+  }
+};
+
+}  // namespace
+
+static bool is_element_wise_call(const MFCallInstruction &call_instr)
+{
+  const MultiFunction &fn = call_instr.fn();
+  for (const int param_index : fn.param_indices()) {
+    const MFParamType param_type = fn.param_type(param_index);
+    if (!ELEM(param_type.category(), MFParamType::SingleInput, MFParamType::SingleOutput)) {
+      return false;
+    }
+    if (call_instr.params()[param_index] == nullptr) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Calls without inputs compute the same value for every index, they are not worth fusing. */
+static bool is_call_without_inputs(const MFCallInstruction &call_instr)
+{
+  const MultiFunction &fn = call_instr.fn();
+  if (fn.depends_on_context()) {
+    return false;
+  }
+  for (const int param_index : fn.param_indices()) {
+    if (fn.param_type(param_index).interface_type() == MFParamType::Input) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static void instruction_set_next(MFInstruction &instr, MFInstruction *next_instr)
+{
+  if (instr.type() == MFInstructionType::Call) {
+    static_cast<MFCallInstruction &>(instr).set_next(next_instr);
+  }
+  else {
+    static_cast<MFDestructInstruction &>(instr).set_next(next_instr);
+  }
+}
+
+static MFInstruction *instruction_next(MFInstruction &instr)
+{
+  if (instr.type() == MFInstructionType::Call) {
+    return static_cast<MFCallInstruction &>(instr).next();
+  }
+  return static_cast<MFDestructInstruction &>(instr).next();
+}
+
+/**
+ * Replace a chain of call and destruct instructions with a call to a #FusedMultiFunction.
+ */
+static void fuse_chain(MFProcedure &procedure, Span<MFInstruction *> chain)
+{
+  Vector<MFCallInstruction *> calls_to_fuse;
+  Vector<MFCallInstruction *> calls_to_move;
+  Set<MFVariable *> destructed_variables;
+  for (MFInstruction *instr : chain) {
+    if (instr->type() == MFInstructionType::Destruct) {
+      destructed_variables.add(static_cast<MFDestructInstruction *>(instr)->variable());
+      continue;
+    }
+    MFCallInstruction *call_instr = static_cast<MFCallInstruction *>(instr);
+    if (is_call_without_inputs(*call_instr)) {
+      calls_to_move.append(call_instr);
+    }
+    else {
+      calls_to_fuse.append(call_instr);
+    }
+  }
+  if (calls_to_fuse.size() < 2) {
+    return;
+  }
+
+  /* Find the variables that are passed into, passed out of, or only used within the chain. */
+  VectorSet<MFVariable *> inputs;
+  VectorSet<MFVariable *> outputs;
+  VectorSet<MFVariable *> intermediates;
+  for (MFCallInstruction *call_instr : calls_to_fuse) {
+    const MultiFunction &fn = call_instr->fn();
+    for (const int param_index : fn.param_indices()) {
+      MFVariable *variable = call_instr->params()[param_index];
+      if (fn.param_type(param_index).interface_type() == MFParamType::Input) {
+        if (!outputs.contains(variable) && !intermediates.contains(variable)) {
+          inputs.add(variable);
+        }
+      }
+      else if (destructed_variables.contains(variable)) {
+        intermediates.add(variable);
+      }
+      else {
+        outputs.add(variable);
+      }
+    }
+  }
+  for (MFVariable *variable : inputs) {
+    if (outputs.contains(variable) || intermediates.contains(variable)) {
+      /* The variable is initialized again within the chain, keep it simple and don't fuse. */
+      return;
+    }
+  }
+
+  auto get_type = [](const MFVariable *variable) {
+    return &variable->data_type().single_type();
+  };
+  Vector<FusedMultiFunction::FusedCall> fused_calls;
+  for (MFCallInstruction *call_instr : calls_to_fuse) {
+    fused_calls.append({&call_instr->fn(), {}});
+    FusedMultiFunction::FusedCall &fused_call = fused_calls.last();
+    for (MFVariable *variable : call_instr->params()) {
+      if (inputs.contains(variable)) {
+        fused_call.values.append(
+            {FusedMultiFunction::ValueSource::Input, int(inputs.index_of(variable))});
+      }
+      else if (outputs.contains(variable)) {
+        fused_call.values.append(
+            {FusedMultiFunction::ValueSource::Output, int(outputs.index_of(variable))});
+      }
+      else {
+        fused_call.values.append({FusedMultiFunction::ValueSource::Intermediate,
+                                  int(intermediates.index_of(variable))});
+      }
+    }
+  }
+  Vector<const CPPType *> input_types;
+  Vector<const CPPType *> output_types;
+  Vector<const CPPType *> intermediate_types;
+  for (const MFVariable *variable : inputs) {
+    input_types.append(get_type(variable));
+  }
+  for (const MFVariable *variable : outputs) {
+    output_types.append(get_type(variable));
+  }
+  for (const MFVariable *variable : intermediates) {
+    intermediate_types.append(get_type(variable));
+  }
+  const MultiFunction &fused_fn = procedure.construct_function<FusedMultiFunction>(
+      std::move(fused_calls), input_types, output_types, std::move(intermediate_types));
+  MFCallInstruction &fused_instr = procedure.new_call_instruction(fused_fn);
+  Vector<MFVariable *> fused_params;
+  fused_params.extend(inputs.as_span());
+  fused_params.extend(outputs.as_span());
+  fused_instr.set_params(fused_params);
+
+  /* Replace the chain with: the calls without inputs, the fused call and the destruct
+   * instructions of variables that are not initialized in the chain. */
+  Vector<MFInstruction *> new_chain;
+  for (MFCallInstruction *call_instr : calls_to_move) {
+    new_chain.append(call_instr);
+  }
+  new_chain.append(&fused_instr);
+  Vector<MFInstruction *> instructions_to_delete;
+  for (MFInstruction *instr : chain) {
+    if (instr->type() == MFInstructionType::Destruct) {
+      MFVariable *variable = static_cast<MFDestructInstruction *>(instr)->variable();
+      if (intermediates.contains(variable)) {
+        instructions_to_delete.append(instr);
+      }
+      else {
+        new_chain.append(instr);
+      }
+    }
+    else if (!calls_to_move.contains(static_cast<MFCallInstruction *>(instr))) {
+      instructions_to_delete.append(instr);
+    }
+  }
+
+  MFInstruction *chain_first = chain.first();
+  MFInstruction *after_chain = instruction_next(*chain.last());
+  for (MFInstruction *instr : chain) {
+    instruction_set_next(*instr, nullptr);
+  }
+  if (new_chain.first() != chain_first) {
+    while (!chain_first->prev().is_empty()) {
+      /* Copy the cursor, because #set_next changes the previous instructions. */
+      const MFInstructionCursor cursor = chain_first->prev()[0];
+      cursor.set_next(procedure, new_chain.first());
+    }
+  }
+  for (const int i : new_chain.index_range().drop_back(1)) {
+    instruction_set_next(*new_chain[i], new_chain[i + 1]);
+  }
+  instruction_set_next(*new_chain.last(), after_chain);
+  for (MFInstruction *instr : instructions_to_delete) {
+    procedure.delete_instruction(*instr);
+  }
+}
+
+void fuse_element_wise_calls(MFProcedure &procedure)
+{
+  Vector<MFInstruction *> chain;
+  MFInstruction *current_instr = procedure.entry();
+  while (current_instr != nullptr) {
+    MFInstruction *next_instr = nullptr;
+    bool extends_chain = false;
+    switch (current_instr->type()) {
+      case MFInstructionType::Call: {
+        MFCallInstruction &call_instr = static_cast<MFCallInstruction &>(*current_instr);
+        next_instr = call_instr.next();
+        extends_chain = is_element_wise_call(call_instr);
+        break;
+      }
+      case MFInstructionType::Destruct: {
+        next_instr = static_cast<MFDestructInstruction &>(*current_instr).next();
+        extends_chain = !chain.is_empty();
+        break;
+      }
+      case MFInstructionType::Dummy: {
+        next_instr = static_cast<MFDummyInstruction &>(*current_instr).next();
+        break;
+      }
+      case MFInstructionType::Branch:
+      case MFInstructionType::Return: {
+        /* Stop at the end of the linear chain of instructions. */
+        break;
+      }
+    }
+    if (extends_chain) {
+      chain.append(current_instr);
+    }
+    else {
+      fuse_chain(procedure, chain);
+      chain.clear();
+    }
+    current_instr = next_instr;
+  }
+  fuse_chain(procedure, chain);
+}
+
 }  // namespace blender::fn::procedure_optimization
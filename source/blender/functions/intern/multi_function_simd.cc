@@ -0,0 +1,112 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "FN_multi_function_simd.hh"
+
+#include "BLI_simd.h"
+#include "BLI_utildefines.h"
+
+namespace blender::fn {
+
+/**
+ * Apply the operation on blocks of #SIMD_PATTERN_SIZE floats with SIMD instructions, and on the
+ * remaining floats with the scalar version of the operation.
+ */
+template<typename ScalarFn, typename SimdFn>
+static void binary_operation_kernel(const SimdFloatInput a,
+                                    const SimdFloatInput b,
+                                    float *r_out,
+                                    const int64_t size,
+                                    const ScalarFn &scalar_fn,
+                                    const SimdFn &simd_fn)
+{
+  int64_t i = 0;
+#ifdef BLI_HAVE_SSE2
+  for (; i + SIMD_PATTERN_SIZE <= size; i += SIMD_PATTERN_SIZE) {
+    const float *a_block = a.is_pattern ? a.data : a.data + i;
+    const float *b_block = b.is_pattern ? b.data : b.data + i;
+    for (int64_t j = 0; j < SIMD_PATTERN_SIZE; j += 4) {
+      const __m128 a4 = _mm_loadu_ps(a_block + j);
+      const __m128 b4 = _mm_loadu_ps(b_block + j);
+      _mm_storeu_ps(r_out + i + j, simd_fn(a4, b4));
+    }
+  }
+#else
+  UNUSED_VARS(simd_fn);
+#endif
+  for (; i < size; i++) {
+    const float a1 = a.is_pattern ? a.data[i % SIMD_PATTERN_SIZE] : a.data[i];
+    const float b1 = b.is_pattern ? b.data[i % SIMD_PATTERN_SIZE] : b.data[i];
+    r_out[i] = scalar_fn(a1, b1);
+  }
+}
+
+void simd_binary_operation(const SimdBinaryOperation operation,
+                           const SimdFloatInput a,
+                           const SimdFloatInput b,
+                           float *r_out,
+                           const int64_t size)
+{
+  /* The SIMD functions are generic lambdas, so they are not instantiated without SSE2. */
+  switch (operation) {
+    case SimdBinaryOperation::Add:
+      binary_operation_kernel(
+          a,
+          b,
+          r_out,
+          size,
+          [](float x, float y) { return x + y; },
+          [](auto x, auto y) { return _mm_add_ps(x, y); });
+      break;
+    case SimdBinaryOperation::Subtract:
+      binary_operation_kernel(
+          a,
+          b,
+          r_out,
+          size,
+          [](float x, float y) { return x - y; },
+          [](auto x, auto y) { return _mm_sub_ps(x, y); });
+      break;
+    case SimdBinaryOperation::Multiply:
+      binary_operation_kernel(
+          a,
+          b,
+          r_out,
+          size,
+          [](float x, float y) { return x * y; },
+          [](auto x, auto y) { return _mm_mul_ps(x, y); });
+      break;
+    case SimdBinaryOperation::SafeDivide:
+      binary_operation_kernel(
+          a,
+          b,
+          r_out,
+          size,
+          [](float x, float y) { return (y == 0.0f) ? 0.0f : x / y; },
+          [](auto x, auto y) {
+            return _mm_andnot_ps(_mm_cmpeq_ps(y, _mm_xor_ps(y, y)), _mm_div_ps(x, y));
+          });
+      break;
+    case SimdBinaryOperation::Minimum:
+      /* Same as #math::min, `_mm_min_ps` returns the second argument when the first is not
+       * smaller. */
+      binary_operation_kernel(
+          a,
+          b,
+          r_out,
+          size,
+          [](float x, float y) { return x < y ? x : y; },
+          [](auto x, auto y) { return _mm_min_ps(x, y); });
+      break;
+    case SimdBinaryOperation::Maximum:
+      binary_operation_kernel(
+          a,
+          b,
+          r_out,
+          size,
+          [](float x, float y) { return x > y ? x : y; },
+          [](auto x, auto y) { return _mm_max_ps(x, y); });
+      break;
+  }
+}
+
+}  // namespace blender::fn
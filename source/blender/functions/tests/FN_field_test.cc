@@ -289,4 +289,55 @@ TEST(field, IgnoredOutput)
   EXPECT_EQ(results.get(3), 5);
 }
 
+struct IntWrapper {
+  int value;
+  int padding;
+};
+
+static int get_wrapped_int(const IntWrapper &wrapper)
+{
+  return wrapper.value;
+}
+
+static void set_wrapped_int(IntWrapper &wrapper, int value)
+{
+  wrapper.value = value;
+}
+
+TEST(field, ChunkedDestination)
+{
+  GField index_field{std::make_shared<IndexFieldInput>()};
+  std::unique_ptr<MultiFunction> add_fn = std::make_unique<CustomMF_SI_SI_SO<int, int, int>>(
+      "add", [](int a, int b) { return a + b; });
+  GField output_field{std::make_shared<FieldOperation>(
+                          FieldOperation(std::move(add_fn), {index_field, index_field})),
+                      0};
+
+  /* Use enough indices to be evaluated in multiple chunks, with a destination that is not a span,
+   * so that the result is moved to the destination after every chunk. */
+  const int size = 100000;
+  Vector<int64_t> indices;
+  for (int i = 5; i < size; i += 3) {
+    indices.append(i);
+  }
+  const IndexMask mask{indices};
+
+  Array<IntWrapper> result(size, {-1, 0});
+  FieldContext context;
+  FieldEvaluator evaluator{context, &mask};
+  evaluator.add_with_destination(
+      output_field,
+      VMutableArray<int>::ForDerivedSpan<IntWrapper, get_wrapped_int, set_wrapped_int>(result));
+  evaluator.evaluate();
+
+  for (const int i : IndexRange(size)) {
+    if (i >= 5 && (i - 5) % 3 == 0) {
+      EXPECT_EQ(result[i].value, i * 2);
+    }
+    else {
+      EXPECT_EQ(result[i].value, -1);
+    }
+  }
+}
+
 }  // namespace blender::fn::tests
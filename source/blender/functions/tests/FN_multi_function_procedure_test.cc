@@ -5,6 +5,7 @@
 #include "FN_multi_function_builder.hh"
 #include "FN_multi_function_procedure_builder.hh"
 #include "FN_multi_function_procedure_executor.hh"
+#include "FN_multi_function_procedure_optimization.hh"
 #include "FN_multi_function_test_common.hh"
 
 namespace blender::fn::tests {
@@ -378,4 +379,74 @@ TEST(multi_function_procedure, BufferReuse)
   EXPECT_EQ(results[4], 53);
 }
 
+TEST(multi_function_procedure, FuseElementWiseCalls)
+{
+  /**
+   * procedure(float var1, float *var5) {
+   *   var2 = 2.0f;
+   *   var3 = var1 * var2;
+   *   var4 = var3 + var1;
+   *   var5 = var4 - var2;
+   * }
+   */
+
+  CustomMF_Constant<float> constant_fn{2.0f};
+  CustomMF_SI_SI_SO<float, float, float> mul_fn{"mul", [](float a, float b) { return a * b; }};
+  CustomMF_SI_SI_SO<float, float, float> add_fn{"add", [](float a, float b) { return a + b; }};
+  CustomMF_SI_SI_SO<float, float, float> sub_fn{"sub", [](float a, float b) { return a - b; }};
+
+  MFProcedure procedure;
+  MFProcedureBuilder builder{procedure};
+
+  MFVariable *var1 = &builder.add_single_input_parameter<float>();
+  auto [var2] = builder.add_call<1>(constant_fn);
+  auto [var3] = builder.add_call<1>(mul_fn, {var1, var2});
+  auto [var4] = builder.add_call<1>(add_fn, {var3, var1});
+  auto [var5] = builder.add_call<1>(sub_fn, {var4, var2});
+  builder.add_destruct({var1, var2, var3, var4});
+  MFReturnInstruction &return_instr = builder.add_return();
+  builder.add_output_parameter(*var5);
+
+  procedure_optimization::move_destructs_up(procedure, return_instr);
+  procedure_optimization::fuse_element_wise_calls(procedure);
+  EXPECT_TRUE(procedure.validate());
+
+  /* The constant is moved before a single call of the fused function. */
+  MFCallInstruction *constant_instr = static_cast<MFCallInstruction *>(procedure.entry());
+  EXPECT_EQ(&constant_instr->fn(), &constant_fn);
+  MFCallInstruction *fused_instr = static_cast<MFCallInstruction *>(constant_instr->next());
+  EXPECT_EQ(fused_instr->type(), MFInstructionType::Call);
+  EXPECT_EQ(fused_instr->params().size(), 3);
+
+  MFProcedureExecutor executor{procedure};
+
+  /* Use more indices than are evaluated at once by the fused function. */
+  const int64_t size = 5000;
+  Array<float> inputs(size);
+  for (const int64_t i : inputs.index_range()) {
+    inputs[i] = float(i);
+  }
+  Vector<int64_t> mask_indices;
+  for (int64_t i = 1; i < size; i += 3) {
+    mask_indices.append(i);
+  }
+
+  for (const IndexMask mask : {IndexMask(size), IndexMask(mask_indices)}) {
+    Array<float> outputs(size, -1.0f);
+    MFParamsBuilder params{executor, &mask};
+    MFContextBuilder context;
+    params.add_readonly_single_input(inputs.as_span());
+    params.add_uninitialized_single_output(outputs.as_mutable_span());
+    executor.call(mask, params, context);
+
+    for (const int64_t i : mask) {
+      EXPECT_EQ(outputs[i], inputs[i] * 3.0f - 2.0f);
+    }
+    if (!mask.is_range()) {
+      EXPECT_EQ(outputs[0], -1.0f);
+      EXPECT_EQ(outputs[2], -1.0f);
+    }
+  }
+}
+
 }  // namespace blender::fn::tests
@@ -2,8 +2,11 @@
 
 #include "testing/testing.h"
 
+#include "BLI_math_vector.hh"
+
 #include "FN_multi_function.hh"
 #include "FN_multi_function_builder.hh"
+#include "FN_multi_function_simd.hh"
 #include "FN_multi_function_test_common.hh"
 
 namespace blender::fn::tests {
@@ -194,6 +197,50 @@ TEST(multi_function, CustomMF_SI_SI_SO)
   EXPECT_EQ(outputs[3], 90);
 }
 
+TEST(multi_function, CustomMF_SI_SI_SO_Simd)
+{
+  CustomMF_SI_SI_SO_Simd<float3> fn(
+      "div",
+      [](float3 a, float3 b) { return math::safe_divide(a, b); },
+      SimdBinaryOperation::SafeDivide);
+
+  Array<float3> values_a(15);
+  for (const int i : values_a.index_range()) {
+    values_a[i] = float3(i, i * 2, -i);
+  }
+  const float3 value_b(2.0f, 0.0f, 4.0f);
+
+  /* The range is long enough to use the vectorized code, and not a multiple of its block size. */
+  {
+    Array<float3> outputs(values_a.size(), float3(-1.0f));
+    MFParamsBuilder params(fn, values_a.size());
+    params.add_readonly_single_input(values_a.as_span());
+    params.add_readonly_single_input(&value_b);
+    params.add_uninitialized_single_output(outputs.as_mutable_span());
+    MFContextBuilder context;
+    fn.call(IndexRange(1, 14), params, context);
+
+    EXPECT_EQ(outputs[0], float3(-1.0f));
+    for (const int i : IndexRange(1, 14)) {
+      EXPECT_EQ(outputs[i], float3(i * 0.5f, 0.0f, i * -0.25f));
+    }
+  }
+  /* Masks which are not a range use the element-wise fallback. */
+  {
+    Array<float3> outputs(values_a.size(), float3(-1.0f));
+    MFParamsBuilder params(fn, values_a.size());
+    params.add_readonly_single_input(values_a.as_span());
+    params.add_readonly_single_input(&value_b);
+    params.add_uninitialized_single_output(outputs.as_mutable_span());
+    MFContextBuilder context;
+    fn.call({2, 5}, params, context);
+
+    EXPECT_EQ(outputs[1], float3(-1.0f));
+    EXPECT_EQ(outputs[2], float3(1.0f, 0.0f, -0.5f));
+    EXPECT_EQ(outputs[5], float3(2.5f, 0.0f, -1.25f));
+  }
+}
+
 TEST(multi_function, CustomMF_SI_SI_SI_SO)
 {
   CustomMF_SI_SI_SI_SO<int, std::string, bool, uint> fn{
@@ -0,0 +1,95 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+
+#include "testing/testing.h"
+
+#include "BLI_array.hh"
+#include "BLI_math_vector.hh"
+
+#include "FN_multi_function_simd.hh"
+
+#include "PIL_time.h"
+
+/* Compare the throughput of the element-wise #CustomMF_SI_SI_SO against the vectorized
+ * #CustomMF_SI_SI_SO_Simd, for every operation, with span and single value inputs. */
+
+namespace blender::fn::tests {
+
+static constexpr int64_t ELEMENTS_NUM = 10000000;
+static constexpr int RUNS_NUM = 10;
+
+template<typename T>
+static double run_function(const MultiFunction &fn, const Span<T> a, const VArray<T> &b)
+{
+  Array<T> result(a.size(), NoInitialization());
+  double best_time = DBL_MAX;
+  for (int run = 0; run < RUNS_NUM; run++) {
+    MFParamsBuilder params(fn, a.size());
+    params.add_readonly_single_input(a);
+    params.add_readonly_single_input(b);
+    params.add_uninitialized_single_output(result.as_mutable_span());
+    MFContextBuilder context;
+
+    const double start_time = PIL_check_seconds_timer();
+    fn.call(IndexRange(a.size()), params, context);
+    best_time = std::min(best_time, PIL_check_seconds_timer() - start_time);
+  }
+  return best_time;
+}
+
+template<typename T, typename ElementFuncT>
+static void compare_functions(const char *name,
+                              const SimdBinaryOperation operation,
+                              const ElementFuncT element_fn)
+{
+  const CustomMF_SI_SI_SO<T, T, T> scalar_fn{name, element_fn};
+  const CustomMF_SI_SI_SO_Simd<T> simd_fn{name, element_fn, operation};
+
+  Array<T> a(ELEMENTS_NUM);
+  Array<T> b(ELEMENTS_NUM);
+  for (const int64_t i : a.index_range()) {
+    a[i] = T(float(i % 1000) * 0.1f);
+    b[i] = T(float(i % 7) - 3.0f);
+  }
+
+  const VArray<T> b_span = VArray<T>::ForSpan(b);
+  const VArray<T> b_single = VArray<T>::ForSingle(T(2.0f), ELEMENTS_NUM);
+  const char *type_name = std::is_same_v<T, float> ? "float" : "float3";
+
+  for (const VArray<T> *b_varray : {&b_span, &b_single}) {
+    const double scalar_time = run_function(scalar_fn, a.as_span(), *b_varray);
+    const double simd_time = run_function(simd_fn, a.as_span(), *b_varray);
+    printf("%-8s %-6s %-6s scalar: %8.1f M/s, simd: %8.1f M/s (%.2fx)\n",
+           name,
+           type_name,
+           b_varray->is_single() ? "single" : "span",
+           ELEMENTS_NUM / scalar_time * 1e-6,
+           ELEMENTS_NUM / simd_time * 1e-6,
+           scalar_time / simd_time);
+  }
+}
+
+template<typename T> static void compare_all_operations()
+{
+  compare_functions<T>("Add", SimdBinaryOperation::Add, [](T a, T b) { return a + b; });
+  compare_functions<T>("Subtract", SimdBinaryOperation::Subtract, [](T a, T b) { return a - b; });
+  compare_functions<T>("Multiply", SimdBinaryOperation::Multiply, [](T a, T b) { return a * b; });
+  compare_functions<T>("Divide", SimdBinaryOperation::SafeDivide, [](T a, T b) {
+    return math::safe_divide(a, b);
+  });
+  compare_functions<T>(
+      "Minimum", SimdBinaryOperation::Minimum, [](T a, T b) { return math::min(a, b); });
+  compare_functions<T>(
+      "Maximum", SimdBinaryOperation::Maximum, [](T a, T b) { return math::max(a, b); });
+}
+
+TEST(multi_function_simd, Float)
+{
+  compare_all_operations<float>();
+}
+
+TEST(multi_function_simd, Float3)
+{
+  compare_all_operations<float3>();
+}
+
+}  // namespace blender::fn::tests
@@ -58,6 +58,7 @@ struct AttributeFallbacksArray {
    */
   Array<const void *> array;
 
+  AttributeFallbacksArray() = default;
   AttributeFallbacksArray(int size) : array(size, nullptr)
   {
   }
@@ -429,6 +430,196 @@ static void foreach_geometry_in_reference(
   }
 }
 
+static uint32_t get_instance_id(const GatherTasksInfo &gather_info,
+                                const Span<int> stored_instance_ids,
+                                const InstanceContext &base_instance_context,
+                                const int instance_index)
+{
+  uint32_t local_instance_id = 0;
+  if (gather_info.create_id_attribute_on_any_component) {
+    if (stored_instance_ids.is_empty()) {
+      local_instance_id = (uint32_t)instance_index;
+    }
+    else {
+      local_instance_id = (uint32_t)stored_instance_ids[instance_index];
+    }
+  }
+  return noise::hash(base_instance_context.id, local_instance_id);
+}
+
+static AttributeFallbacksArray get_instance_attribute_fallbacks(
+    const AttributeFallbacksArray &base_fallbacks,
+    const Span<std::pair<int, GSpan>> attributes_to_override,
+    const int instance_index)
+{
+  AttributeFallbacksArray fallbacks;
+  fallbacks.array = base_fallbacks.array;
+  for (const std::pair<int, GSpan> &pair : attributes_to_override) {
+    fallbacks.array[pair.first] = pair.second[instance_index];
+  }
+  return fallbacks;
+}
+
+/**
+ * Realized data of an instance reference that doesn't contain nested instances or volumes. The
+ * tasks for instances of such references are independent of each other, so they can be created
+ * in parallel.
+ */
+struct FlatInstanceReference {
+  const MeshRealizeInfo *mesh_info = nullptr;
+  const PointCloudRealizeInfo *pointcloud_info = nullptr;
+  const RealizeCurveInfo *curve_info = nullptr;
+};
+
+static std::optional<FlatInstanceReference> get_flat_instance_reference(
+    const GatherTasksInfo &gather_info, const InstanceReference &reference)
+{
+  GeometrySet geometry_set;
+  switch (reference.type()) {
+    case InstanceReference::Type::Object:
+      geometry_set = object_get_evaluated_geometry_set(reference.object());
+      break;
+    case InstanceReference::Type::GeometrySet:
+      geometry_set = reference.geometry_set();
+      break;
+    case InstanceReference::Type::None:
+      return FlatInstanceReference();
+    case InstanceReference::Type::Collection:
+      return std::nullopt;
+  }
+  if (geometry_set.has_instances() || geometry_set.has<VolumeComponent>()) {
+    return std::nullopt;
+  }
+
+  /* The realize info is owned by #gather_info and stays valid after the geometry set is freed.
+   * The conditions match #gather_realize_tasks_recursive. */
+  FlatInstanceReference flat_reference;
+  if (const Mesh *mesh = geometry_set.get_mesh_for_read()) {
+    if (mesh->totvert > 0) {
+      flat_reference.mesh_info =
+          &gather_info.meshes.realize_info[gather_info.meshes.order.index_of(mesh)];
+    }
+  }
+  if (const PointCloud *pointcloud = geometry_set.get_pointcloud_for_read()) {
+    if (pointcloud->totpoint > 0) {
+      flat_reference.pointcloud_info =
+          &gather_info.pointclouds.realize_info[gather_info.pointclouds.order.index_of(pointcloud)];
+    }
+  }
+  if (const Curves *curves = geometry_set.get_curves_for_read()) {
+    if (curves->geometry.curve_size > 0) {
+      flat_reference.curve_info =
+          &gather_info.curves.realize_info[gather_info.curves.order.index_of(curves)];
+    }
+  }
+  return flat_reference;
+}
+
+/** Creating the tasks in parallel only pays off when there are many instances. */
+static constexpr int64_t flat_instances_threshold = 1024;
+
+/**
+ * Gather the tasks for many instances of references without nested instances. The output offsets
+ * of all instances are computed up front, everything else is done in parallel.
+ * \return False when some references contain nested instances, the tasks have to be gathered
+ * recursively then.
+ */
+static bool gather_realize_tasks_for_flat_instances(
+    GatherTasksInfo &gather_info,
+    const InstancesComponent &instances_component,
+    const float4x4 &base_transform,
+    const InstanceContext &base_instance_context,
+    const Span<int> stored_instance_ids,
+    const Span<std::pair<int, GSpan>> pointcloud_attributes_to_override,
+    const Span<std::pair<int, GSpan>> mesh_attributes_to_override,
+    const Span<std::pair<int, GSpan>> curve_attributes_to_override)
+{
+  const Span<InstanceReference> references = instances_component.references();
+  const Span<int> handles = instances_component.instance_reference_handles();
+  const Span<float4x4> transforms = instances_component.instance_transforms();
+
+  Array<FlatInstanceReference> flat_references(references.size());
+  for (const int i : references.index_range()) {
+    std::optional<FlatInstanceReference> flat_reference = get_flat_instance_reference(
+        gather_info, references[i]);
+    if (!flat_reference) {
+      return false;
+    }
+    flat_references[i] = *flat_reference;
+  }
+
+  GatherTasks &tasks = gather_info.r_tasks;
+  GatherOffsets &offsets = gather_info.r_offsets;
+  const int64_t pointcloud_tasks_start = tasks.pointcloud_tasks.size();
+  const int64_t mesh_tasks_start = tasks.mesh_tasks.size();
+  const int64_t curve_tasks_start = tasks.curve_tasks.size();
+  Vector<int> pointcloud_instances;
+  Vector<int> mesh_instances;
+  Vector<int> curve_instances;
+
+  /* Compute the output offsets of all instances. This has to be done serially, but is cheap
+   * compared to creating the tasks. */
+  for (const int i : transforms.index_range()) {
+    const FlatInstanceReference &flat_reference = flat_references[handles[i]];
+    if (const MeshRealizeInfo *mesh_info = flat_reference.mesh_info) {
+      const Mesh &mesh = *mesh_info->mesh;
+      tasks.mesh_tasks.append({offsets.mesh_offsets, mesh_info, {}, {}, 0});
+      mesh_instances.append(i);
+      offsets.mesh_offsets.vertex += mesh.totvert;
+      offsets.mesh_offsets.edge += mesh.totedge;
+      offsets.mesh_offsets.loop += mesh.totloop;
+      offsets.mesh_offsets.poly += mesh.totpoly;
+    }
+    if (const PointCloudRealizeInfo *pointcloud_info = flat_reference.pointcloud_info) {
+      tasks.pointcloud_tasks.append({offsets.pointcloud_offset, pointcloud_info, {}, {}, 0});
+      pointcloud_instances.append(i);
+      offsets.pointcloud_offset += pointcloud_info->pointcloud->totpoint;
+    }
+    if (const RealizeCurveInfo *curve_info = flat_reference.curve_info) {
+      const Curves &curves = *curve_info->curves;
+      tasks.curve_tasks.append({offsets.curves_offsets, curve_info, {}, {}, 0});
+      curve_instances.append(i);
+      offsets.curves_offsets.point += curves.geometry.point_size;
+      offsets.curves_offsets.curve += curves.geometry.curve_size;
+    }
+  }
+
+  /* Fill in the transforms, ids and attribute fallbacks of the new tasks. */
+  auto fill_tasks = [&](auto &type_tasks,
+                        const int64_t tasks_start,
+                        const Span<int> instance_indices,
+                        const AttributeFallbacksArray &base_fallbacks,
+                        const Span<std::pair<int, GSpan>> attributes_to_override) {
+    threading::parallel_for(instance_indices.index_range(), 1024, [&](const IndexRange range) {
+      for (const int i : range) {
+        const int instance_index = instance_indices[i];
+        auto &task = type_tasks[tasks_start + i];
+        task.transform = base_transform * transforms[instance_index];
+        task.attribute_fallbacks = get_instance_attribute_fallbacks(
+            base_fallbacks, attributes_to_override, instance_index);
+        task.id = get_instance_id(
+            gather_info, stored_instance_ids, base_instance_context, instance_index);
+      }
+    });
+  };
+  fill_tasks(tasks.mesh_tasks,
+             mesh_tasks_start,
+             mesh_instances,
+             base_instance_context.meshes,
+             mesh_attributes_to_override);
+  fill_tasks(tasks.pointcloud_tasks,
+             pointcloud_tasks_start,
+             pointcloud_instances,
+             base_instance_context.pointclouds,
+             pointcloud_attributes_to_override);
+  fill_tasks(tasks.curve_tasks,
+             curve_tasks_start,
+             curve_instances,
+             base_instance_context.curves,
+             curve_attributes_to_override);
+  return true;
+}
+
 static void gather_realize_tasks_for_instances(GatherTasksInfo &gather_info,
                                                const InstancesComponent &instances_component,
                                                const float4x4 &base_transform,
@@ -455,6 +646,18 @@ static void gather_realize_tasks_for_instances(GatherTasksInfo &gather_info,
   Vector<std::pair<int, GSpan>> curve_attributes_to_override = prepare_attribute_fallbacks(
       gather_info, instances_component, gather_info.curves.attributes);
 
+  if (transforms.size() >= flat_instances_threshold &&
+      gather_realize_tasks_for_flat_instances(gather_info,
+                                              instances_component,
+                                              base_transform,
+                                              base_instance_context,
+                                              stored_instance_ids,
+                                              pointcloud_attributes_to_override,
+                                              mesh_attributes_to_override,
+                                              curve_attributes_to_override)) {
+    return;
+  }
+
   for (const int i : transforms.index_range()) {
     const int handle = handles[i];
     const float4x4 &transform = transforms[i];
@@ -472,16 +675,8 @@ static void gather_realize_tasks_for_instances(GatherTasksInfo &gather_info,
       instance_context.curves.array[pair.first] = pair.second[i];
     }
 
-    uint32_t local_instance_id = 0;
-    if (gather_info.create_id_attribute_on_any_component) {
-      if (stored_instance_ids.is_empty()) {
-        local_instance_id = (uint32_t)i;
-      }
-      else {
-        local_instance_id = (uint32_t)stored_instance_ids[i];
-      }
-    }
-    const uint32_t instance_id = noise::hash(base_instance_context.id, local_instance_id);
+    const uint32_t instance_id = get_instance_id(
+        gather_info, stored_instance_ids, base_instance_context, i);
 
     /* Add realize tasks for all referenced geometry sets recursively. */
     foreach_geometry_in_reference(reference,
@@ -16,6 +16,7 @@ extern "C" {
 #endif
 
 struct AnonymousAttributeID;
+struct ImplicitSharingInfo;
 
 /** Descriptor and storage for a custom data layer. */
 typedef struct CustomDataLayer {
@@ -46,6 +47,11 @@ typedef struct CustomDataLayer {
    * automatically.
    */
   const struct AnonymousAttributeID *anonymous_id;
+  /**
+   * Run-time user count of the layer data, which may be shared between multiple layers after
+   * copying. Only set for layers that own their data, see #CD_FLAG_NOFREE.
+   */
+  const struct ImplicitSharingInfo *sharing_info;
 } CustomDataLayer;
 
 #define MAX_CUSTOMDATA_LAYER_NAME 64
@@ -2287,14 +2287,31 @@ typedef struct NodesModifierData {
   struct bNodeTree *node_group;
   struct NodesModifierSettings settings;
 
+  /** #NodesModifierFlag. */
+  int flag;
+  /** Memory the cache of node outputs may use, in megabytes. */
+  int cache_memory_limit;
+
   /**
    * Contains logged information from the last evaluation.
    * This can be used to help the user to debug a node tree.
    */
   void *runtime_eval_log;
-  void *_pad1;
+  /** Outputs of nodes from previous evaluations, see #GeometryNodesCache. */
+  void *runtime_cache;
+  /**
+   * #GeometryNodeStatistics of the nodes, sorted by node path. Entries are updated in place after
+   * every evaluation and only freed with the modifier, so that they can be accessed from Python.
+   */
+  ListBase runtime_node_statistics;
 } NodesModifierData;
 
+/** #NodesModifierData.flag */
+typedef enum NodesModifierFlag {
+  /** Keep the outputs of nodes to reuse them in later evaluations, see #GeometryNodesCache. */
+  NODES_MODIFIER_USE_CACHE = (1 << 0),
+} NodesModifierFlag;
+
 typedef struct MeshToVolumeModifierData {
   ModifierData modifier;
 
@@ -252,6 +252,8 @@ static void rna_Attribute_data_begin(CollectionPropertyIterator *iter, PointerRN
       break;
   }
 
+  /* The values may be written to through the iterator. */
+  CustomData_ensure_layer_not_shared(layer);
   rna_iterator_array_begin(iter, layer->data, struct_size, length, 0, NULL);
 }
 
@@ -801,6 +801,7 @@ static void rna_MeshVertColorLayer_data_begin(CollectionPropertyIterator *iter,
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
+  CustomData_ensure_layer_not_shared(layer);
   rna_iterator_array_begin(
       iter, layer->data, sizeof(MPropCol), (me->edit_mesh) ? 0 : me->totvert, 0, NULL);
 }
@@ -1386,6 +1387,7 @@ static void rna_MeshVertexFloatPropertyLayer_data_begin(CollectionPropertyIterat
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
+  CustomData_ensure_layer_not_shared(layer);
   rna_iterator_array_begin(iter, layer->data, sizeof(MFloatProperty), me->totvert, 0, NULL);
 }
 static void rna_MeshPolygonFloatPropertyLayer_data_begin(CollectionPropertyIterator *iter,
@@ -1393,6 +1395,7 @@ static void rna_MeshPolygonFloatPropertyLayer_data_begin(CollectionPropertyItera
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
+  CustomData_ensure_layer_not_shared(layer);
   rna_iterator_array_begin(iter, layer->data, sizeof(MFloatProperty), me->totpoly, 0, NULL);
 }
 
@@ -1437,6 +1440,7 @@ static void rna_MeshVertexIntPropertyLayer_data_begin(CollectionPropertyIterator
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
+  CustomData_ensure_layer_not_shared(layer);
   rna_iterator_array_begin(iter, layer->data, sizeof(MIntProperty), me->totvert, 0, NULL);
 }
 static void rna_MeshPolygonIntPropertyLayer_data_begin(CollectionPropertyIterator *iter,
@@ -1444,6 +1448,7 @@ static void rna_MeshPolygonIntPropertyLayer_data_begin(CollectionPropertyIterato
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
+  CustomData_ensure_layer_not_shared(layer);
   rna_iterator_array_begin(iter, layer->data, sizeof(MIntProperty), me->totpoly, 0, NULL);
 }
 
@@ -1488,6 +1493,7 @@ static void rna_MeshVertexStringPropertyLayer_data_begin(CollectionPropertyItera
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
+  CustomData_ensure_layer_not_shared(layer);
   rna_iterator_array_begin(iter, layer->data, sizeof(MStringProperty), me->totvert, 0, NULL);
 }
 static void rna_MeshPolygonStringPropertyLayer_data_begin(CollectionPropertyIterator *iter,
@@ -1495,6 +1501,7 @@ static void rna_MeshPolygonStringPropertyLayer_data_begin(CollectionPropertyIter
 {
   Mesh *me = rna_mesh(ptr);
   CustomDataLayer *layer = (CustomDataLayer *)ptr->data;
+  CustomData_ensure_layer_not_shared(layer);
   rna_iterator_array_begin(iter, layer->data, sizeof(MStringProperty), me->totpoly, 0, NULL);
 }
 
@@ -674,12 +674,15 @@ const EnumPropertyItem rna_enum_subdivision_boundary_smooth_items[] = {
 #  include "BKE_object.h"
 #  include "BKE_particle.h"
 
+#  include "BLI_listbase.h"
 #  include "BLI_sort_utils.h"
 
 #  include "DEG_depsgraph.h"
 #  include "DEG_depsgraph_build.h"
 #  include "DEG_depsgraph_query.h"
 
+#  include "NOD_geometry.h"
+
 #  ifdef WITH_ALEMBIC
 #    include "ABC_alembic.h"
 #  endif
@@ -1673,6 +1676,66 @@ static IDProperty **rna_NodesModifier_properties(PointerRNA *ptr)
   NodesModifierSettings *settings = &nmd->settings;
   return &settings->properties;
 }
+
+/* Keep the entries of nodes that were not executed in the last evaluation hidden. */
+static int rna_NodesModifier_node_statistics_skip(CollectionPropertyIterator *UNUSED(iter),
+                                                  void *data)
+{
+  const GeometryNodeStatistics *statistics = data;
+  return statistics->invocations == 0;
+}
+
+static void rna_NodesModifier_node_statistics_begin(CollectionPropertyIterator *iter,
+                                                    PointerRNA *ptr)
+{
+  NodesModifierData *nmd = ptr->data;
+  rna_iterator_listbase_begin(
+      iter, &nmd->runtime_node_statistics, rna_NodesModifier_node_statistics_skip);
+}
+
+static int rna_NodesModifier_node_statistics_length(PointerRNA *ptr)
+{
+  const NodesModifierData *nmd = ptr->data;
+  int len = 0;
+  LISTBASE_FOREACH (const GeometryNodeStatistics *, statistics, &nmd->runtime_node_statistics) {
+    if (statistics->invocations > 0) {
+      len++;
+    }
+  }
+  return len;
+}
+
+static void rna_GeometryNodeStatistics_node_path_get(PointerRNA *ptr, char *value)
+{
+  const GeometryNodeStatistics *statistics = ptr->data;
+  strcpy(value, statistics->node_path);
+}
+
+static int rna_GeometryNodeStatistics_node_path_length(PointerRNA *ptr)
+{
+  const GeometryNodeStatistics *statistics = ptr->data;
+  return strlen(statistics->node_path);
+}
+
+static float rna_GeometryNodeStatistics_execution_time_get(PointerRNA *ptr)
+{
+  const GeometryNodeStatistics *statistics = ptr->data;
+  return statistics->execution_time / 1000.0f;
+}
+
+static int rna_GeometryNodeStatistics_invocations_get(PointerRNA *ptr)
+{
+  const GeometryNodeStatistics *statistics = ptr->data;
+  return statistics->invocations;
+}
+
+static int rna_GeometryNodeStatistics_peak_geometry_size_get(PointerRNA *ptr)
+{
+  const GeometryNodeStatistics *statistics = ptr->data;
+  /* Round up, so that any geometry that was created is visible. */
+  const int64_t size_kb = (statistics->peak_geometry_size + 1023) / 1024;
+  return (int)MIN2(size_kb, INT_MAX);
+}
 #else
 
 static void rna_def_property_subdivision_common(StructRNA *srna)
@@ -6978,6 +7041,49 @@ static void rna_def_modifier_weightednormal(BlenderRNA *brna)
   RNA_define_lib_overridable(false);
 }
 
+static void rna_def_geometry_node_statistics(BlenderRNA *brna)
+{
+  StructRNA *srna;
+  PropertyRNA *prop;
+
+  srna = RNA_def_struct(brna, "GeometryNodeStatistics", NULL);
+  RNA_def_struct_ui_text(srna,
+                         "Geometry Node Statistics",
+                         "Execution statistics of a node from the last evaluation of a nodes "
+                         "modifier");
+
+  prop = RNA_def_property(srna, "node_path", PROP_STRING, PROP_NONE);
+  RNA_def_property_string_funcs(prop,
+                                "rna_GeometryNodeStatistics_node_path_get",
+                                "rna_GeometryNodeStatistics_node_path_length",
+                                NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(
+      prop, "Node Path", "Names of the parent group nodes and of the node, separated by \"/\"");
+  RNA_def_struct_name_property(srna, prop);
+
+  prop = RNA_def_property(srna, "execution_time", PROP_FLOAT, PROP_NONE);
+  RNA_def_property_float_funcs(prop, "rna_GeometryNodeStatistics_execution_time_get", NULL, NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Execution Time",
+                           "Accumulated duration of all executions of the node in milliseconds");
+
+  prop = RNA_def_property(srna, "invocations", PROP_INT, PROP_UNSIGNED);
+  RNA_def_property_int_funcs(prop, "rna_GeometryNodeStatistics_invocations_get", NULL, NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop, "Invocations", "Number of times the node has been executed");
+
+  prop = RNA_def_property(srna, "peak_geometry_size", PROP_INT, PROP_UNSIGNED);
+  RNA_def_property_int_funcs(
+      prop, "rna_GeometryNodeStatistics_peak_geometry_size_get", NULL, NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(
+      prop,
+      "Peak Geometry Size",
+      "Estimated size of the largest geometry created by the node in kilobytes");
+}
+
 static void rna_def_modifier_nodes(BlenderRNA *brna)
 {
   StructRNA *srna;
@@ -6997,7 +7103,40 @@ static void rna_def_modifier_nodes(BlenderRNA *brna)
   RNA_def_property_flag(prop, PROP_EDITABLE);
   RNA_def_property_update(prop, 0, "rna_NodesModifier_node_group_update");
 
+  prop = RNA_def_property(srna, "use_cache", PROP_BOOLEAN, PROP_NONE);
+  RNA_def_property_boolean_sdna(prop, NULL, "flag", NODES_MODIFIER_USE_CACHE);
+  RNA_def_property_ui_text(prop,
+                           "Cache Node Outputs",
+                           "Keep the outputs of nodes to reuse them when their inputs didn't "
+                           "change, which speeds up editing the node tree but uses more memory");
+  RNA_def_property_update(prop, 0, "rna_Modifier_update");
+
+  prop = RNA_def_property(srna, "cache_memory_limit", PROP_INT, PROP_NONE);
+  RNA_def_property_range(prop, 1, INT_MAX);
+  RNA_def_property_ui_range(prop, 1, 16384, 64, -1);
+  RNA_def_property_ui_text(prop,
+                           "Cache Memory Limit",
+                           "Maximum memory used by the cached node outputs, in megabytes");
+  RNA_def_property_update(prop, 0, "rna_Modifier_update");
+
   RNA_define_lib_overridable(false);
+
+  prop = RNA_def_property(srna, "node_statistics", PROP_COLLECTION, PROP_NONE);
+  RNA_def_property_struct_type(prop, "GeometryNodeStatistics");
+  RNA_def_property_collection_funcs(prop,
+                                    "rna_NodesModifier_node_statistics_begin",
+                                    "rna_iterator_listbase_next",
+                                    "rna_iterator_listbase_end",
+                                    "rna_iterator_listbase_get",
+                                    "rna_NodesModifier_node_statistics_length",
+                                    NULL,
+                                    NULL,
+                                    NULL);
+  RNA_def_property_clear_flag(prop, PROP_EDITABLE);
+  RNA_def_property_ui_text(prop,
+                           "Node Statistics",
+                           "Execution statistics of the nodes from the last evaluation in the "
+                           "active depsgraph");
 }
 
 static void rna_def_modifier_mesh_to_volume(BlenderRNA *brna)
@@ -7372,6 +7511,7 @@ void RNA_def_modifier(BlenderRNA *brna)
   rna_def_modifier_meshseqcache(brna);
   rna_def_modifier_surfacedeform(brna);
   rna_def_modifier_weightednormal(brna);
+  rna_def_geometry_node_statistics(brna);
   rna_def_modifier_nodes(brna);
   rna_def_modifier_mesh_to_volume(brna);
   rna_def_modifier_volume_displace(brna);
@@ -71,6 +71,7 @@
 
 #include "MOD_modifiertypes.h"
 #include "MOD_nodes.h"
+#include "MOD_nodes_cache.hh"
 #include "MOD_nodes_evaluator.hh"
 #include "MOD_ui_common.h"
 
@@ -112,6 +113,7 @@ using blender::fn::Field;
 using blender::fn::GField;
 using blender::fn::ValueOrField;
 using blender::fn::ValueOrFieldCPPType;
+using blender::modifiers::geometry_nodes::GeometryNodesCache;
 using blender::nodes::FieldInferencingInterface;
 using blender::nodes::GeoNodeExecParams;
 using blender::nodes::InputSocketFieldType;
@@ -894,6 +896,55 @@ static void clear_runtime_data(NodesModifierData *nmd)
   }
 }
 
+/**
+ * Copy the statistics of the last evaluation into the list owned by the original modifier. The
+ * existing entries are reused, entries of nodes that have not been executed are kept with zero
+ * invocations, so that pointers held by Python never become dangling.
+ */
+static void update_node_statistics(NodesModifierData &nmd, const geo_log::ModifierLog &log)
+{
+  LISTBASE_FOREACH (GeometryNodeStatistics *, statistics, &nmd.runtime_node_statistics) {
+    statistics->execution_time = 0;
+    statistics->invocations = 0;
+    statistics->peak_geometry_size = 0;
+  }
+
+  /* Both lists are sorted by node path, so they can be merged in a single pass. */
+  GeometryNodeStatistics *stored = static_cast<GeometryNodeStatistics *>(
+      nmd.runtime_node_statistics.first);
+  for (const GeometryNodeStatistics &statistics : log.node_statistics()) {
+    while (stored != nullptr && strcmp(stored->node_path, statistics.node_path) < 0) {
+      stored = stored->next;
+    }
+    if (stored == nullptr || !STREQ(stored->node_path, statistics.node_path)) {
+      GeometryNodeStatistics *new_stored = MEM_cnew<GeometryNodeStatistics>(__func__);
+      new_stored->node_path = BLI_strdup(statistics.node_path);
+      BLI_insertlinkbefore(&nmd.runtime_node_statistics, stored, new_stored);
+      stored = new_stored;
+    }
+    stored->execution_time = statistics.execution_time;
+    stored->invocations = statistics.invocations;
+    stored->peak_geometry_size = statistics.peak_geometry_size;
+  }
+}
+
+static void free_node_statistics(NodesModifierData *nmd)
+{
+  LISTBASE_FOREACH_MUTABLE (GeometryNodeStatistics *, statistics, &nmd->runtime_node_statistics) {
+    MEM_freeN((void *)statistics->node_path);
+    MEM_freeN(statistics);
+  }
+  BLI_listbase_clear(&nmd->runtime_node_statistics);
+}
+
+static void free_runtime_cache(NodesModifierData *nmd)
+{
+  if (nmd->runtime_cache != nullptr) {
+    delete static_cast<GeometryNodesCache *>(nmd->runtime_cache);
+    nmd->runtime_cache = nullptr;
+  }
+}
+
 struct OutputAttributeInfo {
   GField field;
   StringRefNull name;
@@ -1088,6 +1139,7 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
   }
 
   std::optional<geo_log::GeoLogger> geo_logger;
+  GeometryNodesCache *cache = nullptr;
 
   blender::modifiers::geometry_nodes::GeometryNodesEvaluationParams eval_params;
 
@@ -1098,6 +1150,24 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
     geo_logger.emplace(std::move(preview_sockets));
 
     geo_logger->log_input_geometry(input_geometry_set);
+
+    /* Only cache for the active depsgraph, where the same modifier is evaluated repeatedly while
+     * the user is editing. The cache is stored on the original modifier to persist. */
+    NodesModifierData *nmd_orig = (NodesModifierData *)BKE_modifier_get_original(ctx->object,
+                                                                                 &nmd->modifier);
+    if (nmd->flag & NODES_MODIFIER_USE_CACHE) {
+      if (nmd_orig->runtime_cache == nullptr) {
+        nmd_orig->runtime_cache = new GeometryNodesCache();
+      }
+      cache = static_cast<GeometryNodesCache *>(nmd_orig->runtime_cache);
+      cache->set_memory_limit(int64_t(nmd->cache_memory_limit) * 1024 * 1024);
+      cache->begin_evaluation(input_geometry_set);
+    }
+    else {
+      free_runtime_cache(nmd_orig);
+    }
+    eval_params.previous_log = static_cast<const geo_log::ModifierLog *>(
+        nmd_orig->runtime_eval_log);
   }
 
   /* Don't keep a reference to the input geometry components to avoid copies during evaluation. */
@@ -1110,8 +1180,14 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
   eval_params.depsgraph = ctx->depsgraph;
   eval_params.self_object = ctx->object;
   eval_params.geo_logger = geo_logger.has_value() ? &*geo_logger : nullptr;
+  eval_params.cache = cache;
   blender::modifiers::geometry_nodes::evaluate_geometry_nodes(eval_params);
 
+  if (cache != nullptr) {
+    cache->end_evaluation(GeometryNodesCache::cacheable_node_paths(tree));
+    geo_logger->log_cache_stats(cache->stats());
+  }
+
   GeometrySet output_geometry_set = std::move(*eval_params.r_output_values[0].get<GeometrySet>());
 
   if (geo_logger.has_value()) {
@@ -1119,7 +1195,9 @@ static GeometrySet compute_geometry(const DerivedNodeTree &tree,
     NodesModifierData *nmd_orig = (NodesModifierData *)BKE_modifier_get_original(ctx->object,
                                                                                  &nmd->modifier);
     clear_runtime_data(nmd_orig);
-    nmd_orig->runtime_eval_log = new geo_log::ModifierLog(*geo_logger);
+    geo_log::ModifierLog *log = new geo_log::ModifierLog(*geo_logger);
+    nmd_orig->runtime_eval_log = log;
+    update_node_statistics(*nmd_orig, *log);
   }
 
   store_output_attributes(output_geometry_set, *nmd, output_node, eval_params.r_output_values);
@@ -1619,6 +1697,27 @@ static void output_attribute_panel_draw(const bContext *C, Panel *panel)
   }
 }
 
+static void cache_panel_header_draw(const bContext *UNUSED(C), Panel *panel)
+{
+  uiLayout *layout = panel->layout;
+
+  PointerRNA *ptr = modifier_panel_get_property_pointers(panel, nullptr);
+
+  uiItemR(layout, ptr, "use_cache", 0, nullptr, ICON_NONE);
+}
+
+static void cache_panel_draw(const bContext *UNUSED(C), Panel *panel)
+{
+  uiLayout *layout = panel->layout;
+
+  PointerRNA *ptr = modifier_panel_get_property_pointers(panel, nullptr);
+
+  uiLayoutSetPropSep(layout, true);
+
+  uiLayoutSetActive(layout, RNA_boolean_get(ptr, "use_cache"));
+  uiItemR(layout, ptr, "cache_memory_limit", 0, IFACE_("Memory Limit"), ICON_NONE);
+}
+
 static void panelRegister(ARegionType *region_type)
 {
   PanelType *panel_type = modifier_panel_register(region_type, eModifierType_Nodes, panel_draw);
@@ -1628,6 +1727,8 @@ static void panelRegister(ARegionType *region_type)
                              nullptr,
                              output_attribute_panel_draw,
                              panel_type);
+  modifier_subpanel_register(
+      region_type, "cache", "", cache_panel_header_draw, cache_panel_draw, panel_type);
 }
 
 static void blendWrite(BlendWriter *writer, const ModifierData *md)
@@ -1646,6 +1747,8 @@ static void blendRead(BlendDataReader *reader, ModifierData *md)
   BLO_read_data_address(reader, &nmd->settings.properties);
   IDP_BlendDataRead(reader, &nmd->settings.properties);
   nmd->runtime_eval_log = nullptr;
+  nmd->runtime_cache = nullptr;
+  BLI_listbase_clear(&nmd->runtime_node_statistics);
 }
 
 static void copyData(const ModifierData *md, ModifierData *target, const int flag)
@@ -1656,6 +1759,8 @@ static void copyData(const ModifierData *md, ModifierData *target, const int fla
   BKE_modifier_copydata_generic(md, target, flag);
 
   tnmd->runtime_eval_log = nullptr;
+  tnmd->runtime_cache = nullptr;
+  BLI_listbase_clear(&tnmd->runtime_node_statistics);
 
   if (nmd->settings.properties != nullptr) {
     tnmd->settings.properties = IDP_CopyProperty_ex(nmd->settings.properties, flag);
@@ -1671,6 +1776,8 @@ static void freeData(ModifierData *md)
   }
 
   clear_runtime_data(nmd);
+  free_runtime_cache(nmd);
+  free_node_statistics(nmd);
 }
 
 static void requiredDataMask(Object *UNUSED(ob),
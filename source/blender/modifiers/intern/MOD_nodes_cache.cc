@@ -0,0 +1,488 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "MOD_nodes_cache.hh"
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_hash.hh"
+#include "BLI_hash_memory.hh"
+
+#include "BLI_task.hh"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_node_types.h"
+#include "DNA_pointcloud_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_geometry_set.hh"
+#include "BKE_node.h"
+
+#include "FN_field_cpp_type.hh"
+
+namespace blender::modifiers::geometry_nodes {
+
+using bke::AttributeIDRef;
+using fn::ValueOrFieldCPPType;
+using nodes::InputSocketRef;
+using nodes::geometry_nodes_eval_log::NodeCacheStats;
+
+/* -------------------------------------------------------------------- */
+/** \name Cached Value
+ * \{ */
+
+CachedValue::CachedValue(const GPointer value)
+{
+  const CPPType &type = *value.type();
+  void *buffer = MEM_mallocN_aligned(type.size(), type.alignment(), __func__);
+  type.copy_construct(value.get(), buffer);
+  value_ = {type, buffer};
+}
+
+CachedValue::CachedValue(CachedValue &&other) : value_(other.value_)
+{
+  other.value_ = {};
+}
+
+CachedValue &CachedValue::operator=(CachedValue &&other)
+{
+  if (this != &other) {
+    this->~CachedValue();
+    new (this) CachedValue(std::move(other));
+  }
+  return *this;
+}
+
+CachedValue::~CachedValue()
+{
+  if (value_.get() != nullptr) {
+    value_.destruct();
+    MEM_freeN(value_.get());
+  }
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Hashing and Comparing Values
+ * \{ */
+
+/**
+ * Add hashes of all layers to \a hashes.
+ * \return False when a layer can't be hashed.
+ */
+static bool custom_data_hash(const CustomData &data, const int size, Vector<uint64_t> &hashes)
+{
+  hashes.append(uint64_t(size));
+  for (const CustomDataLayer &layer : Span(data.layers, data.totlayer)) {
+    /* Anonymous attributes are only identified by a pointer that is freed after evaluation. */
+    if (layer.anonymous_id != nullptr) {
+      return false;
+    }
+    hashes.append(get_default_hash_3(StringRef(layer.name), layer.type, layer.active));
+    if (layer.data == nullptr) {
+      continue;
+    }
+    if (layer.type == CD_MDEFORMVERT) {
+      const MDeformVert *dverts = static_cast<const MDeformVert *>(layer.data);
+      uint64_t dverts_hash = 0;
+      for (const int i : IndexRange(size)) {
+        dverts_hash = get_default_hash_2(
+            dverts_hash,
+            hash_memory(dverts[i].dw, int64_t(sizeof(MDeformWeight)) * dverts[i].totweight));
+      }
+      hashes.append(dverts_hash);
+    }
+    else if (ELEM(layer.type, CD_MDISPS, CD_GRID_PAINT_MASK, CD_BM_ELEM_PYPTR)) {
+      /* The elements of these layers point to other data. */
+      return false;
+    }
+    else {
+      hashes.append(
+          hash_memory_parallel(layer.data, int64_t(size) * CustomData_sizeof(layer.type)));
+    }
+  }
+  return true;
+}
+
+std::optional<uint64_t> geometry_component_content_hash(const GeometryComponent &component)
+{
+  Vector<uint64_t> hashes;
+  if (component.type() == GEO_COMPONENT_TYPE_MESH) {
+    const Mesh *mesh = static_cast<const MeshComponent &>(component).get_for_read();
+    if (mesh == nullptr || mesh->runtime.wrapper_type != ME_WRAPPER_TYPE_MDATA) {
+      return std::nullopt;
+    }
+    /* Settings like auto smooth change the result of some nodes. */
+    hashes.append(get_default_hash_3(int(mesh->flag), int(mesh->cd_flag), mesh->smoothresh));
+    for (const int i : IndexRange(mesh->totcol)) {
+      hashes.append(get_default_hash(mesh->mat[i]));
+    }
+    /* All layers are hashed, not only attributes, to include vertex groups, custom normals and
+     * the flags and bevel weights in #MVert and #MEdge. */
+    if (!custom_data_hash(mesh->vdata, mesh->totvert, hashes) ||
+        !custom_data_hash(mesh->edata, mesh->totedge, hashes) ||
+        !custom_data_hash(mesh->pdata, mesh->totpoly, hashes) ||
+        !custom_data_hash(mesh->ldata, mesh->totloop, hashes)) {
+      return std::nullopt;
+    }
+  }
+  else if (component.type() == GEO_COMPONENT_TYPE_POINT_CLOUD) {
+    const PointCloud *pointcloud =
+        static_cast<const PointCloudComponent &>(component).get_for_read();
+    if (pointcloud == nullptr) {
+      return std::nullopt;
+    }
+    for (const int i : IndexRange(pointcloud->totcol)) {
+      hashes.append(get_default_hash(pointcloud->mat[i]));
+    }
+    if (!custom_data_hash(pointcloud->pdata, pointcloud->totpoint, hashes)) {
+      return std::nullopt;
+    }
+  }
+  else {
+    return std::nullopt;
+  }
+  return hash_memory(hashes.data(), hashes.as_span().size_in_bytes());
+}
+
+/** Estimated memory that is kept alive by a value. Shared data is counted fully. */
+static int64_t value_memory_usage(const GPointer value)
+{
+  const CPPType &type = *value.type();
+  if (type.is<GeometrySet>()) {
+    return type.size() + value.get<GeometrySet>()->estimate_memory_usage();
+  }
+  return type.size();
+}
+
+static bool values_equal(const CPPType &type, const void *a, const void *b)
+{
+  if (const ValueOrFieldCPPType *field_type = dynamic_cast<const ValueOrFieldCPPType *>(&type)) {
+    const bool a_is_field = field_type->is_field(a);
+    if (a_is_field != field_type->is_field(b)) {
+      return false;
+    }
+    if (a_is_field) {
+      /* Field operations are compared by pointer, cached inputs keep them alive. */
+      return *field_type->get_field_ptr(a) == *field_type->get_field_ptr(b);
+    }
+    return field_type->base_type().is_equal_or_false(field_type->get_value_ptr(a),
+                                                     field_type->get_value_ptr(b));
+  }
+  return type.is_equal_or_false(a, b);
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Node Cache Key
+ * \{ */
+
+static uint64_t node_settings_hash(const DNode node)
+{
+  const bNode &bnode = *node->bnode();
+  uint64_t hash = get_default_hash_4(
+      StringRef(bnode.idname), bnode.custom1, bnode.custom2, bnode.custom3);
+  hash = get_default_hash_2(hash, bnode.custom4);
+  if (bnode.storage != nullptr) {
+    /* Node storage of cached nodes only contains plain values, see #node_is_cacheable. */
+    hash = get_default_hash_2(
+        hash, hash_memory(bnode.storage, int64_t(MEM_allocN_len(bnode.storage))));
+  }
+  return hash;
+}
+
+NodeCacheKey::NodeCacheKey(const DNode node) : NodeCacheKey(node_settings_hash(node))
+{
+}
+
+NodeCacheKey::NodeCacheKey(const uint64_t settings_hash) : settings_hash_(settings_hash)
+{
+}
+
+void NodeCacheKey::add_input(const Span<GPointer> values)
+{
+  structure_.append(uint64_t(values.size()));
+  for (const GPointer value : values) {
+    if (value.type()->is<GeometrySet>()) {
+      const GeometrySet &geometry = *value.get<GeometrySet>();
+      const Vector<const GeometryComponent *> components = geometry.get_components_for_read();
+      structure_.append(uint64_t(components.size()));
+      for (const GeometryComponent *component : components) {
+        structure_.append(uint64_t(component->type()));
+        structure_.append(component->version());
+      }
+    }
+    else {
+      values_.append(CachedValue(value));
+    }
+  }
+}
+
+bool operator==(const NodeCacheKey &a, const NodeCacheKey &b)
+{
+  if (a.settings_hash_ != b.settings_hash_) {
+    return false;
+  }
+  if (a.structure_.as_span() != b.structure_.as_span()) {
+    return false;
+  }
+  if (a.values_.size() != b.values_.size()) {
+    return false;
+  }
+  for (const int i : a.values_.index_range()) {
+    const GPointer a_value = a.values_[i].get();
+    const GPointer b_value = b.values_[i].get();
+    if (a_value.type() != b_value.type()) {
+      return false;
+    }
+    if (!values_equal(*a_value.type(), a_value.get(), b_value.get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Geometry Nodes Cache
+ * \{ */
+
+GeometryNodesCache::GeometryNodesCache(const int64_t memory_limit) : memory_limit_(memory_limit)
+{
+}
+
+bool GeometryNodesCache::node_is_cacheable(const DNode node)
+{
+  const bNode &bnode = *node->bnode();
+  if (bnode.typeinfo->geometry_node_execute_supports_laziness) {
+    return false;
+  }
+  /* The result depends on the referenced data-block, which may change. */
+  if (bnode.id != nullptr) {
+    return false;
+  }
+  /* These nodes depend on the context of the evaluation. The string input node is excluded
+   * because its storage contains a pointer. */
+  if (ELEM(bnode.type,
+           GEO_NODE_OBJECT_INFO,
+           GEO_NODE_COLLECTION_INFO,
+           GEO_NODE_IS_VIEWPORT,
+           GEO_NODE_INPUT_SCENE_TIME,
+           GEO_NODE_IMAGE_TEXTURE,
+           GEO_NODE_STRING_TO_CURVES,
+           GEO_NODE_VIEWER,
+           FN_NODE_INPUT_STRING)) {
+    return false;
+  }
+  for (const InputSocketRef *socket : node->inputs()) {
+    if (!socket->is_available()) {
+      continue;
+    }
+    if (ELEM(socket->typeinfo()->type,
+             SOCK_OBJECT,
+             SOCK_COLLECTION,
+             SOCK_TEXTURE,
+             SOCK_IMAGE,
+             SOCK_MATERIAL)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::string GeometryNodesCache::node_path(const DNode node)
+{
+  std::string path = node->name();
+  for (const nodes::DTreeContext *context = node.context(); context->parent_node() != nullptr;
+       context = context->parent_context()) {
+    path = context->parent_node()->name() + "/" + path;
+  }
+  return path;
+}
+
+void GeometryNodesCache::set_memory_limit(const int64_t memory_limit)
+{
+  std::lock_guard lock{mutex_};
+  memory_limit_ = memory_limit;
+}
+
+void GeometryNodesCache::begin_evaluation(const GeometrySet &input_geometry)
+{
+  std::lock_guard lock{mutex_};
+  evaluation_counter_++;
+  hits_ = 0;
+  misses_ = 0;
+
+  /* Hashing the input is postponed until a cached node uses it, see #ensure_input_versions. */
+  pending_input_versions_.clear();
+  for (const GeometryComponent *component : input_geometry.get_components_for_read()) {
+    pending_input_versions_.add(component->version(), component->type());
+  }
+}
+
+void GeometryNodesCache::ensure_input_versions(const GeometrySet &geometry)
+{
+  std::lock_guard lock{mutex_};
+  if (pending_input_versions_.is_empty()) {
+    return;
+  }
+  for (const GeometryComponent *component : geometry.get_components_for_read()) {
+    if (!pending_input_versions_.remove(component->version())) {
+      continue;
+    }
+    /* Hashing is multi-threaded, isolate it so that this thread doesn't execute another node
+     * that tries to lock the cache while it is waiting. */
+    std::optional<uint64_t> content_hash;
+    threading::isolate_task([&]() { content_hash = geometry_component_content_hash(*component); });
+    if (!content_hash) {
+      input_versions_.remove(component->type());
+      continue;
+    }
+    const InputComponentVersion *old_version = input_versions_.lookup_ptr(component->type());
+    if (old_version != nullptr && old_version->content_hash == *content_hash) {
+      component->set_version(old_version->version);
+    }
+    else {
+      input_versions_.add_overwrite(component->type(), {*content_hash, component->version()});
+    }
+  }
+}
+
+Set<std::string> GeometryNodesCache::cacheable_node_paths(const nodes::DerivedNodeTree &tree)
+{
+  Set<std::string> node_paths;
+  tree.foreach_node([&](const DNode node) {
+    if (node_is_cacheable(node)) {
+      node_paths.add(node_path(node));
+    }
+  });
+  return node_paths;
+}
+
+void GeometryNodesCache::end_evaluation(const Set<std::string> &node_paths)
+{
+  std::lock_guard lock{mutex_};
+  pending_input_versions_.clear();
+
+  /* Remove entries of nodes that have been removed or renamed. */
+  Vector<std::string> removed_paths;
+  for (const std::string &path : entries_.keys()) {
+    if (!node_paths.contains(path)) {
+      removed_paths.append(path);
+    }
+  }
+  for (const std::string &path : removed_paths) {
+    this->remove_entry(path);
+  }
+
+  while (memory_usage_ > memory_limit_ && !entries_.is_empty()) {
+    const std::string *oldest_path = nullptr;
+    uint64_t oldest_evaluation = UINT64_MAX;
+    for (auto item : entries_.items()) {
+      if (item.value->last_used_evaluation < oldest_evaluation) {
+        oldest_evaluation = item.value->last_used_evaluation;
+        oldest_path = &item.key;
+      }
+    }
+    this->remove_entry(*oldest_path);
+  }
+}
+
+bool GeometryNodesCache::lookup(
+    const StringRef node_path,
+    const NodeCacheKey &key,
+    const Span<bool> used_outputs,
+    bool &r_keep_outputs,
+    const FunctionRef<void(int output_index, GPointer value)> copy_output_fn)
+{
+  std::lock_guard lock{mutex_};
+  const std::unique_ptr<Entry> *entry_ptr = entries_.lookup_ptr_as(node_path);
+  if (entry_ptr == nullptr) {
+    r_keep_outputs = true;
+    return false;
+  }
+  Entry &entry = **entry_ptr;
+  if (!(entry.key == key)) {
+    /* The inputs of the node change, e.g. during playback, so the new outputs are unlikely to be
+     * reused. Not keeping them allows following nodes to modify them without copying. */
+    r_keep_outputs = false;
+    return false;
+  }
+  r_keep_outputs = true;
+  BLI_assert(entry.outputs.size() == used_outputs.size());
+  for (const int i : used_outputs.index_range()) {
+    if (used_outputs[i] && entry.outputs[i].get().get() == nullptr) {
+      return false;
+    }
+  }
+  entry.last_used_evaluation = evaluation_counter_;
+  hits_++;
+  for (const int i : used_outputs.index_range()) {
+    if (used_outputs[i]) {
+      copy_output_fn(i, entry.outputs[i].get());
+    }
+  }
+  return true;
+}
+
+void GeometryNodesCache::add(const StringRef node_path,
+                             NodeCacheKey key,
+                             Vector<CachedValue> outputs)
+{
+  int64_t memory_usage = 0;
+  bool is_cacheable = true;
+  for (const CachedValue &value : outputs) {
+    if (value.get().get() == nullptr) {
+      continue;
+    }
+    /* Geometries that reference data they don't own can't be used after the evaluation. */
+    if (value.get().type()->is<GeometrySet>() &&
+        !value.get().get<GeometrySet>()->owns_direct_data()) {
+      is_cacheable = false;
+      break;
+    }
+    memory_usage += value_memory_usage(value.get());
+  }
+
+  std::unique_ptr<Entry> entry;
+  if (is_cacheable) {
+    entry = std::make_unique<Entry>(Entry{std::move(key), std::move(outputs), memory_usage});
+  }
+
+  std::lock_guard lock{mutex_};
+  misses_++;
+  this->remove_entry(node_path);
+  if (entry) {
+    entry->last_used_evaluation = evaluation_counter_;
+    memory_usage_ += entry->memory_usage;
+    entries_.add_new(node_path, std::move(entry));
+  }
+}
+
+void GeometryNodesCache::remove_entry(const StringRef node_path)
+{
+  std::unique_ptr<Entry> *entry = entries_.lookup_ptr_as(node_path);
+  if (entry != nullptr) {
+    memory_usage_ -= (*entry)->memory_usage;
+    entries_.remove_as(node_path);
+  }
+}
+
+NodeCacheStats GeometryNodesCache::stats() const
+{
+  std::lock_guard lock{mutex_};
+  NodeCacheStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.entries_num = entries_.size();
+  stats.memory_usage = memory_usage_;
+  stats.memory_limit = memory_limit_;
+  return stats;
+}
+
+/** \} */
+
+}  // namespace blender::modifiers::geometry_nodes
@@ -0,0 +1,174 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#pragma once
+
+/** \file
+ * \ingroup modifiers
+ *
+ * Cache for the outputs of geometry nodes that is kept across evaluations of a modifier.
+ *
+ * Every cached node has one entry with the outputs of its last execution and a key that describes
+ * the inputs of that execution. When the node is evaluated again with an equal key, its outputs
+ * are copied from the cache instead of executing the node. Copying is cheap, because geometries
+ * and fields are shared. Geometry inputs are compared by the versions of their components, all
+ * other inputs are compared by value.
+ *
+ * Nodes that depend on data outside of the node tree, like objects or the scene time, are never
+ * cached. Outputs of nodes downstream of them only match when those nodes produce equal values.
+ */
+
+#include <mutex>
+
+#include <optional>
+
+#include "BLI_generic_pointer.hh"
+#include "BLI_map.hh"
+#include "BLI_set.hh"
+#include "BLI_vector.hh"
+
+#include "NOD_derived_node_tree.hh"
+#include "NOD_geometry_nodes_eval_log.hh"
+
+class GeometryComponent;
+struct GeometrySet;
+
+namespace blender::modifiers::geometry_nodes {
+
+using nodes::DNode;
+
+/**
+ * Hash of the data of a mesh or point cloud component, used to detect whether the input of a
+ * modifier changed. None for other component types and for data that can't be hashed.
+ */
+std::optional<uint64_t> geometry_component_content_hash(const GeometryComponent &component);
+
+/** Owned copy of a value of a generic type, or nothing. */
+class CachedValue : NonCopyable {
+ private:
+  GMutablePointer value_;
+
+ public:
+  CachedValue() = default;
+  CachedValue(GPointer value);
+  CachedValue(CachedValue &&other);
+  CachedValue &operator=(CachedValue &&other);
+  ~CachedValue();
+
+  GPointer get() const
+  {
+    return value_;
+  }
+};
+
+/** Describes the input values and settings of one execution of a node. */
+class NodeCacheKey {
+ private:
+  /** Hash of the type and settings of the node. */
+  uint64_t settings_hash_;
+  /** Number of values of every input socket and the component versions of geometry values. */
+  Vector<uint64_t> structure_;
+  /** Copies of all input values that are not geometries. */
+  Vector<CachedValue> values_;
+
+ public:
+  NodeCacheKey(DNode node);
+  NodeCacheKey(uint64_t settings_hash);
+
+  /** Add the values of the next available input socket, multi-input sockets have several. */
+  void add_input(Span<GPointer> values);
+
+  friend bool operator==(const NodeCacheKey &a, const NodeCacheKey &b);
+};
+
+class GeometryNodesCache : NonCopyable, NonMovable {
+ private:
+  struct Entry {
+    NodeCacheKey key;
+    /** Indexed by output socket index, outputs that have not been computed are empty. */
+    Vector<CachedValue> outputs;
+    int64_t memory_usage = 0;
+    uint64_t last_used_evaluation = 0;
+  };
+
+  struct InputComponentVersion {
+    uint64_t content_hash;
+    uint64_t version;
+  };
+
+  mutable std::mutex mutex_;
+  Map<std::string, std::unique_ptr<Entry>> entries_;
+  /** Content hashes and versions of the most recently hashed input geometry components. */
+  Map<int, InputComponentVersion> input_versions_;
+  /**
+   * Component types by version of input components of the current evaluation that have not been
+   * compared with #input_versions_ yet.
+   */
+  Map<uint64_t, int> pending_input_versions_;
+  uint64_t evaluation_counter_ = 0;
+  int64_t memory_usage_ = 0;
+  int64_t memory_limit_;
+  int hits_ = 0;
+  int misses_ = 0;
+
+ public:
+  /** By default the cache of one modifier may use up to 512 MB. */
+  GeometryNodesCache(int64_t memory_limit = 512 * 1024 * 1024);
+
+  /** Entries are removed at the end of an evaluation until the limit is respected. */
+  void set_memory_limit(int64_t memory_limit);
+
+  /**
+   * False for nodes whose outputs don't only depend on their inputs and settings, and for nodes
+   * that may be executed more than once per evaluation.
+   */
+  static bool node_is_cacheable(DNode node);
+  /** Name of the node that is unique in the entire derived node tree. */
+  static std::string node_path(DNode node);
+  /** Paths of all cacheable nodes in the tree, see #end_evaluation. */
+  static Set<std::string> cacheable_node_paths(const nodes::DerivedNodeTree &tree);
+
+  /**
+   * Start a new evaluation. Components of the input geometry that have the same content as in the
+   * previous evaluation get the same version, so that nodes depending on them can be cached.
+   * The content is only compared when the components are passed to #ensure_input_versions.
+   */
+  void begin_evaluation(const GeometrySet &input_geometry);
+  /**
+   * Has to be called for geometry inputs of a node before its key is built. Components that are
+   * inputs of the modifier are hashed the first time, and get their previous version if their
+   * content didn't change.
+   */
+  void ensure_input_versions(const GeometrySet &geometry);
+  /**
+   * Remove entries of nodes that are not in \a node_paths anymore, because they have been removed
+   * or renamed, and least recently used entries until the memory limit is respected.
+   */
+  void end_evaluation(const Set<std::string> &node_paths);
+
+  /**
+   * Pass the cached outputs of the node to \a copy_output_fn when the node has been executed with
+   * an equal key before and all \a used_outputs have been computed. The values are still owned by
+   * the cache, which is locked while the function is called, so it should only copy them.
+   * \param r_keep_outputs: Set on a miss, false when the key of the node changed since its last
+   * execution, so that its new outputs are unlikely to be reused and should not be kept.
+   * \return True when the cached outputs have been used.
+   */
+  bool lookup(StringRef node_path,
+              const NodeCacheKey &key,
+              Span<bool> used_outputs,
+              bool &r_keep_outputs,
+              FunctionRef<void(int output_index, GPointer value)> copy_output_fn);
+  /**
+   * Store the outputs of a node execution. \a outputs has a value for every output socket, which
+   * is empty for outputs that have not been computed or should not be kept. The key is stored
+   * either way.
+   */
+  void add(StringRef node_path, NodeCacheKey key, Vector<CachedValue> outputs);
+
+  nodes::geometry_nodes_eval_log::NodeCacheStats stats() const;
+
+ private:
+  void remove_entry(StringRef node_path);
+};
+
+}  // namespace blender::modifiers::geometry_nodes
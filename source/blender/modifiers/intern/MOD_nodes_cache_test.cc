@@ -0,0 +1,226 @@
+/* SPDX-License-Identifier: GPL-2.0-or-later */
+
+#include "testing/testing.h"
+
+#include "BKE_customdata.h"
+#include "BKE_geometry_set.hh"
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "MOD_nodes_cache.hh"
+
+namespace blender::modifiers::geometry_nodes::tests {
+
+class NodesCacheTest : public testing::Test {
+ public:
+  static void SetUpTestSuite()
+  {
+    BKE_idtype_init();
+  }
+};
+
+/** A single quad. */
+static Mesh *create_test_mesh()
+{
+  Mesh *mesh = BKE_mesh_new_nomain(4, 0, 0, 4, 1);
+  for (const int i : IndexRange(4)) {
+    mesh->mvert[i].co[0] = float(i % 2);
+    mesh->mvert[i].co[1] = float(i / 2);
+    mesh->mloop[i].v = uint(i);
+  }
+  mesh->mpoly[0].loopstart = 0;
+  mesh->mpoly[0].totloop = 4;
+  return mesh;
+}
+
+static uint64_t mesh_content_hash(Mesh *mesh)
+{
+  MeshComponent component;
+  component.replace(mesh, GeometryOwnershipType::ReadOnly);
+  const std::optional<uint64_t> hash = geometry_component_content_hash(component);
+  EXPECT_TRUE(hash.has_value());
+  return hash.value_or(0);
+}
+
+static CachedValue int_value(int value)
+{
+  return CachedValue(GPointer(CPPType::get<int>(), &value));
+}
+
+static NodeCacheKey int_key(const uint64_t settings_hash, const int input)
+{
+  NodeCacheKey key{settings_hash};
+  const int value = input;
+  const GPointer pointer{CPPType::get<int>(), &value};
+  key.add_input({pointer});
+  return key;
+}
+
+static void add_int_output(GeometryNodesCache &cache, StringRef path, NodeCacheKey key, int value)
+{
+  Vector<CachedValue> outputs;
+  outputs.append(int_value(value));
+  cache.add(path, std::move(key), std::move(outputs));
+}
+
+/** \return The cached output value, or -1 on a miss. */
+static int lookup_int_output(GeometryNodesCache &cache,
+                             StringRef path,
+                             const NodeCacheKey &key,
+                             bool &r_keep_outputs)
+{
+  const Vector<bool> used_outputs = {true};
+  int result = -1;
+  cache.lookup(path, key, used_outputs, r_keep_outputs, [&](int /*index*/, GPointer value) {
+    result = *value.get<int>();
+  });
+  return result;
+}
+
+TEST_F(NodesCacheTest, ContentHashDetectsMeshChanges)
+{
+  Mesh *mesh = create_test_mesh();
+  Mesh *other_mesh = create_test_mesh();
+  const uint64_t hash = mesh_content_hash(mesh);
+  EXPECT_EQ(mesh_content_hash(other_mesh), hash);
+
+  mesh->flag |= ME_AUTOSMOOTH;
+  EXPECT_NE(mesh_content_hash(mesh), hash);
+  mesh->flag &= ~ME_AUTOSMOOTH;
+  EXPECT_EQ(mesh_content_hash(mesh), hash);
+
+  mesh->mvert[0].bweight = 100;
+  EXPECT_NE(mesh_content_hash(mesh), hash);
+  mesh->mvert[0].bweight = 0;
+
+  mesh->mvert[0].flag ^= ME_HIDE;
+  EXPECT_NE(mesh_content_hash(mesh), hash);
+  mesh->mvert[0].flag ^= ME_HIDE;
+  EXPECT_EQ(mesh_content_hash(mesh), hash);
+
+  CustomData_add_layer(&mesh->ldata, CD_CUSTOMLOOPNORMAL, CD_CALLOC, nullptr, mesh->totloop);
+  EXPECT_NE(mesh_content_hash(mesh), hash);
+
+  BKE_id_free(nullptr, mesh);
+  BKE_id_free(nullptr, other_mesh);
+}
+
+TEST_F(NodesCacheTest, HitWithEqualKey)
+{
+  GeometryNodesCache cache;
+  const Set<std::string> paths = {"A"};
+  bool keep_outputs = false;
+
+  cache.begin_evaluation({});
+  EXPECT_EQ(lookup_int_output(cache, "A", int_key(1, 5), keep_outputs), -1);
+  EXPECT_TRUE(keep_outputs);
+  add_int_output(cache, "A", int_key(1, 5), 10);
+  cache.end_evaluation(paths);
+
+  cache.begin_evaluation({});
+  EXPECT_EQ(lookup_int_output(cache, "A", int_key(1, 5), keep_outputs), 10);
+  /* Different settings. */
+  EXPECT_EQ(lookup_int_output(cache, "A", int_key(2, 5), keep_outputs), -1);
+  cache.end_evaluation(paths);
+  EXPECT_EQ(cache.stats().hits, 1);
+}
+
+TEST_F(NodesCacheTest, ChangedInputsAreNotKept)
+{
+  GeometryNodesCache cache;
+  const Set<std::string> paths = {"A"};
+  bool keep_outputs = true;
+
+  cache.begin_evaluation({});
+  add_int_output(cache, "A", int_key(1, 5), 10);
+  cache.end_evaluation(paths);
+
+  /* The input changed, like it does every frame during playback. */
+  cache.begin_evaluation({});
+  EXPECT_EQ(lookup_int_output(cache, "A", int_key(1, 6), keep_outputs), -1);
+  EXPECT_FALSE(keep_outputs);
+  cache.add("A", int_key(1, 6), Vector<CachedValue>(1));
+  cache.end_evaluation(paths);
+
+  /* The input is the same again, so the outputs are kept for the next evaluation. */
+  cache.begin_evaluation({});
+  EXPECT_EQ(lookup_int_output(cache, "A", int_key(1, 6), keep_outputs), -1);
+  EXPECT_TRUE(keep_outputs);
+  add_int_output(cache, "A", int_key(1, 6), 12);
+  cache.end_evaluation(paths);
+
+  cache.begin_evaluation({});
+  EXPECT_EQ(lookup_int_output(cache, "A", int_key(1, 6), keep_outputs), 12);
+  cache.end_evaluation(paths);
+}
+
+TEST_F(NodesCacheTest, RemovedNodesAreEvicted)
+{
+  GeometryNodesCache cache;
+  bool keep_outputs;
+
+  cache.begin_evaluation({});
+  add_int_output(cache, "A", int_key(1, 5), 10);
+  add_int_output(cache, "B", int_key(1, 5), 11);
+  cache.end_evaluation({"A", "B"});
+  EXPECT_EQ(cache.stats().entries_num, 2);
+
+  /* Node "A" has been removed or renamed. */
+  cache.begin_evaluation({});
+  cache.end_evaluation({"B"});
+  EXPECT_EQ(cache.stats().entries_num, 1);
+  EXPECT_EQ(lookup_int_output(cache, "B", int_key(1, 5), keep_outputs), 11);
+}
+
+TEST_F(NodesCacheTest, MemoryLimit)
+{
+  GeometryNodesCache cache;
+  cache.set_memory_limit(sizeof(int));
+  const Set<std::string> paths = {"A", "B"};
+  bool keep_outputs;
+
+  cache.begin_evaluation({});
+  add_int_output(cache, "A", int_key(1, 5), 10);
+  cache.end_evaluation(paths);
+
+  /* Adding a second entry exceeds the limit, so the least recently used one is removed. */
+  cache.begin_evaluation({});
+  add_int_output(cache, "B", int_key(1, 5), 11);
+  cache.end_evaluation(paths);
+  EXPECT_EQ(cache.stats().entries_num, 1);
+  EXPECT_EQ(lookup_int_output(cache, "A", int_key(1, 5), keep_outputs), -1);
+  EXPECT_EQ(lookup_int_output(cache, "B", int_key(1, 5), keep_outputs), 11);
+}
+
+TEST_F(NodesCacheTest, UnchangedInputGeometryKeepsVersion)
+{
+  GeometryNodesCache cache;
+
+  GeometrySet geometry = GeometrySet::create_with_mesh(create_test_mesh());
+  cache.begin_evaluation(geometry);
+  cache.ensure_input_versions(geometry);
+  const uint64_t version = geometry.get_component_for_read<MeshComponent>()->version();
+  cache.end_evaluation({});
+
+  /* A new copy of the same mesh gets the version of the previous evaluation. */
+  GeometrySet same_geometry = GeometrySet::create_with_mesh(create_test_mesh());
+  EXPECT_NE(same_geometry.get_component_for_read<MeshComponent>()->version(), version);
+  cache.begin_evaluation(same_geometry);
+  cache.ensure_input_versions(same_geometry);
+  EXPECT_EQ(same_geometry.get_component_for_read<MeshComponent>()->version(), version);
+  cache.end_evaluation({});
+
+  Mesh *changed_mesh = create_test_mesh();
+  changed_mesh->flag |= ME_AUTOSMOOTH;
+  GeometrySet changed_geometry = GeometrySet::create_with_mesh(changed_mesh);
+  cache.begin_evaluation(changed_geometry);
+  cache.ensure_input_versions(changed_geometry);
+  EXPECT_NE(changed_geometry.get_component_for_read<MeshComponent>()->version(), version);
+  cache.end_evaluation({});
+}
+
+}  // namespace blender::modifiers::geometry_nodes::tests
@@ -1,6 +1,7 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
 #include "MOD_nodes_evaluator.hh"
+#include "MOD_nodes_cache.hh"
 
 #include "BKE_type_conversions.hh"
 
@@ -247,6 +248,14 @@ struct NodeState {
    * not run twice at the same time accidentally.
    */
   NodeScheduleState schedule_state = NodeScheduleState::NotScheduled;
+
+  /**
+   * Cheap nodes are executed on the thread that scheduled them, because the overhead of a task
+   * would be larger than the work they do. Only expensive nodes are added to the task pool, so
+   * that they can run in parallel. This does not change after the node state is initialized, so
+   * it can be read without a lock.
+   */
+  bool is_expensive = false;
 };
 
 /**
@@ -400,9 +409,67 @@ static bool node_supports_laziness(const DNode node)
   return node->typeinfo()->geometry_node_execute_supports_laziness;
 }
 
+static const geo_log::NodeLog *find_node_log(const geo_log::ModifierLog &log, const DNode node)
+{
+  Vector<const DTreeContext *, 8> contexts;
+  for (const DTreeContext *context = node.context(); context->parent_node() != nullptr;
+       context = context->parent_context()) {
+    contexts.append(context);
+  }
+  const geo_log::TreeLog *tree_log = &log.root_tree();
+  for (int i = contexts.size() - 1; i >= 0; i--) {
+    tree_log = tree_log->lookup_child_log(contexts[i]->parent_node()->name());
+    if (tree_log == nullptr) {
+      return nullptr;
+    }
+  }
+  return tree_log->lookup_node_log(node->name());
+}
+
+/**
+ * Nodes that took less time than this in the previous evaluation are executed without creating a
+ * separate task. That's much longer than the overhead of a task, because when a node runs inline,
+ * nodes depending on it have to wait for the nodes that run before it on the same thread.
+ */
+static constexpr std::chrono::microseconds expensive_node_execution_time{100};
+
+/**
+ * Use the execution time of the previous evaluation if it is available. Otherwise assume that only
+ * nodes with a geometry execute function can be expensive, multi-function nodes only build fields
+ * or compute single values.
+ */
+static bool node_is_expensive(const DNode node, const geo_log::ModifierLog *previous_log)
+{
+  if (node->is_group_input_node() || node->is_group_output_node()) {
+    return false;
+  }
+  if (node->typeinfo()->geometry_node_execute == nullptr) {
+    return false;
+  }
+  if (previous_log != nullptr) {
+    const geo_log::NodeLog *node_log = find_node_log(*previous_log, node);
+    if (node_log != nullptr && node_log->invocations() > 0) {
+      return node_log->execution_time() / node_log->invocations() >=
+             expensive_node_execution_time;
+    }
+  }
+  return true;
+}
+
 struct NodeTaskRunState {
   /** The node that should be run on the same thread after the current node finished. */
   DNode next_node_to_run;
+  /**
+   * Cheap nodes that have been scheduled, they run on the same thread before #next_node_to_run.
+   */
+  Vector<DNode, 4> cheap_nodes_to_run;
+  /**
+   * When set, a copy of every output of the executed node is stored here, indexed by output
+   * index, so that the outputs can be added to the #GeometryNodesCache.
+   */
+  Vector<CachedValue> *outputs_to_cache = nullptr;
+  /** Estimated size of the largest geometry output of the executed node, only when logging. */
+  int64_t max_output_geometry_size = 0;
 };
 
 /** Implements the callbacks that might be called when a node is executed. */
@@ -548,6 +615,7 @@ class GeometryNodesEvaluator {
     /* Construct arrays of the correct size. */
     node_state.inputs = allocator.construct_array<InputState>(node->inputs().size());
     node_state.outputs = allocator.construct_array<OutputState>(node->outputs().size());
+    node_state.is_expensive = node_is_expensive(node, params_.previous_log);
 
     /* Initialize input states. */
     for (const int i : node->inputs().index_range()) {
@@ -744,11 +812,19 @@ class GeometryNodesEvaluator {
      * - Helps with cpu cache efficiency, because a thread is more likely to process data that it
      *   has processed shortly before.
      */
-    DNode next_node_to_run = root_node_with_state->node;
-    while (next_node_to_run) {
+    Vector<DNode, 16> nodes_to_run;
+    nodes_to_run.append(root_node_with_state->node);
+    while (!nodes_to_run.is_empty()) {
+      const DNode node = nodes_to_run.pop_last();
       NodeTaskRunState run_state;
-      evaluator.node_task_run(next_node_to_run, &run_state);
-      next_node_to_run = run_state.next_node_to_run;
+      evaluator.node_task_run(node, &run_state);
+      /* Cheap nodes run first, they may make more work available for other threads. */
+      if (run_state.next_node_to_run) {
+        nodes_to_run.append(run_state.next_node_to_run);
+      }
+      for (int i = run_state.cheap_nodes_to_run.size() - 1; i >= 0; i--) {
+        nodes_to_run.append(run_state.cheap_nodes_to_run[i]);
+      }
     }
   }
 
@@ -949,8 +1025,6 @@ class GeometryNodesEvaluator {
    */
   void execute_node(const DNode node, NodeState &node_state, NodeTaskRunState *run_state)
   {
-    const bNode &bnode = *node->bnode();
-
     if (node_state.has_been_executed) {
       if (!node_supports_laziness(node)) {
         /* Nodes that don't support laziness must not be executed more than once. */
@@ -959,6 +1033,102 @@ class GeometryNodesEvaluator {
     }
     node_state.has_been_executed = true;
 
+    if (params_.cache != nullptr && GeometryNodesCache::node_is_cacheable(node)) {
+      this->execute_node_with_cache(node, node_state, run_state);
+      return;
+    }
+
+    this->execute_node_uncached(node, node_state, run_state);
+  }
+
+  /**
+   * Reuse the outputs of a previous evaluation if the node has been executed with the same inputs
+   * before. Otherwise the node is executed and its outputs are added to the cache.
+   */
+  void execute_node_with_cache(const DNode node,
+                               NodeState &node_state,
+                               NodeTaskRunState *run_state)
+  {
+    GeometryNodesCache &cache = *params_.cache;
+    const std::string node_path = GeometryNodesCache::node_path(node);
+
+    NodeCacheKey key{node};
+    for (const int i : node->inputs().index_range()) {
+      InputState &input_state = node_state.inputs[i];
+      if (input_state.type == nullptr) {
+        continue;
+      }
+      BLI_assert(input_state.was_ready_for_execution);
+      Vector<GPointer, 4> values;
+      if (node->input(i).is_multi_input_socket()) {
+        for (const void *value : input_state.value.multi->values) {
+          values.append({input_state.type, value});
+        }
+      }
+      else {
+        values.append({input_state.type, input_state.value.single->value});
+      }
+      if (input_state.type->is<GeometrySet>()) {
+        for (const GPointer value : values) {
+          cache.ensure_input_versions(*value.get<GeometrySet>());
+        }
+      }
+      key.add_input(values);
+    }
+
+    Array<bool> used_outputs(node->outputs().size());
+    for (const int i : node->outputs().index_range()) {
+      const OutputState &output_state = node_state.outputs[i];
+      used_outputs[i] = node->output(i).is_available() &&
+                        get_socket_cpp_type(node->output(i)) != nullptr &&
+                        output_state.output_usage_for_execution != ValueUsage::Unused;
+    }
+
+    /* The values are only copied while the cache is locked, forwarding them might take long. */
+    LinearAllocator<> &allocator = local_allocators_.local();
+    Vector<GMutablePointer, 16> cached_outputs(node->outputs().size());
+    bool keep_outputs;
+    const bool is_hit = cache.lookup(
+        node_path,
+        key,
+        used_outputs,
+        keep_outputs,
+        [&](const int output_index, const GPointer value) {
+          const CPPType &type = *value.type();
+          void *buffer = allocator.allocate(type.size(), type.alignment());
+          type.copy_construct(value.get(), buffer);
+          cached_outputs[output_index] = {type, buffer};
+        });
+
+    if (is_hit) {
+      for (const int i : cached_outputs.index_range()) {
+        if (cached_outputs[i].get() == nullptr) {
+          continue;
+        }
+        this->forward_output(node.output(i), cached_outputs[i], run_state);
+        node_state.outputs[i].has_been_computed = true;
+      }
+    }
+    else {
+      /* Kept outputs are shared with the cache, so following nodes have to copy them before
+       * modifying them. Only keep them when they are likely to be reused. */
+      Vector<CachedValue> outputs_to_cache(node->outputs().size());
+      run_state->outputs_to_cache = keep_outputs ? &outputs_to_cache : nullptr;
+      this->execute_node_uncached(node, node_state, run_state);
+      run_state->outputs_to_cache = nullptr;
+      cache.add(node_path, std::move(key), std::move(outputs_to_cache));
+    }
+
+    if (params_.geo_logger != nullptr) {
+      params_.geo_logger->local().log_cache_usage(
+          node, is_hit ? geo_log::NodeCacheUsage::Hit : geo_log::NodeCacheUsage::Miss);
+    }
+  }
+
+  void execute_node_uncached(const DNode node, NodeState &node_state, NodeTaskRunState *run_state)
+  {
+    const bNode &bnode = *node->bnode();
+
     /* Use the geometry node execute callback if it exists. */
     if (bnode.typeinfo->geometry_node_execute != nullptr) {
       this->execute_geometry_node(node, node_state, run_state);
@@ -988,7 +1158,8 @@ class GeometryNodesEvaluator {
     const std::chrono::microseconds duration =
         std::chrono::duration_cast<std::chrono::microseconds>(end - begin);
     if (params_.geo_logger != nullptr) {
-      params_.geo_logger->local().log_execution_time(node, duration);
+      params_.geo_logger->local().log_execution_time(
+          node, duration, run_state->max_output_geometry_size);
     }
   }
 
@@ -1396,6 +1567,16 @@ class GeometryNodesEvaluator {
   {
     BLI_assert(value_to_forward.get() != nullptr);
 
+    if (run_state != nullptr && run_state->outputs_to_cache != nullptr) {
+      (*run_state->outputs_to_cache)[from_socket->index()] = CachedValue(value_to_forward);
+    }
+    if (run_state != nullptr && params_.geo_logger != nullptr &&
+        value_to_forward.type()->is<GeometrySet>()) {
+      const GeometrySet &geometry = *value_to_forward.get<GeometrySet>();
+      run_state->max_output_geometry_size = std::max(run_state->max_output_geometry_size,
+                                                     geometry.estimate_memory_usage());
+    }
+
     LinearAllocator<> &allocator = local_allocators_.local();
 
     Vector<DSocket> log_original_value_sockets;
@@ -1726,7 +1907,12 @@ class GeometryNodesEvaluator {
       this->send_output_unused_notification(socket, run_state);
     }
     for (const DNode &node_to_schedule : locked_node.delayed_scheduled_nodes) {
-      if (run_state != nullptr && !run_state->next_node_to_run) {
+      if (run_state != nullptr &&
+          !node_states_.lookup_key_as(node_to_schedule).state->is_expensive) {
+        /* Executing the node in a separate task would have more overhead than the node itself. */
+        run_state->cheap_nodes_to_run.append(node_to_schedule);
+      }
+      else if (run_state != nullptr && !run_state->next_node_to_run) {
         /* Execute the node on the same thread after the current node finished. */
         /* Currently, this assumes that it is always best to run the first node that is scheduled
          * on the same thread. That is usually correct, because the geometry socket which carries
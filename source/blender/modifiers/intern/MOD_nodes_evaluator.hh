@@ -19,6 +19,8 @@ namespace blender::modifiers::geometry_nodes {
 
 using namespace nodes::derived_node_tree_types;
 
+class GeometryNodesCache;
+
 struct GeometryNodesEvaluationParams {
   blender::LinearAllocator<> allocator;
 
@@ -35,6 +37,10 @@ struct GeometryNodesEvaluationParams {
   Depsgraph *depsgraph;
   Object *self_object;
   geo_log::GeoLogger *geo_logger;
+  /** When set, outputs of cacheable nodes are reused from and stored in this cache. */
+  GeometryNodesCache *cache = nullptr;
+  /** Log of the previous evaluation, its execution times are used to schedule nodes. */
+  const geo_log::ModifierLog *previous_log = nullptr;
 
   Vector<GMutablePointer> r_output_values;
 };
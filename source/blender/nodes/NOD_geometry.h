@@ -10,6 +10,20 @@ extern "C" {
 
 extern struct bNodeTreeType *ntreeType_Geometry;
 
+/** Execution statistics of a node from the last evaluation of a geometry nodes modifier. */
+typedef struct GeometryNodeStatistics {
+  /** Only used for the copies in #NodesModifierData.runtime_node_statistics. */
+  struct GeometryNodeStatistics *next, *prev;
+  /** Names of the parent group nodes and of the node, separated by "/". */
+  const char *node_path;
+  /** Accumulated duration of all executions of the node, in microseconds. */
+  int64_t execution_time;
+  /** Number of times the node has been executed. */
+  int invocations;
+  /** Estimated size of the largest geometry created by the node, in bytes. */
+  int64_t peak_geometry_size;
+} GeometryNodeStatistics;
+
 void register_node_tree_type_geo(void);
 
 void register_node_type_geo_group(void);
@@ -25,6 +25,7 @@
 #include "BKE_geometry_set.hh"
 
 #include "NOD_derived_node_tree.hh"
+#include "NOD_geometry.h"
 
 #include "FN_field.hh"
 
@@ -157,6 +158,37 @@ struct NodeWithWarning {
 struct NodeWithExecutionTime {
   DNode node;
   std::chrono::microseconds exec_time;
+  /** Estimated size of the largest geometry output of the execution in bytes. */
+  int64_t output_geometry_size;
+};
+
+/** Whether the outputs of a node were computed or taken from the node output cache. */
+enum class NodeCacheUsage {
+  /** The node is not cached, e.g. because it depends on data outside of the node tree. */
+  NotCached,
+  /** The outputs have been reused from a previous evaluation. */
+  Hit,
+  /** The node has been executed and its outputs have been added to the cache. */
+  Miss,
+};
+
+struct NodeWithCacheUsage {
+  DNode node;
+  NodeCacheUsage usage;
+};
+
+/** Statistics of the cache that keeps node outputs across evaluations of a modifier. */
+struct NodeCacheStats {
+  /** Number of executions that were skipped in the last evaluation. */
+  int hits = 0;
+  /** Number of executed nodes that could be cached in the last evaluation. */
+  int misses = 0;
+  /** Number of nodes that have cached outputs. */
+  int entries_num = 0;
+  /** Estimated memory used by the cached values, in bytes. */
+  int64_t memory_usage = 0;
+  /** Memory usage at which least recently used entries are removed, in bytes. */
+  int64_t memory_limit = 0;
 };
 
 struct NodeWithDebugMessage {
@@ -185,6 +217,7 @@ class LocalGeoLogger {
   Vector<ValueOfSockets> values_;
   Vector<NodeWithWarning> node_warnings_;
   Vector<NodeWithExecutionTime> node_exec_times_;
+  Vector<NodeWithCacheUsage> node_cache_usages_;
   Vector<NodeWithDebugMessage> node_debug_messages_;
 
   friend ModifierLog;
@@ -198,7 +231,10 @@ class LocalGeoLogger {
   void log_value_for_sockets(Span<DSocket> sockets, GPointer value);
   void log_multi_value_socket(DSocket socket, Span<GPointer> values);
   void log_node_warning(DNode node, NodeWarningType type, std::string message);
-  void log_execution_time(DNode node, std::chrono::microseconds exec_time);
+  void log_execution_time(DNode node,
+                          std::chrono::microseconds exec_time,
+                          int64_t output_geometry_size);
+  void log_cache_usage(DNode node, NodeCacheUsage usage);
   /**
    * Log a message that will be displayed in the node editor next to the node.
    * This should only be used for debugging purposes and not to display information to users.
@@ -220,6 +256,7 @@ class GeoLogger {
   /* These are only optional since they don't have a default constructor. */
   std::unique_ptr<GeometryValueLog> input_geometry_log_;
   std::unique_ptr<GeometryValueLog> output_geometry_log_;
+  NodeCacheStats cache_stats_;
 
   friend LocalGeoLogger;
   friend ModifierLog;
@@ -241,6 +278,11 @@ class GeoLogger {
     output_geometry_log_ = std::make_unique<GeometryValueLog>(geometry);
   }
 
+  void log_cache_stats(const NodeCacheStats &stats)
+  {
+    cache_stats_ = stats;
+  }
+
   LocalGeoLogger &local()
   {
     return threadlocals_.local();
@@ -278,7 +320,11 @@ class NodeLog {
   Vector<SocketLog> output_logs_;
   Vector<NodeWarning, 0> warnings_;
   Vector<std::string, 0> debug_messages_;
-  std::chrono::microseconds exec_time_;
+  /** Accumulated over all executions, lazy nodes can be executed more than once. */
+  std::chrono::microseconds exec_time_ = std::chrono::microseconds::zero();
+  int invocations_ = 0;
+  int64_t peak_geometry_size_ = 0;
+  NodeCacheUsage cache_usage_ = NodeCacheUsage::NotCached;
 
   friend ModifierLog;
 
@@ -312,6 +358,22 @@ class NodeLog {
     return exec_time_;
   }
 
+  int invocations() const
+  {
+    return invocations_;
+  }
+
+  /** Estimated size of the largest geometry created by the node in bytes. */
+  int64_t peak_geometry_size() const
+  {
+    return peak_geometry_size_;
+  }
+
+  NodeCacheUsage cache_usage() const
+  {
+    return cache_usage_;
+  }
+
   Vector<const GeometryAttributeInfo *> lookup_available_attributes() const;
 };
 
@@ -341,6 +403,9 @@ class ModifierLog {
 
   std::unique_ptr<GeometryValueLog> input_geometry_log_;
   std::unique_ptr<GeometryValueLog> output_geometry_log_;
+  NodeCacheStats cache_stats_;
+  /** Statistics of all executed nodes, sorted by node path. */
+  Vector<GeometryNodeStatistics> node_statistics_;
 
  public:
   ModifierLog(GeoLogger &logger);
@@ -366,6 +431,8 @@ class ModifierLog {
 
   const GeometryValueLog *input_geometry_log() const;
   const GeometryValueLog *output_geometry_log() const;
+  const NodeCacheStats &cache_stats() const;
+  Span<GeometryNodeStatistics> node_statistics() const;
 
  private:
   using LogByTreeContext = Map<const DTreeContext *, TreeLog *>;
@@ -374,6 +441,7 @@ class ModifierLog {
                                   const DTreeContext &tree_context);
   NodeLog &lookup_or_add_node_log(LogByTreeContext &log_by_tree_context, DNode node);
   SocketLog &lookup_or_add_socket_log(LogByTreeContext &log_by_tree_context, DSocket socket);
+  void gather_node_statistics(const TreeLog &tree_log, const std::string &path_prefix);
 };
 
 }  // namespace blender::nodes::geometry_nodes_eval_log
@@ -9,6 +9,8 @@
 #include "BLI_math_vector.hh"
 #include "BLI_string_ref.hh"
 
+#include "FN_multi_function_simd.hh"
+
 namespace blender::nodes {
 
 struct FloatMathOperationInfo {
@@ -462,4 +464,48 @@ inline bool try_dispatch_float_math_fl3_to_fl3(const NodeVectorMathOperation ope
   return false;
 }
 
+/**
+ * Binary operations of the math node which have a vectorized implementation, see
+ * #fn::CustomMF_SI_SI_SO_Simd. Minimum and maximum are not included, because the functions
+ * above use #std::min and #std::max, which order the arguments differently when one is NaN.
+ */
+inline std::optional<fn::SimdBinaryOperation> float_math_simd_binary_operation(const int operation)
+{
+  switch (operation) {
+    case NODE_MATH_ADD:
+      return fn::SimdBinaryOperation::Add;
+    case NODE_MATH_SUBTRACT:
+      return fn::SimdBinaryOperation::Subtract;
+    case NODE_MATH_MULTIPLY:
+      return fn::SimdBinaryOperation::Multiply;
+    case NODE_MATH_DIVIDE:
+      return fn::SimdBinaryOperation::SafeDivide;
+  }
+  return std::nullopt;
+}
+
+/**
+ * Same as #float_math_simd_binary_operation for the vector math node.
+ */
+inline std::optional<fn::SimdBinaryOperation> float3_math_simd_binary_operation(
+    const NodeVectorMathOperation operation)
+{
+  switch (operation) {
+    case NODE_VECTOR_MATH_ADD:
+      return fn::SimdBinaryOperation::Add;
+    case NODE_VECTOR_MATH_SUBTRACT:
+      return fn::SimdBinaryOperation::Subtract;
+    case NODE_VECTOR_MATH_MULTIPLY:
+      return fn::SimdBinaryOperation::Multiply;
+    case NODE_VECTOR_MATH_DIVIDE:
+      return fn::SimdBinaryOperation::SafeDivide;
+    case NODE_VECTOR_MATH_MINIMUM:
+      return fn::SimdBinaryOperation::Minimum;
+    case NODE_VECTOR_MATH_MAXIMUM:
+      return fn::SimdBinaryOperation::Maximum;
+    default:
+      return std::nullopt;
+  }
+}
+
 }  // namespace blender::nodes
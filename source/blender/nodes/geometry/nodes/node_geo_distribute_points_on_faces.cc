@@ -1,8 +1,9 @@
 /* SPDX-License-Identifier: GPL-2.0-or-later */
 
-#include "BLI_kdtree.h"
+#include "BLI_map.hh"
 #include "BLI_noise.hh"
 #include "BLI_rand.hh"
+#include "BLI_sort.hh"
 #include "BLI_task.hh"
 #include "BLI_timeit.hh"
 
@@ -146,20 +147,125 @@ static void sample_mesh_surface(const Mesh &mesh,
   }
 }
 
-BLI_NOINLINE static KDTree_3d *build_kdtree(Span<float3> positions)
+/**
+ * Points sorted into a uniform grid, so that all points within the cell size of a position are in
+ * the neighboring cells of the position. Within every cell, the points are sorted by index.
+ */
+struct PointGrid {
+  float cell_size;
+  Array<int> sorted_indices;
+  Map<int3, IndexRange> cells;
+
+  int3 cell_of(const float3 &position) const
+  {
+    /* Clamp to avoid overflow, points outside of the range are put into the border cells. */
+    const float limit = float(1 << 30);
+    const float3 cell = math::clamp(
+        math::floor(position / cell_size), float3(-limit), float3(limit));
+    return int3(cell);
+  }
+};
+
+BLI_NOINLINE static void build_point_grid(const Span<float3> positions,
+                                          const float cell_size,
+                                          PointGrid &r_grid)
 {
-  KDTree_3d *kdtree = BLI_kdtree_3d_new(positions.size());
+  r_grid.cell_size = cell_size;
+  Array<int3> point_cells(positions.size());
+  threading::parallel_for(positions.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      point_cells[i] = r_grid.cell_of(positions[i]);
+    }
+  });
 
-  int i_point = 0;
-  for (const float3 position : positions) {
-    BLI_kdtree_3d_insert(kdtree, i_point, position);
-    i_point++;
+  r_grid.sorted_indices.reinitialize(positions.size());
+  for (const int i : positions.index_range()) {
+    r_grid.sorted_indices[i] = i;
   }
+  parallel_sort(r_grid.sorted_indices.begin(),
+                r_grid.sorted_indices.end(),
+                [&](const int a, const int b) {
+                  const int3 &cell_a = point_cells[a];
+                  const int3 &cell_b = point_cells[b];
+                  if (cell_a != cell_b) {
+                    return std::tie(cell_a.x, cell_a.y, cell_a.z) <
+                           std::tie(cell_b.x, cell_b.y, cell_b.z);
+                  }
+                  return a < b;
+                });
+
+  int cell_start = 0;
+  for (const int i : r_grid.sorted_indices.index_range()) {
+    const int3 &cell = point_cells[r_grid.sorted_indices[i]];
+    const bool is_cell_end = i == r_grid.sorted_indices.size() - 1 ||
+                             point_cells[r_grid.sorted_indices[i + 1]] != cell;
+    if (is_cell_end) {
+      r_grid.cells.add_new(cell, IndexRange(cell_start, i + 1 - cell_start));
+      cell_start = i + 1;
+    }
+  }
+}
+
+enum class PointState : uint8_t {
+  Undecided,
+  Kept,
+  Eliminated,
+};
 
-  BLI_kdtree_3d_balance(kdtree);
-  return kdtree;
+/**
+ * A point is kept when no kept point with a lower index is closer than the minimum distance.
+ * Points whose lower neighbors are not decided yet have to wait for another round, unless one of
+ * the other neighbors is kept already.
+ */
+static PointState decide_point_state(const PointGrid &grid,
+                                     const Span<float3> positions,
+                                     const Span<PointState> states,
+                                     const float minimum_distance_sq,
+                                     const int point_index)
+{
+  const float3 position = positions[point_index];
+  const int3 cell = grid.cell_of(position);
+  bool has_undecided_neighbor = false;
+  for (int z = cell.z - 1; z <= cell.z + 1; z++) {
+    for (int y = cell.y - 1; y <= cell.y + 1; y++) {
+      for (int x = cell.x - 1; x <= cell.x + 1; x++) {
+        const IndexRange *cell_range = grid.cells.lookup_ptr(int3(x, y, z));
+        if (cell_range == nullptr) {
+          continue;
+        }
+        for (const int other_index : grid.sorted_indices.as_span().slice(*cell_range)) {
+          if (other_index >= point_index) {
+            break;
+          }
+          if (math::distance_squared(position, positions[other_index]) > minimum_distance_sq) {
+            continue;
+          }
+          switch (states[other_index]) {
+            case PointState::Kept:
+              return PointState::Eliminated;
+            case PointState::Undecided:
+              has_undecided_neighbor = true;
+              break;
+            case PointState::Eliminated:
+              break;
+          }
+        }
+      }
+    }
+  }
+  return has_undecided_neighbor ? PointState::Undecided : PointState::Kept;
 }
 
+/**
+ * Eliminate every point that is closer than the minimum distance to a remaining point with a lower
+ * index. All points whose lower neighbors are decided are decided in parallel, until all points
+ * are decided. The result is the same as when the points are processed one after another, so it
+ * doesn't depend on the number of threads.
+ *
+ * Long chains of close points with increasing indices only allow deciding a few points per round.
+ * Therefore the number of parallel rounds is limited, and the remaining points are decided one
+ * after another in the end.
+ */
 BLI_NOINLINE static void update_elimination_mask_for_close_points(
     Span<float3> positions, const float minimum_distance, MutableSpan<bool> elimination_mask)
 {
@@ -167,32 +273,54 @@ BLI_NOINLINE static void update_elimination_mask_for_close_points(
     return;
   }
 
-  KDTree_3d *kdtree = build_kdtree(positions);
-  BLI_SCOPED_DEFER([&]() { BLI_kdtree_3d_free(kdtree); });
+  /* Make the cells slightly larger, so that floating point precision issues can't move a point
+   * further than one cell away from its neighbors. */
+  PointGrid grid;
+  build_point_grid(positions, minimum_distance * 1.001f, grid);
+  const float minimum_distance_sq = minimum_distance * minimum_distance;
 
+  Array<PointState> states(positions.size(), PointState::Undecided);
+  Vector<int> undecided_points(positions.size());
   for (const int i : positions.index_range()) {
-    if (elimination_mask[i]) {
-      continue;
+    undecided_points[i] = i;
+  }
+
+  const int max_parallel_rounds = 8;
+  for (int round = 0; round < max_parallel_rounds && !undecided_points.is_empty(); round++) {
+    Array<PointState> new_states(undecided_points.size());
+    threading::parallel_for(undecided_points.index_range(), 1024, [&](const IndexRange range) {
+      for (const int i : range) {
+        new_states[i] = decide_point_state(
+            grid, positions, states, minimum_distance_sq, undecided_points[i]);
+      }
+    });
+
+    Vector<int> still_undecided_points;
+    for (const int i : undecided_points.index_range()) {
+      const int point_index = undecided_points[i];
+      states[point_index] = new_states[i];
+      if (new_states[i] == PointState::Undecided) {
+        still_undecided_points.append(point_index);
+      }
     }
+    undecided_points = std::move(still_undecided_points);
+  }
 
-    struct CallbackData {
-      int index;
-      MutableSpan<bool> elimination_mask;
-    } callback_data = {i, elimination_mask};
-
-    BLI_kdtree_3d_range_search_cb(
-        kdtree,
-        positions[i],
-        minimum_distance,
-        [](void *user_data, int index, const float *UNUSED(co), float UNUSED(dist_sq)) {
-          CallbackData &callback_data = *static_cast<CallbackData *>(user_data);
-          if (index != callback_data.index) {
-            callback_data.elimination_mask[index] = true;
-          }
-          return true;
-        },
-        &callback_data);
+  /* The undecided points are sorted, so all neighbors with lower indices are decided already when
+   * a point is processed. */
+  for (const int point_index : undecided_points) {
+    states[point_index] = decide_point_state(
+        grid, positions, states, minimum_distance_sq, point_index);
+    BLI_assert(states[point_index] != PointState::Undecided);
   }
+
+  threading::parallel_for(positions.index_range(), 4096, [&](const IndexRange range) {
+    for (const int i : range) {
+      if (states[i] == PointState::Eliminated) {
+        elimination_mask[i] = true;
+      }
+    }
+  });
 }
 
 BLI_NOINLINE static void update_elimination_mask_based_on_density_factors(
@@ -22,7 +22,8 @@ using fn::ValueOrFieldCPPType;
 
 ModifierLog::ModifierLog(GeoLogger &logger)
     : input_geometry_log_(std::move(logger.input_geometry_log_)),
-      output_geometry_log_(std::move(logger.output_geometry_log_))
+      output_geometry_log_(std::move(logger.output_geometry_log_)),
+      cache_stats_(logger.cache_stats_)
 {
   root_tree_logs_ = allocator_.construct<TreeLog>();
 
@@ -55,7 +56,16 @@ ModifierLog::ModifierLog(GeoLogger &logger)
     for (NodeWithExecutionTime &node_with_exec_time : local_logger.node_exec_times_) {
       NodeLog &node_log = this->lookup_or_add_node_log(log_by_tree_context,
                                                        node_with_exec_time.node);
-      node_log.exec_time_ = node_with_exec_time.exec_time;
+      node_log.exec_time_ += node_with_exec_time.exec_time;
+      node_log.invocations_++;
+      node_log.peak_geometry_size_ = std::max(node_log.peak_geometry_size_,
+                                              node_with_exec_time.output_geometry_size);
+    }
+
+    for (NodeWithCacheUsage &node_with_cache_usage : local_logger.node_cache_usages_) {
+      NodeLog &node_log = this->lookup_or_add_node_log(log_by_tree_context,
+                                                       node_with_cache_usage.node);
+      node_log.cache_usage_ = node_with_cache_usage.usage;
     }
 
     for (NodeWithDebugMessage &debug_message : local_logger.node_debug_messages_) {
@@ -63,6 +73,32 @@ ModifierLog::ModifierLog(GeoLogger &logger)
       node_log.debug_messages_.append(debug_message.message);
     }
   }
+
+  this->gather_node_statistics(*root_tree_logs_, "");
+  std::sort(node_statistics_.begin(),
+            node_statistics_.end(),
+            [](const GeometryNodeStatistics &a, const GeometryNodeStatistics &b) {
+              return strcmp(a.node_path, b.node_path) < 0;
+            });
+}
+
+void ModifierLog::gather_node_statistics(const TreeLog &tree_log, const std::string &path_prefix)
+{
+  for (auto item : tree_log.node_logs_.items()) {
+    const NodeLog &node_log = *item.value;
+    if (node_log.invocations_ == 0) {
+      continue;
+    }
+    GeometryNodeStatistics statistics = {nullptr};
+    statistics.node_path = allocator_.copy_string(path_prefix + item.key).c_str();
+    statistics.execution_time = node_log.exec_time_.count();
+    statistics.invocations = node_log.invocations_;
+    statistics.peak_geometry_size = node_log.peak_geometry_size_;
+    node_statistics_.append(statistics);
+  }
+  for (auto item : tree_log.child_logs_.items()) {
+    this->gather_node_statistics(*item.value, path_prefix + item.key + "/");
+  }
 }
 
 TreeLog &ModifierLog::lookup_or_add_tree_log(LogByTreeContext &log_by_tree_context,
@@ -123,6 +159,16 @@ const GeometryValueLog *ModifierLog::output_geometry_log() const
   return output_geometry_log_.get();
 }
 
+const NodeCacheStats &ModifierLog::cache_stats() const
+{
+  return cache_stats_;
+}
+
+Span<GeometryNodeStatistics> ModifierLog::node_statistics() const
+{
+  return node_statistics_;
+}
+
 const NodeLog *TreeLog::lookup_node_log(StringRef node_name) const
 {
   const destruct_ptr<NodeLog> *node_log = node_logs_.lookup_ptr_as(node_name);
@@ -481,9 +527,16 @@ void LocalGeoLogger::log_node_warning(DNode node, NodeWarningType type, std::str
   node_warnings_.append({node, {type, std::move(message)}});
 }
 
-void LocalGeoLogger::log_execution_time(DNode node, std::chrono::microseconds exec_time)
+void LocalGeoLogger::log_execution_time(DNode node,
+                                        std::chrono::microseconds exec_time,
+                                        const int64_t output_geometry_size)
+{
+  node_exec_times_.append({node, exec_time, output_geometry_size});
+}
+
+void LocalGeoLogger::log_cache_usage(DNode node, NodeCacheUsage usage)
 {
-  node_exec_times_.append({node, exec_time});
+  node_cache_usages_.append({node, usage});
 }
 
 void LocalGeoLogger::log_debug_message(DNode node, std::string message)
@@ -114,12 +114,12 @@ static const fn::MultiFunction *get_base_multi_function(bNode &node)
     return base_fn;
   }
 
-  try_dispatch_float_math_fl_fl_to_fl(mode,
-                                      [&](auto function, const FloatMathOperationInfo &info) {
-                                        static fn::CustomMF_SI_SI_SO<float, float, float> fn{
-                                            info.title_case_name.c_str(), function};
-                                        base_fn = &fn;
-                                      });
+  try_dispatch_float_math_fl_fl_to_fl(
+      mode, [&](auto function, const FloatMathOperationInfo &info) {
+        static fn::CustomMF_SI_SI_SO_Simd<float> fn{
+            info.title_case_name.c_str(), function, float_math_simd_binary_operation(mode)};
+        base_fn = &fn;
+      });
   if (base_fn != nullptr) {
     return base_fn;
   }
@@ -231,12 +231,13 @@ static const fn::MultiFunction *get_multi_function(bNode &node)
 
   const fn::MultiFunction *multi_fn = nullptr;
 
-  try_dispatch_float_math_fl3_fl3_to_fl3(operation,
-                                         [&](auto function, const FloatMathOperationInfo &info) {
-                                           static fn::CustomMF_SI_SI_SO<float3, float3, float3> fn{
-                                               info.title_case_name.c_str(), function};
-                                           multi_fn = &fn;
-                                         });
+  try_dispatch_float_math_fl3_fl3_to_fl3(
+      operation, [&](auto function, const FloatMathOperationInfo &info) {
+        static fn::CustomMF_SI_SI_SO_Simd<float3> fn{info.title_case_name.c_str(),
+                                                     function,
+                                                     float3_math_simd_binary_operation(operation)};
+        multi_fn = &fn;
+      });
   if (multi_fn != nullptr) {
     return multi_fn;
   }
@@ -399,6 +399,11 @@ static PyGetSetDef bpy_app_getsets[] = {
      bpy_app_debug_set,
      bpy_app_debug_doc,
      (void *)G_DEBUG_DEPSGRAPH_PRETTY},
+    {"debug_depsgraph_incremental",
+     bpy_app_debug_get,
+     bpy_app_debug_set,
+     bpy_app_debug_doc,
+     (void *)G_DEBUG_DEPSGRAPH_INCREMENTAL},
     {"debug_simdata",
      bpy_app_debug_get,
      bpy_app_debug_set,
@@ -1820,6 +1820,9 @@ static bool wm_file_write(bContext *C,
   /* XXX(ton): temp solution to solve bug, real fix coming. */
   bmain->recovered = 0;
 
+  /* Unlike auto-save, this doesn't use #BLO_write_file_background_begin: callers (including
+   * scripts and quitting after saving) rely on the file being on disk once this returns, and
+   * the post-save steps below (history, thumbnail, `save_post` handlers) need it as well. */
   if (BLO_write_file(bmain,
                      filepath,
                      fileflags,
@@ -1918,10 +1921,29 @@ static void wm_autosave_location(char *filepath)
   BLI_join_dirfile(filepath, FILE_MAX, BKE_tempdir_base(), path);
 }
 
+/**
+ * Auto-save without undo-data is written to disk in the background, so that saving large files
+ * doesn't block the user interface.
+ */
+static BlendFileWriteTask *wm_autosave_write_task = NULL;
+
+void wm_autosave_write_finish(void)
+{
+  if (wm_autosave_write_task == NULL) {
+    return;
+  }
+  /* Error reporting into console. */
+  BLO_write_file_background_end(wm_autosave_write_task, G_MAIN, NULL);
+  wm_autosave_write_task = NULL;
+}
+
 static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
 {
   char filepath[FILE_MAX];
 
+  /* Writing the previous auto-save to the same file might still be in progress. */
+  wm_autosave_write_finish();
+
   wm_autosave_location(filepath);
 
   /* Fast save of last undo-buffer, now with UI. */
@@ -1942,7 +1964,8 @@ static void wm_autosave_write(Main *bmain, wmWindowManager *wm)
     ED_editors_flush_edits(bmain);
 
     /* Error reporting into console. */
-    BLO_write_file(bmain, filepath, fileflags, &(const struct BlendFileWriteParams){0}, NULL);
+    wm_autosave_write_task = BLO_write_file_background_begin(
+        bmain, filepath, fileflags, &(const struct BlendFileWriteParams){0}, NULL);
   }
 }
 
@@ -2001,6 +2024,8 @@ void wm_autosave_delete(void)
 {
   char filepath[FILE_MAX];
 
+  wm_autosave_write_finish();
+
   wm_autosave_location(filepath);
 
   if (BLI_exists(filepath)) {
@@ -2935,6 +2960,9 @@ static int wm_recover_auto_save_exec(bContext *C, wmOperator *op)
 
   RNA_string_get(op->ptr, "filepath", filepath);
 
+  /* Don't read the auto-save file while it is written. */
+  wm_autosave_write_finish();
+
   wm_open_init_use_scripts(op, true);
   SET_FLAG_FROM_TEST(G.f, RNA_boolean_get(op->ptr, "use_scripts"), G_FLAG_SCRIPT_AUTOEXEC);
 
@@ -429,6 +429,9 @@ void WM_exit_ex(bContext *C, const bool do_python)
 {
   wmWindowManager *wm = C ? CTX_wm_manager(C) : NULL;
 
+  /* The auto-save is written by a task, finish it before the task scheduler exits. */
+  wm_autosave_write_finish();
+
   /* first wrap up running stuff, we assume only the active WM is running */
   /* modal handlers are on window level freed, others too? */
   /* NOTE: same code copied in `wm_files.c`. */
@@ -97,6 +97,10 @@ void wm_autosave_timer(struct Main *bmain, wmWindowManager *wm, wmTimer *wt);
 void wm_autosave_timer_begin(struct wmWindowManager *wm);
 void wm_autosave_timer_end(wmWindowManager *wm);
 void wm_autosave_delete(void);
+/**
+ * Wait until the auto-save file that is written in the background is on disk.
+ */
+void wm_autosave_write_finish(void);
 
 /* wm_splash_screen.c */
 
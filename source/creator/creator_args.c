@@ -26,6 +26,7 @@
 #  include "BLI_string.h"
 #  include "BLI_string_utf8.h"
 #  include "BLI_system.h"
+#  include "BLI_task.h"
 #  include "BLI_threads.h"
 #  include "BLI_utildefines.h"
 
@@ -575,6 +576,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-time");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-pretty");
   BLI_args_print_arg_doc(ba, "--debug-depsgraph-uuid");
+  BLI_args_print_arg_doc(ba, "--debug-depsgraph-incremental");
   BLI_args_print_arg_doc(ba, "--debug-ghost");
   BLI_args_print_arg_doc(ba, "--debug-gpu");
   BLI_args_print_arg_doc(ba, "--debug-gpu-force-workarounds");
@@ -588,6 +590,7 @@ static int arg_handle_print_help(int UNUSED(argc), const char **UNUSED(argv), vo
 
   printf("\n");
   BLI_args_print_arg_doc(ba, "--debug-fpe");
+  BLI_args_print_arg_doc(ba, "--debug-task-trace");
   BLI_args_print_arg_doc(ba, "--debug-exit-on-error");
   BLI_args_print_arg_doc(ba, "--disable-crash-handler");
   BLI_args_print_arg_doc(ba, "--disable-abort-handler");
@@ -980,6 +983,9 @@ static const char arg_handle_debug_mode_generic_set_doc_depsgraph_pretty[] =
 static const char arg_handle_debug_mode_generic_set_doc_depsgraph_uuid[] =
     "\n\t"
     "Verify validness of session-wide identifiers assigned to ID datablocks.";
+static const char arg_handle_debug_mode_generic_set_doc_depsgraph_incremental[] =
+    "\n\t"
+    "Validate incremental updates of dependency graph relations against a full build.";
 static const char arg_handle_debug_mode_generic_set_doc_gpu_force_workarounds[] =
     "\n\t"
     "Enable workarounds for typical GPU issues and disable all GPU extensions.";
@@ -1105,6 +1111,22 @@ static int arg_handle_debug_fpe_set(int UNUSED(argc),
   return 0;
 }
 
+static const char arg_handle_debug_task_trace_set_doc[] =
+    "<filepath>\n"
+    "\tRecord when and on which thread tasks run,\n"
+    "\tthe Chrome trace JSON file is written on exit.";
+static int arg_handle_debug_task_trace_set(int argc, const char **argv, void *UNUSED(data))
+{
+  const char *arg_id = "--debug-task-trace";
+  if (argc > 1) {
+    BLI_task_trace_write_json_on_exit(argv[1]);
+    BLI_task_trace_begin();
+    return 1;
+  }
+  printf("\nError: you must specify a filepath after '%s'.\n", arg_id);
+  return 0;
+}
+
 static const char arg_handle_app_template_doc[] =
     "<template>\n"
     "\tSet the application template (matching the directory name), use 'default' for none.";
@@ -2195,12 +2217,18 @@ void main_args_setup(bContext *C, bArgs *ba)
                "--debug-depsgraph-uuid",
                CB_EX(arg_handle_debug_mode_generic_set, depsgraph_uuid),
                (void *)G_DEBUG_DEPSGRAPH_UUID);
+  BLI_args_add(ba,
+               NULL,
+               "--debug-depsgraph-incremental",
+               CB_EX(arg_handle_debug_mode_generic_set, depsgraph_incremental),
+               (void *)G_DEBUG_DEPSGRAPH_INCREMENTAL);
   BLI_args_add(ba,
                NULL,
                "--debug-gpu-force-workarounds",
                CB_EX(arg_handle_debug_mode_generic_set, gpu_force_workarounds),
                (void *)G_DEBUG_GPU_FORCE_WORKAROUNDS);
   BLI_args_add(ba, NULL, "--debug-exit-on-error", CB(arg_handle_debug_exit_on_error), NULL);
+  BLI_args_add(ba, NULL, "--debug-task-trace", CB(arg_handle_debug_task_trace_set), NULL);
 
   BLI_args_add(ba, NULL, "--verbose", CB(arg_handle_verbosity_set), NULL);
 
@@ -0,0 +1,88 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import time
+
+    num_objects = args['num_objects']
+
+    # Generate the scene: objects sharing a mesh, in a few collections,
+    # with parenting and constraints so relations are built between objects.
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    scene = bpy.context.scene
+    view_layer = bpy.context.view_layer
+    mesh = bpy.data.meshes.new("Mesh")
+
+    collections = []
+    for i in range(16):
+        collection = bpy.data.collections.new(f"Collection{i}")
+        scene.collection.children.link(collection)
+        collections.append(collection)
+
+    objects = []
+    for i in range(num_objects):
+        ob = bpy.data.objects.new(f"Object{i}", mesh)
+        collections[i % len(collections)].objects.link(ob)
+        if i >= 10:
+            if i % 3 == 0:
+                ob.parent = objects[i // 10]
+            elif i % 3 == 1:
+                constraint = ob.constraints.new('COPY_LOCATION')
+                constraint.target = objects[i // 10]
+        objects.append(ob)
+
+    view_layer.update()
+
+    elapsed_times = []
+    if args['change'] == 'collection':
+        # Measure relations rebuild after a collection change, which tags relations for update.
+        for _ in range(5):
+            collection = bpy.data.collections.new("Extra")
+            scene.collection.children.link(collection)
+
+            start_time = time.time()
+            view_layer.update()
+            elapsed_times.append(time.time() - start_time)
+
+            bpy.data.collections.remove(collection)
+            view_layer.update()
+    else:
+        # Measure relations update after changing a constraint target, which only tags relations
+        # of the constrained object for update.
+        constraint = objects[-1].constraints.new('COPY_ROTATION')
+        view_layer.update()
+        for i in range(5):
+            constraint.target = objects[i]
+
+            start_time = time.time()
+            view_layer.update()
+            elapsed_times.append(time.time() - start_time)
+
+    result = {'time': min(elapsed_times)}
+    return result
+
+
+class DepsgraphRebuildTest(api.Test):
+    def __init__(self, num_objects, change):
+        self.num_objects = num_objects
+        self.change = change
+
+    def name(self):
+        return f"depsgraph_rebuild_{self.change}_{self.num_objects}"
+
+    def category(self):
+        return "depsgraph"
+
+    def run(self, env, device_id):
+        args = {'num_objects': self.num_objects, 'change': self.change}
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    return [DepsgraphRebuildTest(num_objects, change)
+            for change in ('collection', 'constraint')
+            for num_objects in (1000, 10000, 50000)]
@@ -0,0 +1,140 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import time
+
+    width = args['width']
+
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    scene = bpy.context.scene
+    view_layer = bpy.context.view_layer
+
+    group = bpy.data.node_groups.new("Benchmark", 'GeometryNodeTree')
+    group.inputs.new('NodeSocketGeometry', "Geometry")
+    group.inputs.new('NodeSocketFloat', "Value")
+    group.outputs.new('NodeSocketGeometry', "Geometry")
+    nodes = group.nodes
+    links = group.links
+    group_input = nodes.new('NodeGroupInput')
+    group_output = nodes.new('NodeGroupOutput')
+    join = nodes.new('GeometryNodeJoinGeometry')
+    links.new(join.outputs[0], group_output.inputs[0])
+
+    if args['tree'] == 'realize':
+        # Realize many instances of a small mesh, the width is the number of instances.
+        resolution = int(width ** 0.5)
+        grid = nodes.new('GeometryNodeMeshGrid')
+        grid.inputs['Vertices X'].default_value = resolution
+        grid.inputs['Vertices Y'].default_value = resolution
+        cube = nodes.new('GeometryNodeMeshCube')
+        links.new(group_input.outputs[1], cube.inputs['Size'])
+        instance = nodes.new('GeometryNodeInstanceOnPoints')
+        links.new(grid.outputs[0], instance.inputs['Points'])
+        links.new(cube.outputs[0], instance.inputs['Instance'])
+        realize = nodes.new('GeometryNodeRealizeInstances')
+        links.new(instance.outputs[0], realize.inputs[0])
+        links.new(realize.outputs[0], join.inputs[0])
+    elif args['tree'] == 'distribute':
+        # Poisson disk distribution, the width is the maximum density of the points.
+        grid = nodes.new('GeometryNodeMeshGrid')
+        grid.inputs['Size X'].default_value = 10.0
+        grid.inputs['Size Y'].default_value = 10.0
+        distribute = nodes.new('GeometryNodeDistributePointsOnFaces')
+        distribute.distribute_method = 'POISSON'
+        distribute.inputs['Density Max'].default_value = width
+        distance = nodes.new('ShaderNodeMath')
+        distance.operation = 'MULTIPLY'
+        distance.inputs[1].default_value = 0.2 / (width ** 0.5)
+        links.new(group_input.outputs[1], distance.inputs[0])
+        links.new(distance.outputs[0], distribute.inputs['Distance Min'])
+        links.new(grid.outputs[0], distribute.inputs['Mesh'])
+        links.new(distribute.outputs['Points'], join.inputs[0])
+    branches_num = width if args['tree'] in {'values', 'geometry', 'subdivide'} else 0
+
+    # Every branch depends on the modifier input value, so that no node output can be reused
+    # between the measured evaluations.
+    for i in range(branches_num):
+        if args['tree'] == 'values':
+            # Many cheap single value nodes that only control a small geometry.
+            value = group_input.outputs[1]
+            for j in range(10):
+                math = nodes.new('ShaderNodeMath')
+                math.operation = 'MULTIPLY_ADD'
+                math.inputs[1].default_value = 1.0001
+                math.inputs[2].default_value = j
+                links.new(value, math.inputs[0])
+                value = math.outputs[0]
+            cube = nodes.new('GeometryNodeMeshCube')
+            links.new(value, cube.inputs['Size'])
+            links.new(cube.outputs[0], join.inputs[0])
+        elif args['tree'] == 'geometry':
+            # Many cheap geometry nodes on small geometries.
+            geometry = None
+            for j in range(5):
+                cube = nodes.new('GeometryNodeMeshCube')
+                links.new(group_input.outputs[1], cube.inputs['Size'])
+                transform = nodes.new('GeometryNodeTransform')
+                transform.inputs['Translation'].default_value = (i, j, 0.0)
+                links.new(cube.outputs[0], transform.inputs[0])
+                geometry = transform.outputs[0]
+            links.new(geometry, join.inputs[0])
+        else:
+            # Few expensive nodes that should run in parallel.
+            sphere = nodes.new('GeometryNodeMeshIcoSphere')
+            sphere.inputs['Subdivisions'].default_value = 3
+            links.new(group_input.outputs[1], sphere.inputs['Radius'])
+            subdivide = nodes.new('GeometryNodeSubdivideMesh')
+            subdivide.inputs['Level'].default_value = 4
+            links.new(sphere.outputs[0], subdivide.inputs[0])
+            links.new(subdivide.outputs[0], join.inputs[0])
+
+    mesh = bpy.data.meshes.new("Mesh")
+    ob = bpy.data.objects.new("Object", mesh)
+    scene.collection.objects.link(ob)
+    modifier = ob.modifiers.new("Nodes", 'NODES')
+    modifier.node_group = group
+    value_identifier = group.inputs[1].identifier
+
+    elapsed_times = []
+    for i in range(10):
+        modifier[value_identifier] = 1.0 + i * 0.01
+        ob.update_tag()
+
+        start_time = time.time()
+        view_layer.update()
+        elapsed_times.append(time.time() - start_time)
+
+    result = {'time': min(elapsed_times)}
+    return result
+
+
+class GeometryNodesEvaluateTest(api.Test):
+    def __init__(self, tree, width):
+        self.tree = tree
+        self.width = width
+
+    def name(self):
+        return f"geometry_nodes_{self.tree}_{self.width}"
+
+    def category(self):
+        return "geometry_nodes"
+
+    def run(self, env, device_id):
+        args = {'tree': self.tree, 'width': self.width}
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    return [GeometryNodesEvaluateTest('values', 200),
+            GeometryNodesEvaluateTest('values', 1000),
+            GeometryNodesEvaluateTest('geometry', 200),
+            GeometryNodesEvaluateTest('geometry', 1000),
+            GeometryNodesEvaluateTest('subdivide', 8),
+            GeometryNodesEvaluateTest('realize', 10000),
+            GeometryNodesEvaluateTest('realize', 1000000),
+            GeometryNodesEvaluateTest('distribute', 10000)]
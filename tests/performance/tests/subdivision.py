@@ -0,0 +1,62 @@
+# SPDX-License-Identifier: Apache-2.0
+
+import api
+
+
+def _run(args):
+    import bpy
+    import bmesh
+    import time
+
+    bpy.ops.wm.read_factory_settings(use_empty=True)
+    scene = bpy.context.scene
+    view_layer = bpy.context.view_layer
+
+    # A sphere with quads and triangle fans at the poles, so that both regular and irregular
+    # patches are evaluated.
+    mesh = bpy.data.meshes.new("Mesh")
+    bm = bmesh.new()
+    bmesh.ops.create_uvsphere(bm, u_segments=128, v_segments=64, radius=1.0)
+    bm.to_mesh(mesh)
+    bm.free()
+
+    ob = bpy.data.objects.new("Object", mesh)
+    scene.collection.objects.link(ob)
+
+    # Deform the mesh before subdividing it, like an armature does for a character, so that the
+    # topology stays the same and only the positions of the coarse mesh change.
+    displace = ob.modifiers.new("Displace", 'DISPLACE')
+    subsurf = ob.modifiers.new("Subdivision", 'SUBSURF')
+    subsurf.levels = args['levels']
+    subsurf.render_levels = args['levels']
+
+    elapsed_times = []
+    for i in range(10):
+        displace.strength = 0.1 + i * 0.01
+
+        start_time = time.time()
+        view_layer.update()
+        elapsed_times.append(time.time() - start_time)
+
+    result = {'time': min(elapsed_times)}
+    return result
+
+
+class SubdivisionSurfaceTest(api.Test):
+    def __init__(self, levels):
+        self.levels = levels
+
+    def name(self):
+        return f"subdivision_surface_level_{self.levels}"
+
+    def category(self):
+        return "modifiers"
+
+    def run(self, env, device_id):
+        args = {'levels': self.levels}
+        result, _ = env.run_in_blender(_run, args)
+        return result
+
+
+def generate(env):
+    return [SubdivisionSurfaceTest(levels) for levels in range(1, 5)]